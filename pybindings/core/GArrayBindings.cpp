@@ -36,25 +36,46 @@ namespace frommle{
     namespace core{
 
         ///@biref converts a Guided array to an xarray DataArray
+        ///@brief structured coordinates (e.g. n,m,t or lon,lat columns) are turned into a pandas MultiIndex built from the columns
+        inline p::object coordMultiIndex(const np::ndarray & crd){
+            p::object fields=crd.get_dtype().attr("names");
+            p::list columns;
+            for(int i=0;i<p::len(fields);++i){
+                columns.append(crd[fields[i]]);
+            }
+            auto pandas=p::import("pandas");
+            return pandas.attr("MultiIndex").attr("from_arrays")(columns,p::object(),fields);
+        }
+
         template<class T, int n>
         struct garr_to_xarDataArray{
             static PyObject *convert(GArrayDense<T,n> const  & garin) {
                 //create a list of dimension names
+                auto xar=p::import("xarray");
                 p::list dims;
                 p::dict coords;
+                p::list multicoords;
                 for(int i=0;i<n;++i){
                     std::string name=garin.gp()[i]->name();
                     dims.append(name);
-                    coords[name]=guides::getcoords<n>(garin.gp(),i);
+                    np::ndarray crd=guides::getcoords<n>(garin.gp(),i);
+                    if (p::object(crd.get_dtype().attr("names")).is_none()){
+                        coords[name]=crd;
+                    }else{
+                        //note: xarray expects multi-indexes to be wrapped as coordinates explicitly
+                        multicoords.append(xar.attr("Coordinates").attr("from_pandas_multiindex")(coordMultiIndex(crd),name));
+                    }
                 }
                 //also pack the entire C++guidepack as an attribute
                 p::dict attrs;
                 attrs["GuidePack"]=garin.gp();
 
                 //construct an xarray-> DataArray
-                auto xar=p::import("xarray");
-                auto DataArray=xar.attr("DataArray")(garin.mat(),coords,dims,garin.name(),attrs);
-                return p::incref(p::object(DataArray).ptr());
+                p::object DataArray=xar.attr("DataArray")(garin.mat(),coords,dims,garin.name(),attrs);
+                for(int i=0;i<p::len(multicoords);++i){
+                    DataArray=DataArray.attr("assign_coords")(multicoords[i]);
+                }
+                return p::incref(DataArray.ptr());
 
             }
         };
@@ -84,6 +105,7 @@ namespace frommle{
                 p::register_ptr_to_python< std::shared_ptr<GArrayDense<T,n>>>();
 
                 p::def(std::string("makeGArray_").append(tname).c_str(),&register_dyngar<T,n>::makedense);
+                p::def(std::string("makeGArray_").append(tname).c_str(),&register_dyngar<T,n>::makedensefrom);
                 
                 //call this function for the variant with 1 dimension less
                 register_dyngar<T,n-1>::reg(tname);
@@ -93,6 +115,26 @@ namespace frommle{
             return std::make_shared<GArrayDense<T,n>>(gpin,name);
         }
 
+        ///@brief use a numpy array as storage of a dense array (the buffer is shared when possible and copied otherwise)
+        static  std::shared_ptr<GArrayDense<T,n>> makedensefrom(const guides::GuidePackDyn<n> & gpin,const np::ndarray & ndar,const std::string name){
+            if (ndar.get_nd() != n){
+                THROWINPUTEXCEPTION("input ndarray has non-matching dimension");
+            }
+            auto ext=gpin.extent();
+            for(int i=0;i<n;++i){
+                if (static_cast<size_t>(ndar.shape(i)) != ext[i]){
+                    THROWINPUTEXCEPTION("input ndarray has non-matching shape");
+                }
+            }
+            if (py::ndarray_zerocopy<T>(ndar,true)){
+                return std::make_shared<GArrayDense<T,n>>(gpin,name,py::ndarray_shared<T>(ndar));
+            }
+            //note: a numpy copy is not necessarily aligned for Eigen, so the values are copied into memory from the dense allocator
+            auto garr=std::make_shared<GArrayDense<T,n>>(gpin,name);
+            p::import("numpy").attr("copyto")(getndarray(*garr),ndar,"unsafe");
+            return garr;
+        }
+
 
         static np::ndarray getndarray(const gdense & garr){
                 return py::marrayref_to_ndarray<T,n>::get(garr.mat());
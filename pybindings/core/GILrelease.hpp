@@ -0,0 +1,55 @@
+/*! \file
+ \brief Scoped helpers to release and (re)acquire the python global interpreter lock
+ \copyright Roelof Rietbroek 2020
+ \license
+ This file is part of Frommle.
+ frommle is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3 of the License, or (at your option) any later version.
+
+ Frommle is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with Frommle; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <boost/python.hpp>
+
+#ifndef FROMMLE_GILRELEASE_HPP
+#define FROMMLE_GILRELEASE_HPP
+
+namespace frommle{
+    namespace py{
+
+        ///@brief releases the GIL for the lifetime of the object
+        /// Only use this around pure C++ work: no python objects may be touched while the GIL is released
+        class ScopedGILRelease{
+        public:
+            ScopedGILRelease():state_(PyEval_SaveThread()){}
+            ~ScopedGILRelease(){PyEval_RestoreThread(state_);}
+            ScopedGILRelease(const ScopedGILRelease &)=delete;
+            ScopedGILRelease & operator=(const ScopedGILRelease &)=delete;
+        private:
+            PyThreadState * state_=nullptr;
+        };
+
+        ///@brief (re)acquires the GIL for the lifetime of the object (for C++ code which calls back into python)
+        class ScopedGILAcquire{
+        public:
+            ScopedGILAcquire():state_(PyGILState_Ensure()){}
+            ~ScopedGILAcquire(){PyGILState_Release(state_);}
+            ScopedGILAcquire(const ScopedGILAcquire &)=delete;
+            ScopedGILAcquire & operator=(const ScopedGILAcquire &)=delete;
+        private:
+            PyGILState_STATE state_;
+        };
+
+    }
+}
+
+#endif
@@ -28,6 +28,9 @@
 #include <boost/python/return_internal_reference.hpp>
 #include "core/GOperatorBase.hpp"
 #include "core/GOperatorDiag.hpp"
+#include "core/GOperatorBlockDiag.hpp"
+#include "core/GOperatorChain.hpp"
+#include "GILrelease.hpp"
 
 namespace p = boost::python;
 
@@ -40,6 +43,8 @@ namespace frommle{
         public:
         
         void fwdOp(const GArrayBase<T,ndim_i+1> & gin, GArrayBase<T,ndim_o+1> & gout)  override  {
+        //may be called from a chain which has released the GIL
+        py::ScopedGILAcquire gil;
         if( auto fwdop=this->get_override("__call__")) {
             //call the python __call__ method of this class
             auto gtmp=fwdop(gin);
@@ -87,6 +92,42 @@ struct register_GoperatorDiag{
     }
 };
 
+    template<class T>
+struct register_GoperatorBlockDiag{
+    static void reg(const std::string & basename){
+        p::class_<GOperatorBlockDiag<T>,p::bases<GOperatorDyn<T,1,1>>>(basename.c_str())
+            .def("__call__",&register_GoperatorBlockDiag::call)
+            .add_property("nblocks",&GOperatorBlockDiag<T>::nblocks)
+            .add_property("nthreads",&GOperatorBlockDiag<T>::nThreads,&GOperatorBlockDiag<T>::setNThreads);
+    }
+
+    static std::shared_ptr<GArrayDense<T,2>> call(GOperatorBlockDiag<T> & op, const GArrayDense<T,2> & gin){
+        py::ScopedGILRelease nogil;
+        return std::make_shared<GArrayDense<T,2>>(op.apply(gin));
+    }
+};
+
+    template<class T>
+struct register_GoperatorChain{
+    using chain_t=GOperatorChain<T>;
+    static void reg(const std::string & basename){
+        p::class_<chain_t,p::bases<GOperatorDyn<T,1,1>>,boost::noncopyable>(basename.c_str())
+            .def("append",&register_GoperatorChain::append)
+            .def("__call__",&register_GoperatorChain::call)
+            .def("clearScratch",&chain_t::clearScratch)
+            .add_property("nstages",&chain_t::nstages);
+    }
+
+    static void append(chain_t & chain, std::shared_ptr<GOperatorDyn<T,1,1>> op){
+        chain.append(op);
+    }
+
+    static std::shared_ptr<GArrayDense<T,2>> call(chain_t & chain, const GArrayDense<T,2> & gin){
+        py::ScopedGILRelease nogil;
+        return std::dynamic_pointer_cast<GArrayDense<T,2>>(chain(gin));
+    }
+};
+
     void registerGOperators(){
     ///Register the operator base class 
         //p::class_<GOperatorBase,p::bases<Frommle>>("GOperatorBase").def(p::init<p::optional<std::string>>());
@@ -96,6 +137,10 @@ struct register_GoperatorDiag{
         register_Goperator<double,2,2>::reg("GOperator_float64");
 
         register_GoperatorDiag<double>::reg("GOperatorDiag_float64");
+
+        register_GoperatorBlockDiag<double>::reg("GOperatorBlockDiag_float64");
+
+        register_GoperatorChain<double>::reg("GOperatorChain_float64");
     }
 
 
@@ -42,22 +42,7 @@ namespace frommle{
         public:
             template<class T>
             np::ndarray operator()(const T & gvar)const{
-                using Element=typename T::element_type::Element;
-                np::dtype dtype = py::np_dtype<Element>::get();
-                //create an numpy array
-                p::tuple shape=p::make_tuple(gvar->size()); 
-                np::ndarray py_array = np::empty(shape, dtype);
-                if (py::np_dtype<Element>::isobject()) {
-                    std::transform(gvar->begin(), gvar->end(), reinterpret_cast<p::object *>(py_array.get_data()),
-                                   [](const Element &el) {
-                                       return p::object(el);
-                                   });
-                }else{
-                    //copy values not object (pointers)
-                    std::copy(gvar->begin(),gvar->end(),reinterpret_cast<Element*>(py_array.get_data()));
-
-                }
-                return py_array;
+                return py::guide_to_ndarray(*gvar);
             }
 
 
@@ -26,7 +26,11 @@
 #include "core/Hyperslab.hpp"
 #include "tupleconversion.hpp"
 #include "core/GuideRegistry.hpp"
+#include "GILrelease.hpp"
 #include <eigen3/Eigen/Core>
+#include <memory>
+#include <limits>
+#include <cstdint>
 
 namespace p = boost::python;
 namespace np = boost::python::numpy;
@@ -98,6 +102,56 @@ namespace frommle{
         };
 
 
+        ///@brief shared_ptr deleter which keeps a python object alive for as long as C++ uses its buffer
+        /// The GIL is acquired on release so the last owner may be destroyed from any thread
+        struct pyobject_deleter{
+            explicit pyobject_deleter(PyObject * obj):obj_(p::incref(obj)){}
+            template<class T>
+            void operator()(T *)const{
+                ScopedGILAcquire gil;
+                Py_XDECREF(obj_);
+            }
+            PyObject * obj_=nullptr;
+        };
+
+        /*!@brief check whether the buffer of a ndarray can be used directly as storage for elements of type T
+         * numpy's ALIGNED flag only guarantees element alignment, while dense garrays are mapped as aligned Eigen matrices,
+         * so eigenaligned additionally requires the buffer to be aligned to EIGEN_MAX_ALIGN_BYTES
+         */
+        template<class T>
+        bool ndarray_zerocopy(const np::ndarray & ndar, const bool eigenaligned=false){
+            if (np_dtype<T>::isobject()){
+                return false;
+            }
+            const int flags=ndar.get_flags();
+            const int required=np::ndarray::C_CONTIGUOUS | np::ndarray::ALIGNED | np::ndarray::WRITEABLE;
+            if ((flags & required) != required or !np::equivalent(ndar.get_dtype(),np_dtype<T>::get())){
+                return false;
+            }
+#if EIGEN_MAX_ALIGN_BYTES > 0
+            return !eigenaligned or reinterpret_cast<uintptr_t>(ndar.get_data()) % EIGEN_MAX_ALIGN_BYTES == 0;
+#else
+            return true;
+#endif
+        }
+
+        ///@brief return the input when its buffer can be shared, otherwise a C-contiguous copy converted to T
+        template<class T>
+        np::ndarray ndarray_compatible(const np::ndarray & ndar){
+            if (ndarray_zerocopy<T>(ndar)){
+                return ndar;
+            }
+            np::ndarray ndcopy=np::empty(ndar.get_nd(),ndar.get_shape(),np_dtype<T>::get());
+            p::import("numpy").attr("copyto")(ndcopy,ndar,"unsafe");
+            return ndcopy;
+        }
+
+        ///@brief shared pointer to the buffer of a (compatible) ndarray, which co-owns the python object
+        template<class T>
+        std::shared_ptr<T[]> ndarray_shared(const np::ndarray & ndar){
+            return std::shared_ptr<T[]>(reinterpret_cast<T*>(ndar.get_data()),pyobject_deleter(ndar.ptr()));
+        }
+
 //        template<class T>
 //        struct vec_to_ndarray{
 //            static PyObject* convert(const std::vector<T> & invec){
@@ -199,23 +253,116 @@ namespace frommle{
         //};
 
 
+        ///@brief create a numpy dtype from a python description (e.g. a string or a list of (name,type) fields)
+        inline np::dtype np_dtype_from(const p::object & descr){
+            return p::extract<np::dtype>(p::import("numpy").attr("dtype")(descr));
+        }
+
+        ///@brief fills a numpy array from a range of guide elements (default: primitive copies or one python object per element)
+        template<class Element>
+        struct np_fill{
+            static np::dtype dtype(){return np_dtype<Element>::get();}
+            template<class It>
+            static void fill(It begin, It end, char * out){
+                if (np_dtype<Element>::isobject()) {
+                    std::transform(begin, end, reinterpret_cast<p::object *>(out),
+                                   [](const Element &el) {
+                                       return p::object(el);
+                                   });
+                }else{
+                    //copy values not object (pointers)
+                    std::copy(begin,end,reinterpret_cast<Element*>(out));
+                }
+            }
+        };
+
+        ///@brief spherical harmonic degree and order as a structured array with integer columns n, m
+        template<>
+        struct np_fill<guides::nmEl>{
+            struct rec{int32_t n; int32_t m;};
+            static np::dtype dtype(){
+                return np_dtype_from(p::list(p::make_tuple(p::make_tuple("n","i4"),p::make_tuple("m","i4"))));
+            }
+            template<class It>
+            static void fill(It begin, It end, char * out){
+                std::transform(begin,end,reinterpret_cast<rec*>(out),[](const guides::nmEl & el){
+                    return rec{std::get<0>(el),std::get<1>(el)};
+                });
+            }
+        };
+
+        ///@brief spherical harmonic degree, order and trigonometric type as a structured array with integer columns n, m, t
+        template<>
+        struct np_fill<guides::nmtEl>{
+            struct rec{int32_t n; int32_t m; int32_t t;};
+            static np::dtype dtype(){
+                return np_dtype_from(p::list(p::make_tuple(p::make_tuple("n","i4"),p::make_tuple("m","i4"),p::make_tuple("t","i4"))));
+            }
+            template<class It>
+            static void fill(It begin, It end, char * out){
+                std::transform(begin,end,reinterpret_cast<rec*>(out),[](const guides::nmtEl & el){
+                    return rec{std::get<0>(el),std::get<1>(el),static_cast<int32_t>(std::get<2>(el))};
+                });
+            }
+        };
+
+        ///@brief dates as datetime64[D] (days since the unix epoch)
+        template<>
+        struct np_fill<guides::gregdate>{
+            static np::dtype dtype(){return np_dtype_from(p::str("datetime64[D]"));}
+            template<class It>
+            static void fill(It begin, It end, char * out){
+                const guides::gregdate epoch(1970,1,1);
+                std::transform(begin,end,reinterpret_cast<int64_t*>(out),[&epoch](const guides::gregdate & el)->int64_t{
+                    //numpy uses the minimum integer as not a time
+                    return el.is_special()?std::numeric_limits<int64_t>::min():(el-epoch).days();
+                });
+            }
+        };
+
+        ///@brief time stamps as datetime64[us] (microseconds since the unix epoch)
+        template<>
+        struct np_fill<guides::ptime>{
+            static np::dtype dtype(){return np_dtype_from(p::str("datetime64[us]"));}
+            template<class It>
+            static void fill(It begin, It end, char * out){
+                const guides::ptime epoch(guides::gregdate(1970,1,1));
+                std::transform(begin,end,reinterpret_cast<int64_t*>(out),[&epoch](const guides::ptime & el)->int64_t{
+                    return el.is_special()?std::numeric_limits<int64_t>::min():(el-epoch).total_microseconds();
+                });
+            }
+        };
+
+        ///@brief points as a structured array with float columns lon, lat
+        struct np_fill_lonlat{
+            struct rec{double lon; double lat;};
+            static np::dtype dtype(){
+                return np_dtype_from(p::list(p::make_tuple(p::make_tuple("lon","f8"),p::make_tuple("lat","f8"))));
+            }
+            static rec get(const OGRPoint & pnt){return rec{pnt.getX(),pnt.getY()};}
+            static rec get(const std::shared_ptr<OGRPoint> & pnt){return get(*pnt);}
+            template<class It>
+            static void fill(It begin, It end, char * out){
+                std::transform(begin,end,reinterpret_cast<rec*>(out),[](const typename std::iterator_traits<It>::value_type & el){
+                    return get(el);
+                });
+            }
+        };
+
+        template<>
+        struct np_fill<OGRPoint>:public np_fill_lonlat{};
+
+        template<>
+        struct np_fill<std::shared_ptr<OGRPoint>>:public np_fill_lonlat{};
+
+        ///@brief export the elements of a guide into a newly allocated numpy array without creating python objects where possible
         template<class T>
         np::ndarray guide_to_ndarray(const T & guide){
             using Element=typename T::Element;
-            np::dtype dtype = py::np_dtype<Element>::get();
             //create an numpy array
             p::tuple shape=p::make_tuple(guide.size());
-            np::ndarray py_array = np::empty(shape, dtype);
-            if (py::np_dtype<Element>::isobject()) {
-                std::transform(guide.begin(), guide.end(), reinterpret_cast<p::object *>(py_array.get_data()),
-                               [](const Element &el) {
-                                   return p::object(el);
-                               });
-            }else{
-                //copy values not object (pointers)
-                std::copy(guide.begin(),guide.end(),reinterpret_cast<Element*>(py_array.get_data()));
-
-            }
+            np::ndarray py_array = np::empty(shape, np_fill<Element>::dtype());
+            np_fill<Element>::fill(guide.begin(),guide.end(),py_array.get_data());
             return py_array;
         }
 
@@ -273,11 +420,24 @@ namespace frommle{
             }
         };
 
+        ///@brief obtain the slices which map the memory of an ndarray
+        template<class T>
+        std::vector<core::slice> ndarray_slices(const np::ndarray & ndar){
+            const int nd=ndar.get_nd();
+            auto slices=std::vector<core::slice>();
+            for(int i=0;i<nd;++i){
+                slices.push_back(core::make_slice(0,ndar.shape(i),ndar.strides(i)/sizeof(T)));
+            }
+            return slices;
+        }
+
+        ///@brief ndarray -> hyperslab converter which co-owns the numpy buffer
+        /// Compatible arrays are shared without copying, others are copied once into a C-contiguous array of T
         template<class T>
         struct ndarray_to_hslab{
         public:
             ndarray_to_hslab(){
-                p::converter::registry::push_back(&convertible, &construct,p::type_id<core::HyperSlabRef<T>>());
+                p::converter::registry::push_back(&convertible, &construct,p::type_id<core::HyperSlab<T>>());
             }
 
             static void* convertible(PyObject * py_obj){
@@ -291,43 +451,48 @@ namespace frommle{
 
             static void construct(PyObject *py_obj, p::converter::rvalue_from_python_stage1_data *data) {
 
-
-                np::ndarray ndar = static_cast<np::ndarray>(p::extract<np::ndarray>(py_obj)).astype(np_dtype<T>::get());
-
+                np::ndarray ndar = ndarray_compatible<T>(p::extract<np::ndarray>(py_obj));
 
                 //setup memory for C++ class
-                typedef p::converter::rvalue_from_python_storage<core::HyperSlabRef<T>> storage_t;
+                typedef p::converter::rvalue_from_python_storage<core::HyperSlab<T>> storage_t;
                 storage_t *the_storage = reinterpret_cast<storage_t *>( data );
                 void *memory_chunk = the_storage->storage.bytes;
 
-                //obtain the slices from the input array
-                size_t nd=ndar.get_nd();
+                //the shared_ptr holds a reference to the python object, so the buffer outlives the conversion
+                new(memory_chunk) core::HyperSlab<T>(ndarray_slices<T>(ndar),ndarray_shared<T>(ndar));
 
-                auto slices=std::vector<core::slice>();
-                for(int i=0;i<nd;++i){
-                    slices.push_back(core::make_slice(0,ndar.shape(i),ndar.strides(i)/sizeof(T)));
-                }
+                data->convertible = memory_chunk;
+            }
+        };
+
+        ///@brief ndarray -> hyperslab reference converter
+        /// A reference cannot own a copy, so only arrays whose buffer can be used directly are convertible
+        template<class T>
+        struct ndarray_to_hslabref{
+        public:
+            ndarray_to_hslabref(){
+                p::converter::registry::push_back(&convertible, &construct,p::type_id<core::HyperSlabRef<T>>());
+            }
 
-                //we want to create a shared_ptr to the data which is owned by python so we need to extract the
-                // owner of the data and apply an aliased shared_ptr contructor so the content of the shared_ptr does
-                //  not get deleted when the shared pointer is destructed
-//                p::incref(ndar.ptr());
-//                p::incref(ndar.get_base().ptr());
+            static void* convertible(PyObject * py_obj){
+                auto ndar = p::extract<np::ndarray>(py_obj);
+                if ( not ndar.check() or not ndarray_zerocopy<T>(ndar())){
+                    return 0;
+                }
+                return py_obj;
+            }
 
-//                std::shared_ptr<int> owner=std::make_shared<int>(1);
+            static void construct(PyObject *py_obj, p::converter::rvalue_from_python_stage1_data *data) {
 
-//                std::shared_ptr<T[]> sharedData(reinterpret_cast<T*>(ndar.get_data()),&nullDeleter<T>);
-//                new(memory_chunk) core::HyperSlab<T>(slices,sharedData);
+                np::ndarray ndar = p::extract<np::ndarray>(py_obj);
 
-                new(memory_chunk) core::HyperSlabRef<T>(slices,reinterpret_cast<T*>(ndar.get_data()));
+                //setup memory for C++ class
+                typedef p::converter::rvalue_from_python_storage<core::HyperSlabRef<T>> storage_t;
+                storage_t *the_storage = reinterpret_cast<storage_t *>( data );
+                void *memory_chunk = the_storage->storage.bytes;
 
-                //                core::HyperSlabRef<T> * hslabptr=static_cast<core::HyperSlabRef<T>*>(memory_chunk);
-//                hslabptr->setData(reinterpret_cast<T *>(ndar.get_data()));
-//
-//                std::shared_ptr<PyObject> owner(p::incref(ndar.get_base().ptr()));
-//                //use aliased shared_ptr constructor
-//                std::shared_ptr<T[]> sharedData(owner,reinterpret_cast<T*>(ndar.get_data()));
-//                core::HyperSlab<T> hslab(slices,sharedData);
+                //note: the data remains owned by the python object
+                new(memory_chunk) core::HyperSlabRef<T>(ndarray_slices<T>(ndar),reinterpret_cast<T*>(ndar.get_data()));
 
                 data->convertible = memory_chunk;
             }
@@ -373,6 +538,7 @@ namespace frommle{
         void register_hslab(){
             p::to_python_converter<core::HyperSlabBase<T>, hslab_to_ndarray <T>> ();
             ndarray_to_hslab<T>();
+            ndarray_to_hslabref<T>();
         }
 
 //    void register_numpy_converters();
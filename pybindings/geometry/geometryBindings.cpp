@@ -24,6 +24,7 @@
 #include <boost/python/return_value_policy.hpp>
 #include <boost/python/return_by_value.hpp>
 #include "../core/coreBindings.hpp"
+#include "../core/numpyConverting.hpp"
 #include <ogr_geometry.h>
 #include "geometry/GuideMakerTools.hpp"
 #include "geometry/Vec3DGuide.hpp"
@@ -164,6 +165,7 @@ using OGRPointGuide=OGRGuide<OGRPoint>;
 void (OGRPointGuide::*pb1)(const OGRPoint &)=&OGRPointGuide::push_back;
 void (OGRPointGuide::*pb2)(const std::string &)=&OGRPointGuide::push_back;
 const std::shared_ptr<OGRPoint> & (OGRPointGuide::*iget)(const size_t)const=&OGRPointGuide::operator[];
+void (OGRPolyGuide::*pbpoly)(const std::string &)=&OGRPolyGuide::push_back;
 const xyz & (Vec3DGuide::*vec3dget)(const size_t)const=&Vec3DGuide::operator[];
 
 void pyexport_geometry()
@@ -192,7 +194,11 @@ void pyexport_geometry()
         .def("append",pb2)
         //.def("idx",&OGRPointGuide::idx)
         .def("__getitem__",iget,p::return_value_policy<p::copy_const_reference>())
-        .def("__iter__",p::iterator<const OGRPointGuide>());
+        .def("__iter__",p::iterator<const OGRPointGuide>())
+        .def("__array__",&py::guide_to_ndarray<OGRPointGuide>);
+
+    p::class_<OGRPolyGuide,p::bases<GuideBase>>("PolyGuide",p::init<p::optional<std::string>>())
+        .def("append",pbpoly);
    
     p::def("makeFibonacciGrid",&makeFibonacciGrid);
 }
@@ -28,7 +28,10 @@
 #include <boost/python/return_value_policy.hpp>
 #include <boost/noncopyable.hpp>
 #include "io/ArchiveBase.hpp"
+#include "io/SHtxtArchive.hpp"
+#include "io/BINVArchive.hpp"
 #include "../core/numpyConverting.hpp"
+#include "../core/GILrelease.hpp"
 namespace p = boost::python;
 
 
@@ -120,13 +123,15 @@ namespace frommle{
 
                     if(hslab.ndim() ==1){
                         p::slice slc=py::slice_from_hslab<T>(hslab);
-                        core::HyperSlabRef<T> hslabtmp=getf(slc);
-                        hslab.useData(hslabtmp);
+                        //the owning hyperslab keeps the returned array alive while copying
+                        core::HyperSlab<T> hslabtmp=getf(slc);
+                        hslab.useData(core::HyperSlabRef<T>(hslabtmp));
                     }else{
                         //use a list of slices
                         p::list slc=py::slices_from_hslab<T>(hslab);
-                        core::HyperSlabRef<T> hslabtmp=getf(slc);
-                        hslab.useData(hslabtmp);
+                        //the owning hyperslab keeps the returned array alive while copying
+                        core::HyperSlab<T> hslabtmp=getf(slc);
+                        hslab.useData(core::HyperSlabRef<T>(hslabtmp));
                     }
                 }else{
                     Variable<T>::getValue(hslab);
@@ -237,6 +242,98 @@ namespace frommle{
             var.setValue(frptr);
         }
 
+
+        ///@brief wrap a column major (mapped) matrix as a read-only numpy array which keeps the archive alive
+        template<class M>
+        np::ndarray binv_view(const M & mat, p::object & owner){
+            return np::from_data(static_cast<const void*>(mat.data()),np::dtype::get_builtin<double>(),
+                    p::make_tuple(mat.rows(),mat.cols()),p::make_tuple(sizeof(double),sizeof(double)*mat.rows()),owner);
+        }
+
+        np::ndarray binv_pack(p::object self){
+            const BINVArchive & ar=p::extract<const BINVArchive&>(self);
+            auto pck=ar.pack();
+            return np::from_data(static_cast<const void*>(pck.data()),np::dtype::get_builtin<double>(),p::make_tuple(pck.size()),p::make_tuple(sizeof(double)),self);
+        }
+
+        np::ndarray binv_packedBlock(p::object self,const size_t iblk){
+            const BINVArchive & ar=p::extract<const BINVArchive&>(self);
+            auto pck=ar.packedBlock(iblk);
+            return np::from_data(static_cast<const void*>(pck.data()),np::dtype::get_builtin<double>(),p::make_tuple(pck.size()),p::make_tuple(sizeof(double)),self);
+        }
+
+        np::ndarray binv_vec(p::object self){
+            const BINVArchive & ar=p::extract<const BINVArchive&>(self);
+            return binv_view(ar.vec(),self);
+        }
+
+        np::ndarray binv_block(p::object self,const size_t iblk){
+            const BINVArchive & ar=p::extract<const BINVArchive&>(self);
+            return binv_view(ar.block(iblk),self);
+        }
+
+        ///@brief unpacked blocks are copied into a new numpy array
+        np::ndarray binv_unpack(const Eigen::MatrixXd & mat){
+            np::ndarray arr=np::empty(p::make_tuple(mat.rows(),mat.cols()),np::dtype::get_builtin<double>());
+            Eigen::Map<Eigen::Matrix<double,Eigen::Dynamic,Eigen::Dynamic,Eigen::RowMajor>>(reinterpret_cast<double*>(arr.get_data()),mat.rows(),mat.cols())=mat;
+            return arr;
+        }
+
+        np::ndarray binv_unpackBlock(const BINVArchive & ar,const size_t iblk){
+            Eigen::MatrixXd mat;
+            {
+                py::ScopedGILRelease nogil;
+                mat=ar.unpackBlock(iblk);
+            }
+            return binv_unpack(mat);
+        }
+
+        np::ndarray binv_unpackAll(const BINVArchive & ar){
+            Eigen::MatrixXd mat;
+            {
+                py::ScopedGILRelease nogil;
+                mat=ar.unpack();
+            }
+            return binv_unpack(mat);
+        }
+
+        ///@brief the spherical harmonic files are read in the constructor, so these factories do so without holding the GIL
+        std::shared_ptr<SHtxtArchive> shtxt_make(const std::string & filename, const SHtxtFormat format, const int nmax){
+            py::ScopedGILRelease nogil;
+            return std::make_shared<SHtxtArchive>(filename,format,nmax);
+        }
+
+        std::shared_ptr<SHtxtArchive> shtxt_makefmt(const std::string & filename, const SHtxtFormat format){
+            return shtxt_make(filename,format,-1);
+        }
+
+        std::shared_ptr<SHtxtArchive> shtxt_makeguess(const std::string & filename, const int nmax){
+            py::ScopedGILRelease nogil;
+            return std::make_shared<SHtxtArchive>(filename,nmax);
+        }
+
+        std::shared_ptr<SHtxtArchive> shtxt_makeguessall(const std::string & filename){
+            return shtxt_makeguess(filename,-1);
+        }
+
+        np::ndarray binv_blockind(const BINVArchive & ar){
+            np::ndarray arr=np::empty(p::make_tuple(ar.nblocks()),np::dtype::get_builtin<size_t>());
+            std::copy(ar.blockind().begin(),ar.blockind().end(),reinterpret_cast<size_t*>(arr.get_data()));
+            return arr;
+        }
+
+        p::list binv_names(const std::vector<std::string> & names){
+            p::list out;
+            for(const auto & name:names){
+                out.append(name);
+            }
+            return out;
+        }
+
+        p::list binv_side1(const BINVArchive & ar){return binv_names(ar.side1());}
+        p::list binv_side2(const BINVArchive & ar){return binv_names(ar.side2());}
+        p::list binv_metanames(const BINVArchive & ar){return binv_names(ar.metaNames());}
+
         void registerArchives(){
 
             register_group<double,int>::reg();
@@ -258,6 +355,45 @@ namespace frommle{
             register_var<int>::reg("Variable_int");
             //python fallback to register array like Variables with generic objects 
             register_var<PyObject>::reg("Variable_obj");
+
+            //readers for spherical harmonic text files
+            p::enum_<SHtxtFormat>("SHtxtFormat")
+                    .value("standard",SHtxtFormat::standard)
+                    .value("icgem",SHtxtFormat::icgem)
+                    .value("GSMv6",SHtxtFormat::GSMv6);
+
+            p::class_<SHtxtArchive,p::bases<core::TreeNodeCollection>,std::shared_ptr<SHtxtArchive>>("SHtxtArchive",p::no_init)
+                    .def("__init__",p::make_constructor(&shtxt_makeguessall))
+                    .def("__init__",p::make_constructor(&shtxt_makeguess))
+                    //note: overloads are tried in reverse order, so the explicit formats come last (an enum also converts to an int)
+                    .def("__init__",p::make_constructor(&shtxt_makefmt))
+                    .def("__init__",p::make_constructor(&shtxt_make))
+                    .add_property("cnm",&SHtxtArchive::cnm)
+                    .add_property("sigcnm",&SHtxtArchive::sigcnm)
+                    .add_property("nmax",&SHtxtArchive::nmax)
+                    .def("guessFormat",&SHtxtArchive::guessFormat).staticmethod("guessFormat");
+
+            //memory mapped reader for binary (block diagonal) matrices
+            p::class_<BINVArchive,p::bases<core::TreeNodeCollection>,boost::noncopyable>("BINVArchive",p::init<std::string>())
+                    .add_property("type",p::make_function(&BINVArchive::type,p::return_value_policy<p::copy_const_reference>()))
+                    .add_property("packedTriangular",&BINVArchive::packedTriangular)
+                    .add_property("swapped",&BINVArchive::swapped)
+                    .add_property("nval1",&BINVArchive::nval1)
+                    .add_property("nval2",&BINVArchive::nval2)
+                    .add_property("nvec",&BINVArchive::nvec)
+                    .add_property("nblocks",&BINVArchive::nblocks)
+                    .add_property("blockind",&binv_blockind)
+                    .add_property("side1",&binv_side1)
+                    .add_property("side2",&binv_side2)
+                    .add_property("metanames",&binv_metanames)
+                    .add_property("pack",&binv_pack)
+                    .add_property("vec",&binv_vec)
+                    .def("blockStart",&BINVArchive::blockStart)
+                    .def("blockSize",&BINVArchive::blockSize)
+                    .def("packedBlock",&binv_packedBlock)
+                    .def("block",&binv_block)
+                    .def("unpackBlock",&binv_unpackBlock)
+                    .def("unpack",&binv_unpackAll);
         }
     }
 }
@@ -3,8 +3,12 @@
 #include "sh/SHisoOperator.hpp"
 #include "sh/Legendre_nm.hpp"
 #include "sh/Ynm.hpp"
+#include "sh/xyz2SH.hpp"
+#include "sh/polygon2SH.hpp"
+#include "sh/DDKfilter.hpp"
 #include "../core/coreGuides.hpp"
 #include "../core/tupleconversion.hpp"
+#include "../core/GILrelease.hpp"
 #include <boost/python/return_value_policy.hpp>
 #include <boost/python/copy_non_const_reference.hpp>
 
@@ -30,6 +34,72 @@ struct register_shisooperator{
     }
 };
 
+template<class T>
+struct register_xyz2sh{
+    using op_t=XYZ2SH<T>;
+    register_xyz2sh(std::string basename){
+        p::class_<op_t,p::bases<core::GOperatorDyn<T,1,1>>>(basename.c_str(),p::init<const SHGuide &,p::optional<int>>())
+            .def("__call__",&register_xyz2sh::call)
+            .def("reset",&op_t::reset)
+            .def("accumulate",&register_xyz2sh::accumulate)
+            .def("solve",&register_xyz2sh::solve)
+            .add_property("nobs",&op_t::nobs)
+            .add_property("nthreads",&op_t::nThreads,&op_t::setNThreads);
+    }
+
+    static std::shared_ptr<core::GArrayDense<T,2>> call(op_t & op, const core::GArrayDense<T,2> & gin){
+        frommle::py::ScopedGILRelease nogil;
+        return std::dynamic_pointer_cast<core::GArrayDense<T,2>>(op(gin));
+    }
+
+    static void accumulate(op_t & op, const core::GArrayBase<T,2> & obs){
+        frommle::py::ScopedGILRelease nogil;
+        op.accumulate(obs);
+    }
+
+    static void solve(const op_t & op, core::GArrayBase<T,2> & gout){
+        frommle::py::ScopedGILRelease nogil;
+        op.solve(gout);
+    }
+};
+
+template<class T>
+struct register_polygon2sh{
+    using op_t=Polygon2SH<T>;
+    register_polygon2sh(std::string basename){
+        p::class_<op_t,p::bases<core::GOperatorDyn<T,1,1>>>(basename.c_str(),p::init<const SHGuide &,p::optional<int,int>>())
+            .def("__call__",&register_polygon2sh::call)
+            .def("__call__",&register_polygon2sh::callpolys)
+            .add_property("oversample",&op_t::oversample)
+            .add_property("nthreads",&op_t::nThreads,&op_t::setNThreads);
+    }
+
+    static std::shared_ptr<core::GArrayDense<T,2>> call(op_t & op, const core::GArrayDense<T,2> & gin){
+        frommle::py::ScopedGILRelease nogil;
+        return std::dynamic_pointer_cast<core::GArrayDense<T,2>>(op(gin));
+    }
+
+    static std::shared_ptr<core::GArrayDense<T,2>> callpolys(op_t & op, const guides::OGRPolyGuide & polys){
+        frommle::py::ScopedGILRelease nogil;
+        return std::dynamic_pointer_cast<core::GArrayDense<T,2>>(op(polys));
+    }
+};
+
+///@brief compute the associated Legendre functions without holding the GIL (the result is copied after reacquiring it)
+template<class T>
+Legendre_nm<T> & legendre_set(Legendre_nm<T> & pnm, const T costheta){
+    frommle::py::ScopedGILRelease nogil;
+    return pnm.set(costheta);
+}
+
+
+struct register_ddkfilter{
+    register_ddkfilter(std::string basename){
+        p::class_<DDKfilter,p::bases<core::GOperatorBlockDiag<double>>>(basename.c_str(),p::init<std::string,p::optional<int,bool>>())
+            .add_property("nmax",&DDKfilter::nmax);
+    }
+};
+
 
 void pyexport_sh()
 {
@@ -75,9 +145,18 @@ void pyexport_sh()
     //register SHisoperator
     register_shisooperator<double>("shisoperator");
 
+    //register the block diagonal DDK filter
+    register_ddkfilter("ddkfilter");
+
+    //register the least squares estimation of SH coefficients from scattered points
+    register_xyz2sh<double>("xyz2shOperator");
+
+    //register the expansion of polygons in spherical harmonics
+    register_polygon2sh<double>("polygon2shOperator");
+
 
     p::class_<Legendre_nm<double>,p::bases<core::GArrayDense<double,1>>>("Legendre_nm",p::init<int>())
-            .def("set",&sh::Legendre_nm_d::set,p::return_value_policy<p::copy_non_const_reference>());
+            .def("set",&legendre_set<double>,p::return_value_policy<p::copy_non_const_reference>());
     
     //register Spherical harmonics operator
 
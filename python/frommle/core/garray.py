@@ -33,6 +33,14 @@ def makeGArray(*guides,**kwargs):
     else:
         name="data"
 
+    if "data" in kwargs:
+        #use an existing numpy array as storage (shared when it is C-contiguous and of the same dtype, copied otherwise)
+        if dt == np.float64:
+            return makeGArray_float64(makeGuidePack(*guides),kwargs["data"],name)
+
+        if dt == np.dtype('uint64'):
+            return makeGArray_uint64(makeGuidePack(*guides),kwargs["data"],name)
+
     if dt == np.float64:
         return makeGArray_float64(makeGuidePack(*guides),name)
 
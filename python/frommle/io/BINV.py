@@ -16,10 +16,39 @@
 # Author Roelof Rietbroek (roelof@geod.uni-bonn.de), 2018
 import struct
 import numpy as np
+from frommle.io import BINVArchive
 
 def readBIN(filename,unpack=False):
     """Reads in a binary file written using the fortran RLFTlbx.
-    Pretty slow currenlty so a cpp version is foreseen"""
+    Uses the memory mapped C++ reader, the packed matrix and vectors are returned as read-only numpy views
+    :param unpack: when True, also return the unpacked matrix in the entry 'mat'"""
+    binv=BINVArchive(filename)
+    dictout={ky:binv.attr[ky] for ky in ["version","type","description","nval1","nval2"]}
+    if "readme" in binv.attr:
+        dictout["readme"]=binv.attr["readme"]
+
+    if binv.metanames:
+        dictout["meta"]={ky:binv.attr[ky] for ky in binv.metanames}
+
+    dictout["side1_d"]=np.array(binv.side1)
+    if binv.side2:
+        dictout["side2_d"]=np.array(binv.side2)
+
+    if dictout["type"] in ["BDSYMV0_","BDSYMVN_","BDFULLV0","BDFULLVN"]:
+        dictout["nblocks"]=binv.nblocks
+        dictout["blockind"]=binv.blockind
+
+    if binv.nvec > 0:
+        dictout["vec"]=binv.vec
+
+    dictout["pack"]=binv.pack
+    if unpack:
+        dictout["mat"]=binv.unpack()
+
+    return dictout
+
+def readBIN_py(filename,unpack=False):
+    """Reads in a binary file written using the fortran RLFTlbx (pure python version)"""
     dictout={}
     #default to assuming the file is in little endian
     endianness='<'
@@ -24,18 +24,20 @@ import logging
 from frommle.sh import trig
 import numpy as np
 from frommle.io.shArchive import SHArchive
-from frommle.io import Variable
+from frommle.io import Variable,SHtxtFormat
 from frommle.io.numpyVariable import np_float64Var
 
 
 class SHGSMv6Archive(SHArchive):
-    def __init__(self,filen,mode='r',nmax=-1):
-        super().__init__(filen,mode,nmax)
+    def __init__(self,filen,mode='r',nmax=-1,native=True):
+        super().__init__(filen,mode,nmax,native)
         self.fload()
 
     def fload_impl(self):
         """Loads the data into variables"""
-        # import pdb;pdb.set_trace()
+        if self.fload_native(SHtxtFormat.GSMv6):
+            return
+
         buf=StringIO()
         with self.fid() as fid:
             for ln in fid:
@@ -7,7 +7,7 @@ import re
 import numpy as np
 from frommle.sh import SHnmtGuide,trig
 from frommle.io.shArchive import SHArchive
-from frommle.io import Variable
+from frommle.io import Variable,SHtxtFormat
 from frommle.io.numpyVariable import np_float64Var
 
 from datetime import datetime
@@ -73,11 +73,14 @@ class icgemLineParser():
             return "asin",n,m,scale*C,scale*S,scale*sigC,scale*sigS
 
 class SHicgemArchive(SHArchive):
-    def __init__(self,filen,mode='r',nmax=-1):
-        super().__init__(filen,mode=mode,nmax=nmax)
+    def __init__(self,filen,mode='r',nmax=-1,native=True):
+        super().__init__(filen,mode=mode,nmax=nmax,native=native)
 
     def fload_impl(self):
         """Loads the data into variables"""
+        if self.fload_native(SHtxtFormat.icgem):
+            return
+
         with self.fid() as fid:
             #first extract the icgem header
             hdr={}
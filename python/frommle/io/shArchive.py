@@ -17,7 +17,7 @@
 
 
 from frommle.core import typehash
-from frommle.io import Group,Variable
+from frommle.io import Group,Variable,SHtxtArchive
 from frommle.io.numpyVariable import np_float64Var
 from frommle.sh import SHnmtGuide
 import gzip as gz
@@ -36,7 +36,9 @@ class SHArchive(Group):
     #Varnames holds valid variable names with variable classes which may be overloaded/extended in derived classes
     vars={"shg":Variable,"cnm":np_float64Var,"sigcnm":np_float64Var}
     shg_c=SHnmtGuide
-    def __init__(self,filename,mode='r',nmax=-1):
+    def __init__(self,filename,mode='r',nmax=-1,native=True):
+        #use the C++ reader when possible (set to False to force the python implementation)
+        self.native=native
         if type(filename) == str:
             #important: initialize Group class as well
             Group.__init__(self,filename)
@@ -104,5 +106,27 @@ class SHArchive(Group):
     def fload_impl(self):
         pass
 
+    def fload_native(self,shformat,attrnames=["nmaxfile","nmax","format","gm","re","modelname","tidesystem","tstart","tcent","tend"]):
+        """Loads the coefficients with the (much faster) C++ reader when possible
+        :param shformat: SHtxtFormat of the file
+        :param attrnames: attributes which will be copied from the C++ archive
+        :returns: True when the data has been loaded and False otherwise"""
+        if not self.native or self.openfid or self.shg_c != SHnmtGuide:
+            #the C++ reader requires a filename and stores the coefficients in a SHnmtGuide
+            return False
+        if "nmax" in self.attr:
+            shar=SHtxtArchive(self.name,shformat,self.attr["nmax"])
+        else:
+            shar=SHtxtArchive(self.name,shformat)
+
+        for ky in attrnames:
+            if ky in shar.attr:
+                self.attr[ky]=shar.attr[ky]
+
+        self["cnm"]=np_float64Var(shar.cnm.mat.copy())
+        self["shg"]=Variable(self.shg_c(shar.nmax))
+        self["sigcnm"]=np_float64Var(shar.sigcnm.mat.copy())
+        return True
+
     def fsave_impl(self):
         pass
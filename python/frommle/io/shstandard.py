@@ -18,7 +18,7 @@
 import numpy as np
 from frommle.sh import SHnmtGuide,trig
 from frommle.io.shArchive import SHArchive
-from frommle.io import Variable
+from frommle.io import Variable,SHtxtFormat
 from frommle.io.numpyVariable import np_float64Var
 
 # from frommle.sh.shxarray import newshxarray
@@ -26,11 +26,17 @@ from frommle.io.numpyVariable import np_float64Var
 from frommle.core.time import decyear2datetime,datetime2decyear
 
 class SHStandardArchive(SHArchive):
-    def __init__(self,filen,mode='r',nmax=-1):
-        super().__init__(filen,mode,nmax)
+    def __init__(self,filen,mode='r',nmax=-1,native=True):
+        super().__init__(filen,mode,nmax,native)
 
     def fload_impl(self):
         """Loads the data into variables"""
+        if self.fload_native(SHtxtFormat.standard):
+            #the C++ reader stores the times as decimal years
+            for ky in ["tstart","tcent","tend"]:
+                if ky in self.attr:
+                    self.attr[ky]=decyear2datetime(self.attr[ky])
+            return
 
         witherrors=False
         with self.fid() as fid:
@@ -18,14 +18,24 @@
 from frommle.io.BINV import readBIN
 import numpy as np
 from frommle.sh.shdata import shdata
+from frommle.sh import SHtmnGuide,ddkfilter
+from frommle.core import IndexGuide
+from frommle.core.garray import makeGArray
 import math
 
 class DDKfilter():
-    def __init__(self,filtername,transpose=False):
+    def __init__(self,filtername,transpose=False,native=False):
         """Reads  filter coefficients from file
         Transpose causes the filter to be applied in its transpose form (e.g. needed for filtering basin before
-        basin averaging operations)"""
+        basin averaging operations)
+        Native applies the filter with the block diagonal C++ operator (blocks are processed concurrently)"""
 
+        self.filtername=filtername
+        self.transpose=transpose
+        self.native=native
+        self.nativeops={}
+        if native:
+            return
 
         W=readBIN(filtername)
         if W['type'] != "BDFULLV0":
@@ -71,6 +81,9 @@ class DDKfilter():
     def __call__(self,incoef):
         """Filter coefficients"""
 
+        if self.native:
+            return self.callnative(incoef)
+
         if incoef.nmax > self.nmax:
             raise ValueError("Maximum degree of filter matrix is smaller than the maximum input degree")
         shfilt=shdata(incoef.nmax)
@@ -87,3 +100,21 @@ class DDKfilter():
                 np.dot(incoef.S[st:nd],block[:ndblck,:ndblck],out=shfilt.S[st:nd])
 
         return shfilt
+
+    def callnative(self,incoef):
+        """Filter coefficients with the C++ block diagonal operator"""
+        if incoef.nmax not in self.nativeops:
+            self.nativeops[incoef.nmax]=ddkfilter(self.filtername,incoef.nmax,self.transpose)
+        op=self.nativeops[incoef.nmax]
+
+        #the cosine coefficients are followed by the sine coefficients in the SHtmnGuide
+        nhalf=len(incoef.C)
+        gin=makeGArray(SHtmnGuide(incoef.nmax),IndexGuide(1))
+        gin.mat[:nhalf,0]=incoef.C
+        gin.mat[nhalf:,0]=incoef.S
+        gout=op(gin)
+
+        shfilt=shdata(incoef.nmax)
+        shfilt.C[:]=gout.mat[:nhalf,0]
+        shfilt.S[:]=gout.mat[nhalf:,0]
+        return shfilt
@@ -2,3 +2,5 @@
 from frommle._core import *
 from frommle._sh import *
 from .rastio2sh import *
+from .xyz2sh import *
+from .polygon2sh import *
@@ -17,6 +17,32 @@
 
 
 
-def polygon2sh(geomshape,nmax=200):
-    """Compute a spherical harmonic expansion from a shapely polygon"""
-    pass
+import numpy as np
+from frommle.sh import SHGuide,polygon2shOperator
+from frommle.geometry import PolyGuide
+from frommle.core import makeGArray,IndexGuide
+
+def polygon2sh(geomshape,nmax=200,oversample=2,nthreads=0):
+    """Compute a spherical harmonic expansion from a shapely polygon
+    :param geomshape: shapely (multi)polygon, an iterable of polygons or a PolyGuide (lon lat in degrees)
+    :param nmax: maximum degree of the expansion
+    :param oversample: refinement factor of the internal quadrature grid on which the polygons are rasterized
+    :param nthreads: amount of threads to use (0 uses all available cores)
+    :returns: GArray with an SHGuide as first dimension. A shapely (multi)polygon yields a single column (the parts of a multipolygon are summed),
+    while iterables of polygons and PolyGuides yield a column for every polygon"""
+    op=polygon2shOperator(SHGuide(nmax),oversample,nthreads)
+    if isinstance(geomshape,PolyGuide):
+        return op(geomshape)
+
+    polys=PolyGuide()
+    if hasattr(geomshape,"geoms"):
+        #shapely multipolygon: the indicator function is the sum of its (non-overlapping) parts
+        for geom in geomshape.geoms:
+            polys.append(geom.wkt)
+        weights=makeGArray(polys,IndexGuide(1),data=np.ones([len(geomshape.geoms),1]))
+        return op(weights)
+    elif hasattr(geomshape,"wkt"):
+        geomshape=[geomshape]
+    for geom in geomshape:
+        polys.append(geom.wkt)
+    return op(polys)
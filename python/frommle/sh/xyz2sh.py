@@ -14,3 +14,14 @@
 # Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 # Author Roelof Rietbroek (roelof@wobbly.earth), 2021
+
+from frommle.sh import SHGuide,xyz2shOperator
+
+def xyz2sh(pointdata,nmax,nthreads=0):
+    """Estimates spherical harmonic coefficients up to degree nmax from values at scattered points by least squares
+    :param pointdata: GArray with a PointGuide as first dimension (additional columns are estimated simultaneously)
+    :param nmax: maximum degree of the estimated coefficients
+    :param nthreads: amount of threads to use (0 uses all available cores)
+    :returns: GArray with an SHGuide as first dimension (the unobservable order zero sine coefficients are zero)"""
+    op=xyz2shOperator(SHGuide(nmax),nthreads)
+    return op(pointdata)
@@ -19,7 +19,7 @@ def yieldExtensions():
         libraries = ["${FROMMLEPYLIB}","${FROMMLELIB}"
             ,getLibraryAlias("${GDAL_LIBRARY}"),getLibraryAlias("${YAML_CPP_LIBRARY}")
             ,getLibraryAlias("${Boost_LOG_LIBRARY_RELEASE}"),getLibraryAlias("${Boost_LOG_SETUP_LIBRARY_RELEASE}")
-            ,getLibraryAlias("${Boost_FILESYSTEM_LIBRARY_RELEASE}"),getLibraryAlias("${Boost_IOSTREAMS_LIBRARY_RELEASE}")
+            ,getLibraryAlias("${Boost_FILESYSTEM_LIBRARY_RELEASE}"),getLibraryAlias("${Boost_IOSTREAMS_LIBRARY_RELEASE}"),getLibraryAlias("${ZLIB_LIBRARIES}")
             ,getLibraryAlias("${Boost_PYTHON_LIBRARY_RELEASE}"),getLibraryAlias("${Boost_NUMPY_LIBRARY_RELEASE}"),getLibraryAlias("${Boost_SYSTEM_LIBRARY_RELEASE}")],
         include_dirs=["${Boost_INCLUDE_DIR}","${CMAKE_SOURCE_DIR}"],
         runtime_library_dirs = ["${PROJECT_BINARY_DIR}/lib"])
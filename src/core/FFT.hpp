@@ -0,0 +1,192 @@
+/*! \file
+ \brief Small mixed-radix fast Fourier transform (no external dependencies)
+ \copyright Roelof Rietbroek 2020
+ \license
+ This file is part of Frommle.
+ frommle is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3 of the License, or (at your option) any later version.
+
+ Frommle is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with Frommle; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <complex>
+#include <vector>
+#include <cmath>
+#include <memory>
+#include "core/Exceptions.hpp"
+
+#ifndef FROMMLE_FFT_HPP
+#define FROMMLE_FFT_HPP
+
+namespace frommle{
+    namespace core{
+
+        /*!@brief Precomputed plan for a complex FFT of arbitrary length
+         * The length is factored in (small) prime factors and a recursive Cooley-Tukey algorithm is applied
+         * Lengths with a prime factor larger than maxradix are transformed with Bluestein's chirp-z algorithm, which keeps those at O(n log n)
+         * The plan is immutable after construction so it can be shared between threads
+         */
+        template<class T>
+        class FFTplan{
+        public:
+            using cplx=std::complex<T>;
+            ///@brief largest prime factor which is handled by a direct butterfly
+            static const size_t maxradix=32;
+            FFTplan()=default;
+            FFTplan(const size_t n):n_(n),twiddle_(n){
+                if (n == 0){
+                    THROWINPUTEXCEPTION("FFT length must be larger than 0");
+                }
+                //factorize (prefer radix 4 and 2 first)
+                size_t nrem=n;
+                while(nrem%4 == 0){
+                    factors_.push_back(4);
+                    nrem/=4;
+                }
+                for(size_t p=2;nrem>1;){
+                    if(nrem%p == 0){
+                        factors_.push_back(p);
+                        nrem/=p;
+                    }else{
+                        p=(p==2)?3:p+2;
+                        if(p*p > nrem){
+                            p=nrem;
+                        }
+                    }
+                }
+                const T pi2=8*std::atan(T(1.0));
+                for(size_t i=0;i<n_;++i){
+                    twiddle_[i]=std::polar(T(1.0),-pi2*i/n_);
+                }
+                if(maxfactor() > maxradix){
+                    setupBluestein();
+                }
+            }
+
+            size_t size()const{return n_;}
+
+            ///@brief forward transform (exponent -2 pi i jk/n), unnormalized
+            void fwd(const cplx * in, cplx * out)const{transform(in,out,false);}
+            ///@brief backward transform (exponent +2 pi i jk/n), unnormalized
+            void bwd(const cplx * in, cplx * out)const{transform(in,out,true);}
+
+        private:
+            size_t n_=0;
+            std::vector<size_t> factors_{};
+            std::vector<cplx> twiddle_{};
+            ///@brief chirp exp(-i pi k^2/n) and the transformed conjugate chirp (Bluestein only)
+            std::vector<cplx> chirp_{};
+            std::vector<cplx> chirpfft_{};
+            ///@brief power of two plan used for the convolution (Bluestein only)
+            std::shared_ptr<const FFTplan<T>> conv_{};
+
+            void setupBluestein(){
+                size_t m=1;
+                while(m < 2*n_-1){
+                    m*=2;
+                }
+                conv_=std::make_shared<const FFTplan<T>>(m);
+                const T pi=4*std::atan(T(1.0));
+                chirp_.resize(n_);
+                for(size_t k=0;k<n_;++k){
+                    //reduce k^2 modulo 2n to retain accuracy for large k
+                    chirp_[k]=std::polar(T(1.0),-pi*static_cast<T>((k*k)%(2*n_))/n_);
+                }
+                std::vector<cplx> b(m,cplx(0.0));
+                b[0]=std::conj(chirp_[0]);
+                for(size_t k=1;k<n_;++k){
+                    b[k]=b[m-k]=std::conj(chirp_[k]);
+                }
+                chirpfft_.resize(m);
+                conv_->fwd(b.data(),chirpfft_.data());
+            }
+
+            void bluestein(const cplx * in, cplx * out, const bool inverse)const{
+                //the inverse transform is the conjugate of the forward transform of the conjugated input
+                const size_t m=conv_->size();
+                std::vector<cplx> a(m,cplx(0.0));
+                std::vector<cplx> fa(m);
+                for(size_t k=0;k<n_;++k){
+                    a[k]=(inverse?std::conj(in[k]):in[k])*chirp_[k];
+                }
+                conv_->fwd(a.data(),fa.data());
+                for(size_t j=0;j<m;++j){
+                    fa[j]*=chirpfft_[j];
+                }
+                conv_->bwd(fa.data(),a.data());
+                for(size_t k=0;k<n_;++k){
+                    const cplx v=chirp_[k]*a[k]/static_cast<T>(m);
+                    out[k]=inverse?std::conj(v):v;
+                }
+            }
+
+            void transform(const cplx * in, cplx * out, const bool inverse)const{
+                if(conv_){
+                    bluestein(in,out,inverse);
+                    return;
+                }
+                //scratch space for the butterflies
+                std::vector<cplx> scratch(2*maxfactor());
+                recurse(in,out,n_,1,0,inverse,scratch.data());
+            }
+
+            size_t maxfactor()const{
+                size_t pmax=1;
+                for(auto p:factors_){
+                    pmax=std::max(p,pmax);
+                }
+                return pmax;
+            }
+
+            inline cplx tw(const size_t i, const bool inverse)const{
+                return inverse?std::conj(twiddle_[i%n_]):twiddle_[i%n_];
+            }
+
+            void recurse(const cplx * in, cplx * out, const size_t n, const size_t stride, const size_t ifac, const bool inverse, cplx * scratch)const{
+                if(n == 1){
+                    out[0]=in[0];
+                    return;
+                }
+                const size_t p=factors_[ifac];
+                const size_t m=n/p;
+                //transform the p decimated sub sequences
+                for(size_t q=0;q<p;++q){
+                    recurse(in+q*stride,out+q*m,m,stride*p,ifac+1,inverse,scratch);
+                }
+
+                //combine the sub sequences using a radix p butterfly
+                cplx * t=scratch;
+                cplx * y=scratch+p;
+                //step in the twiddle table which corresponds to the current length n
+                const size_t step=n_/n;
+                for(size_t k=0;k<m;++k){
+                    for(size_t q=0;q<p;++q){
+                        t[q]=out[q*m+k]*tw(q*k*step,inverse);
+                    }
+                    for(size_t r=0;r<p;++r){
+                        cplx sum=t[0];
+                        for(size_t q=1;q<p;++q){
+                            sum+=t[q]*tw(((q*r)%p)*m*step,inverse);
+                        }
+                        y[r]=sum;
+                    }
+                    for(size_t r=0;r<p;++r){
+                        out[k+r*m]=y[r];
+                    }
+                }
+            }
+        };
+
+    }
+}
+
+#endif //FROMMLE_FFT_HPP
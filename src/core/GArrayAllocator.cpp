@@ -0,0 +1,117 @@
+/*! \file
+ \brief Implementation of the aligned and pooled allocators for dense GArrays
+ \copyright Roelof Rietbroek 2021
+ \license
+ This file is part of Frommle.
+ frommle is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3 of the License, or (at your option) any later version.
+
+ Frommle is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with Frommle; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "core/GArrayAllocator.hpp"
+#include <cstdlib>
+#include <new>
+
+namespace frommle{
+    namespace core{
+
+        const size_t DenseAllocator::alignment;
+
+        void * DenseAllocator::sysAllocate(const size_t nbytes){
+            void * ptr=nullptr;
+            if (posix_memalign(&ptr,alignment,nbytes) != 0){
+                throw std::bad_alloc();
+            }
+            ++nsys_;
+            return ptr;
+        }
+
+        void DenseAllocator::sysDeallocate(void *ptr) {
+            std::free(ptr);
+        }
+
+        ///@brief returns the power of two bucket which can hold the requested amount of bytes (at least the alignment)
+        int PooledAllocator::bucket(const size_t nbytes) {
+            int ib=0;
+            while((alignment << ib) < nbytes){
+                ++ib;
+            }
+            return ib;
+        }
+
+        void * PooledAllocator::allocate(const size_t nbytes) {
+            ++nreq_;
+            const int ib=bucket(nbytes);
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                if (ib < pool_.size() and !pool_[ib].empty()){
+                    void * ptr=pool_[ib].back();
+                    pool_[ib].pop_back();
+                    cached_-=(alignment << ib);
+                    return ptr;
+                }
+            }
+            //allocate the full bucket size so the buffer can be reused for any request in this bucket
+            return sysAllocate(alignment << ib);
+        }
+
+        void PooledAllocator::deallocate(void *ptr, const size_t nbytes) {
+            const int ib=bucket(nbytes);
+            const size_t bsize=alignment << ib;
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                if (cached_+bsize <= maxcache_){
+                    if (ib >= pool_.size()){
+                        pool_.resize(ib+1);
+                    }
+                    pool_[ib].push_back(ptr);
+                    cached_+=bsize;
+                    return;
+                }
+            }
+            sysDeallocate(ptr);
+        }
+
+        void PooledAllocator::release() {
+            std::lock_guard<std::mutex> lock(mtx_);
+            for(auto & bck:pool_){
+                for(auto ptr:bck){
+                    sysDeallocate(ptr);
+                }
+                bck.clear();
+            }
+            cached_=0;
+        }
+
+        static DenseAllocPtr & defaultAllocRef(){
+            static DenseAllocPtr alloc=std::make_shared<DenseAllocator>();
+            return alloc;
+        }
+
+        static std::mutex & defaultAllocMutex(){
+            static std::mutex mtx;
+            return mtx;
+        }
+
+        DenseAllocPtr defaultDenseAllocator() {
+            std::lock_guard<std::mutex> lock(defaultAllocMutex());
+            return defaultAllocRef();
+        }
+
+        void setDefaultDenseAllocator(DenseAllocPtr alloc) {
+            std::lock_guard<std::mutex> lock(defaultAllocMutex());
+            defaultAllocRef()=alloc?alloc:std::make_shared<DenseAllocator>();
+        }
+
+    }
+}
@@ -0,0 +1,113 @@
+/*! \file
+ \brief Aligned and pooled memory allocation for the storage of dense GArrays
+ \copyright Roelof Rietbroek 2021
+ \license
+ This file is part of Frommle.
+ frommle is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3 of the License, or (at your option) any later version.
+
+ Frommle is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with Frommle; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <type_traits>
+
+#ifndef FROMMLE_GARRAYALLOCATOR_HPP
+#define FROMMLE_GARRAYALLOCATOR_HPP
+
+namespace frommle{
+    namespace core{
+
+        /*!@brief Allocates raw memory for the storage of dense arrays, aligned at 64 bytes (cache line and AVX-512 width)
+         * Derived classes can override allocate/deallocate to provide different strategies
+         */
+        class DenseAllocator{
+        public:
+            static const size_t alignment=64;
+            virtual ~DenseAllocator(){}
+            virtual void * allocate(const size_t nbytes){
+                ++nreq_;
+                return sysAllocate(nbytes);
+            }
+            virtual void deallocate(void * ptr, const size_t nbytes){sysDeallocate(ptr);}
+
+            ///@brief number of allocation requests
+            size_t nRequests()const{return nreq_;}
+            ///@brief number of allocations which were forwarded to the system
+            size_t nSysAlloc()const{return nsys_;}
+            void resetStats(){nreq_=0;nsys_=0;}
+        protected:
+            void * sysAllocate(const size_t nbytes);
+            void sysDeallocate(void * ptr);
+            std::atomic<size_t> nreq_{0};
+            std::atomic<size_t> nsys_{0};
+        };
+
+        /*!@brief Allocator which recycles released buffers in power of two size buckets
+         * Buffers are returned to the pool when the last owner releases them, as long as the total amount of cached memory stays below a limit
+         */
+        class PooledAllocator:public DenseAllocator{
+        public:
+            PooledAllocator(const size_t maxcache=size_t(256)*1024*1024):maxcache_(maxcache){}
+            ~PooledAllocator()override{release();}
+            void * allocate(const size_t nbytes)override;
+            void deallocate(void * ptr, const size_t nbytes)override;
+            ///@brief free all cached buffers
+            void release();
+            ///@brief amount of bytes currently held in the pool (may be read while other threads allocate)
+            size_t cached()const{return cached_;}
+        private:
+            static int bucket(const size_t nbytes);
+            size_t maxcache_=0;
+            std::atomic<size_t> cached_{0};
+            std::mutex mtx_{};
+            std::vector<std::vector<void*>> pool_{};
+        };
+
+        using DenseAllocPtr=std::shared_ptr<DenseAllocator>;
+
+        ///@brief the allocator which is used by newly created dense arrays
+        DenseAllocPtr defaultDenseAllocator();
+
+        ///@brief replace the default allocator (existing arrays keep a reference to the allocator which created them)
+        void setDefaultDenseAllocator(DenseAllocPtr alloc);
+
+        ///@brief allocate storage for n default-initialized elements, which is handed back to the allocator when the last owner releases it
+        template<class T>
+        std::shared_ptr<T[]> allocateDense(const size_t n, DenseAllocPtr alloc=defaultDenseAllocator()){
+            if (n == 0){
+                return std::shared_ptr<T[]>();
+            }
+            const size_t nbytes=n*sizeof(T);
+            T* ptr=static_cast<T*>(alloc->allocate(nbytes));
+            if (!std::is_trivially_default_constructible<T>::value){
+                for(size_t i=0;i<n;++i){
+                    new(ptr+i) T;
+                }
+            }
+            return std::shared_ptr<T[]>(ptr,[alloc,n,nbytes](T* p){
+                if (!std::is_trivially_destructible<T>::value){
+                    for(size_t i=0;i<n;++i){
+                        p[i].~T();
+                    }
+                }
+                alloc->deallocate(p,nbytes);
+            });
+        }
+
+    }
+}
+
+#endif //FROMMLE_GARRAYALLOCATOR_HPP
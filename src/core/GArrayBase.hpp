@@ -134,7 +134,7 @@ namespace frommle {
 
             gp_ptr_t &gpp() { return gp_; }
 
-            ///@brief assign array a scalar (needs to be implemented in derived classes)
+            ///@brief assign array a scalar (needs to be implemented in derived classes, sparse arrays only accept zero)
             virtual GArrayBase &operator=(const T scalar)=0;
             template<class GA>
             GA as(){
@@ -0,0 +1,87 @@
+/*! \file
+ \brief Holds a block diagonal array with dense storage of the individual blocks
+ \copyright Roelof Rietbroek 2021
+ \license
+ This file is part of Frommle.
+ frommle is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3 of the License, or (at your option) any later version.
+
+ Frommle is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with Frommle; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "core/GArrayBase.hpp"
+#include "core/Exceptions.hpp"
+#include <eigen3/Eigen/Core>
+#include <vector>
+
+#ifndef FROMMLE_GARRAYBLOCKDIAG_HPP
+#define FROMMLE_GARRAYBLOCKDIAG_HPP
+namespace frommle{
+    namespace core{
+        /*!@brief contains a square block diagonal array
+         * The blocks are described by their cumulative end indices along the (shared) guide of both dimensions
+         * and are each stored as a dense (column major) Eigen matrix
+         */
+        template<class T>
+        class GArrayBlockDiag:public GArrayBase<T,2>{
+        public:
+            using GAB=GArrayBase<T,2>;
+            using eigm=Eigen::Matrix<T,Eigen::Dynamic,Eigen::Dynamic>;
+            using GAB::gpp;
+            using GAB::gp;
+            using typename GAB::gp_ptr_t;
+
+            GArrayBlockDiag():GAB("blockdiag"){}
+
+            ///@brief constructor which uses the same guide for both dimensions and initializes the blocks with identity matrices
+            template<class GP, typename std::enable_if<std::is_base_of<guides::GuidePackDyn<1>, GP>::value, int> ::type = 0>
+            GArrayBlockDiag(GP guidepack, std::vector<size_t> blockends):GAB(guidepack.append(guidepack.gv(0))),blockend_(std::move(blockends)){
+                if (blockend_.empty() or blockend_.back() != gpp()->at(0)->size()){
+                    THROWINPUTEXCEPTION("Block indices do not cover the guide");
+                }
+                blocks_.reserve(blockend_.size());
+                for(size_t iblk=0;iblk<blockend_.size();++iblk){
+                    if (iblk > 0 and blockend_[iblk] < blockend_[iblk-1]){
+                        THROWINPUTEXCEPTION("Block indices must be increasing");
+                    }
+                    blocks_.push_back(eigm::Identity(blockSize(iblk),blockSize(iblk)));
+                }
+            }
+
+            core::typehash hash()const override{return core::typehash("GArBlockDiag_t");}
+
+            size_t nblocks()const{return blockend_.size();}
+            ///@brief first row/column of a diagonal block
+            size_t blockStart(const size_t iblk)const{return (iblk == 0)?0:blockend_.at(iblk-1);}
+            size_t blockSize(const size_t iblk)const{return blockend_.at(iblk)-blockStart(iblk);}
+            ///@brief cumulative end indices of the diagonal blocks
+            const std::vector<size_t> & blockind()const{return blockend_;}
+
+            eigm & block(const size_t iblk){return blocks_.at(iblk);}
+            const eigm & block(const size_t iblk)const{return blocks_.at(iblk);}
+
+            GArrayBase<T,2> &operator=(const T scalar)override{
+                for(auto & blk:blocks_){
+                    blk.setConstant(scalar);
+                }
+                return *this;
+            }
+
+        private:
+            std::vector<size_t> blockend_{};
+            std::vector<eigm> blocks_{};
+        };
+
+
+    }
+}
+#endif //FROMMLE_GARRAYBLOCKDIAG_HPP
@@ -20,6 +20,7 @@
 
 #include "core/GuidePacktemplated.hpp"
 #include "core/GArrayBase.hpp"
+#include "core/GArrayAllocator.hpp"
 
 
 #ifndef FROMMLE_GARRAYDENSE_HPP
@@ -77,7 +78,7 @@ namespace frommle {
         };
 
 
-        ///@brief holds a dense matrix
+        ///@brief holds a dense matrix (the storage is obtained from the default DenseAllocator, which aligns it at 64 bytes)
         template<class T, int n>
         class GArrayDense : public GArrayBase<T, n> {
         public:
@@ -99,28 +100,34 @@ namespace frommle {
             ///@brief the type traits remove this constructor when the input is not a guidepack
             template<class GP, typename std::enable_if<std::is_base_of<guides::GuidePackDyn<n>, GP>::value, int>::type = 0>
             GArrayDense(GP guidepack) : GABase(guidepack),
-                data_(std::shared_ptr<tvec>(new T[gpp()->num_elements()])),
+                data_(allocateDense<T>(gpp()->num_elements())),
                 ar_(data_.get(), gp_->extent()) {}
 
             template<class GP, typename std::enable_if<std::is_base_of<guides::GuidePackDyn<n>, GP>::value, int>::type = 0>
             GArrayDense(GP guidepack, std::string name) : GABase(guidepack,name),
-                    data_(std::shared_ptr<tvec>(new T[gpp()->num_elements()])),
+                    data_(allocateDense<T>(gpp()->num_elements())),
+                            ar_(data_.get(), gp_->extent()) {}
+
+            ///@brief construct around external storage (e.g. a memory mapped file) which holds at least num_elements() values
+            template<class GP, typename std::enable_if<std::is_base_of<guides::GuidePackDyn<n>, GP>::value, int>::type = 0>
+            GArrayDense(GP guidepack, std::string name, std::shared_ptr<tvec> data) : GABase(guidepack,name),
+                    data_(std::move(data)),
                             ar_(data_.get(), gp_->extent()) {}
 
 
             ///@brief Specialized constructor which casts a generic GuidePackPtr to an appropritate GuidePackDyn
             GArrayDense(const guides::GuidePackPtr &guidepack) : GABase(guidepack),
-                data_(std::shared_ptr<tvec>(new T[gpp()->num_elements()])),
+                data_(allocateDense<T>(gpp()->num_elements())),
                         ar_(data_.get(), gp_->extent()) {}
 
             ///@brief construct from shared guidepack (i.e. internal guidepack will be co-owned)
             GArrayDense(gp_ptr_t guidepackptr): GABase(guidepackptr),
-                data_(std::shared_ptr<tvec>(new T[gpp()->num_elements()])),
+                data_(allocateDense<T>(gpp()->num_elements())),
                         ar_(data_.get(), gp_->extent()) {}
 
             //note although empty, we always need to construct the multi_array_ref using a non-default constructor
             GArrayDense():GABase(),
-                data_(std::shared_ptr<tvec>(new T[gpp()->num_elements()])),
+                data_(allocateDense<T>(gpp()->num_elements())),
                         ar_(data_.get(), gp_->extent()){}
 
             inline arr &mat() { return ar_; }
@@ -193,7 +200,7 @@ namespace frommle {
             }
 
             void realloc() {
-                data_.reset(new T[gpp()->num_elements()]);
+                data_=allocateDense<T>(gpp()->num_elements());
                 //also make sure the internal multi_arrary_ref uses this newly allocated data
                 reassign();
             }
@@ -222,7 +229,7 @@ namespace frommle {
             //create a renewed multi_array_ref (ugly hack with placement new)
             using arrnew=typename GArrayDense<T, GP::ndim>::arr;
             gaout.ar_.~arrnew();
-            new(&(gaout.ar_)) arrnew(gaout.data_.data(), gaout.gpp()->extent());
+            new(&(gaout.ar_)) arrnew(gaout.data_.get(), gaout.gpp()->extent());
 
             return gaout;
 
@@ -284,6 +291,11 @@ namespace frommle {
 
     GAdense (GPack(std::move(guides)...)) {}
 
+    ///@brief access an entry by the elements of all guides (the index computation is resolved at compile time)
+    T &operator()(const typename Guides::Element & ... els) {
+        return ar_.data()[gp().offset(els...)];
+    }
+
     template<int nd = n, typename std::enable_if<nd == 1, int>::type = 0>
     T &operator[](const typename g_t<0>::Element &el) {
         return ar_[g<0>()->idx(el)];
@@ -0,0 +1,133 @@
+/*! \file
+ \brief Implementation of memory mapped files for the out of core storage of dense GArrays
+ \copyright Roelof Rietbroek 2021
+ \license
+ This file is part of Frommle.
+ frommle is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3 of the License, or (at your option) any later version.
+
+ Frommle is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with Frommle; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "core/GArrayMapped.hpp"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <cerrno>
+#include <fstream>
+
+namespace frommle{
+    namespace core{
+
+        MappedFile::MappedFile(const std::string &filename, const MapMode mode, const size_t nbytes):filename_(filename),mode_(mode) {
+            const int fd=open(filename.c_str(),(mode == MapMode::ReadWrite)?O_RDWR:O_RDONLY);
+            if (fd < 0){
+                THROWIOEXCEPTION("Cannot open "+filename+": "+std::strerror(errno));
+            }
+            struct stat st;
+            if (fstat(fd,&st) != 0){
+                close(fd);
+                THROWIOEXCEPTION("Cannot stat "+filename+": "+std::strerror(errno));
+            }
+            const size_t fsize=st.st_size;
+            if (nbytes > fsize){
+                close(fd);
+                THROWIOEXCEPTION("File "+filename+" is smaller than the requested mapping");
+            }
+            map(fd,(nbytes == 0)?fsize:nbytes);
+        }
+
+        MappedFile::MappedFile(const std::string &filename, const size_t nbytes):filename_(filename),mode_(MapMode::ReadWrite) {
+            const int fd=open(filename.c_str(),O_RDWR|O_CREAT|O_TRUNC,0644);
+            if (fd < 0){
+                THROWIOEXCEPTION("Cannot create "+filename+": "+std::strerror(errno));
+            }
+            //the file is created sparse, so no disk blocks are used until the pages are written
+            if (ftruncate(fd,nbytes) != 0){
+                close(fd);
+                THROWIOEXCEPTION("Cannot resize "+filename+": "+std::strerror(errno));
+            }
+            map(fd,nbytes);
+        }
+
+        void MappedFile::map(const int fd, const size_t nbytes) {
+            size_=nbytes;
+            if (size_ > 0){
+                //read only files are mapped privately and writable as well: shallow copies of a const array may still be written to, which then only dirties a private page
+                const int flags=(mode_ == MapMode::ReadWrite)?MAP_SHARED:MAP_PRIVATE;
+                data_=mmap(nullptr,size_,PROT_READ|PROT_WRITE,flags,fd,0);
+            }
+            //the mapping stays valid after closing the file descriptor
+            close(fd);
+            if (data_ == MAP_FAILED){
+                data_=nullptr;
+                THROWIOEXCEPTION("Cannot map "+filename_+": "+std::strerror(errno));
+            }
+        }
+
+        MappedFile::~MappedFile() {
+            if (data_){
+                munmap(data_,size_);
+            }
+        }
+
+        void * MappedFile::data() {
+            if (mode_ == MapMode::ReadOnly){
+                THROWIOEXCEPTION("Mapped file "+filename_+" is read only");
+            }
+            return data_;
+        }
+
+        void MappedFile::sync() {
+            if (data_ and mode_ == MapMode::ReadWrite){
+                if (msync(data_,size_,MS_SYNC) != 0){
+                    THROWIOEXCEPTION("Cannot synchronize "+filename_+": "+std::strerror(errno));
+                }
+            }
+        }
+
+        void MappedHeader::write(const std::string &datafile) const {
+            std::ofstream fid(sidecar(datafile));
+            if (!fid){
+                THROWIOEXCEPTION("Cannot write "+sidecar(datafile));
+            }
+            fid << "FROMMLEMAP " << elsize << " " << extents.size();
+            for(const auto ext:extents){
+                fid << " " << ext;
+            }
+            fid << "\n" << name << "\n";
+        }
+
+        MappedHeader MappedHeader::read(const std::string &datafile) {
+            std::ifstream fid(sidecar(datafile));
+            std::string magic;
+            size_t ndim=0;
+            MappedHeader hdr;
+            if (!(fid >> magic >> hdr.elsize >> ndim) or magic != "FROMMLEMAP"){
+                THROWIOEXCEPTION("Cannot read header "+sidecar(datafile));
+            }
+            hdr.extents.resize(ndim);
+            for(auto & ext:hdr.extents){
+                fid >> ext;
+            }
+            fid >> std::ws;
+            std::getline(fid,hdr.name);
+            if (!fid){
+                THROWIOEXCEPTION("Corrupt header "+sidecar(datafile));
+            }
+            return hdr;
+        }
+
+    }
+}
@@ -0,0 +1,151 @@
+/*! \file
+ \brief Memory mapped (out of core) storage for dense GArrays
+ \copyright Roelof Rietbroek 2021
+ \license
+ This file is part of Frommle.
+ frommle is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3 of the License, or (at your option) any later version.
+
+ Frommle is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with Frommle; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "core/GArrayDense.hpp"
+#include "core/Exceptions.hpp"
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifndef FROMMLE_GARRAYMAPPED_HPP
+#define FROMMLE_GARRAYMAPPED_HPP
+
+namespace frommle{
+    namespace core{
+
+        ///@brief access modes of memory mapped files
+        enum class MapMode{
+            ReadOnly, ///< the file is never modified and the data is only handed out as const (stray writes end up in private pages)
+            CopyOnWrite, ///< modifications are private to the process and are not written to the file
+            ReadWrite ///< modifications are written back to the file
+        };
+
+        /*!@brief Maps a raw binary file into memory
+         * The mapping is released upon destruction
+         */
+        class MappedFile{
+        public:
+            ///@brief map an existing file (nbytes=0 maps the complete file)
+            MappedFile(const std::string & filename, const MapMode mode, const size_t nbytes=0);
+            ///@brief create (or truncate) a file of nbytes and map it in read-write mode
+            MappedFile(const std::string & filename, const size_t nbytes);
+            ~MappedFile();
+            MappedFile(const MappedFile &)=delete;
+            MappedFile & operator=(const MappedFile &)=delete;
+
+            ///@brief writable access to the mapping (throws for read only mappings)
+            void * data();
+            const void * data()const{return data_;}
+            size_t size()const{return size_;}
+            MapMode mode()const{return mode_;}
+            const std::string & filename()const{return filename_;}
+            ///@brief flush modified pages to the file (no-op unless the file is mapped read-write)
+            void sync();
+        private:
+            void map(const int fd, const size_t nbytes);
+            std::string filename_{};
+            MapMode mode_=MapMode::ReadOnly;
+            void * data_=nullptr;
+            size_t size_=0;
+        };
+
+        using MappedFilePtr=std::shared_ptr<MappedFile>;
+
+        /*!@brief Small text sidecar (<file>.hdr) describing the raw data of a mapped array
+         * It holds the element size, the name of the array and the extents of the dimensions
+         */
+        struct MappedHeader{
+            size_t elsize=0;
+            std::string name{};
+            std::vector<size_t> extents{};
+            void write(const std::string & datafile)const;
+            static MappedHeader read(const std::string & datafile);
+            static std::string sidecar(const std::string & datafile){return datafile+".hdr";}
+        };
+
+        ///@brief returns storage for n elements which is backed by a mapped file (the mapping is kept alive by the returned pointer)
+        template<class T>
+        std::shared_ptr<T[]> mappedStorage(MappedFilePtr mfile, const size_t n){
+            if (mfile->size() < n*sizeof(T)){
+                THROWIOEXCEPTION("Mapped file "+mfile->filename()+" is too small for the requested array");
+            }
+            return std::shared_ptr<T[]>(static_cast<T*>(mfile->data()),[mfile](T* p){});
+        }
+
+        ///@brief check the sidecar of a mapped file against the requested type and guides
+        template<class T, int n>
+        MappedHeader readMappedHeader(const std::string & filename, const guides::GuidePackDyn<n> & gp){
+            auto hdr=MappedHeader::read(filename);
+            if (hdr.elsize != sizeof(T)){
+                THROWINPUTEXCEPTION("Element size of mapped file "+filename+" does not agree with requested type");
+            }
+            const auto ext=gp.extent();
+            if (hdr.extents.size() != n or !std::equal(hdr.extents.begin(),hdr.extents.end(),ext.begin())){
+                THROWINPUTEXCEPTION("Guides do not agree with the extents of mapped file "+filename);
+            }
+            return hdr;
+        }
+
+        ///@brief create a new file (and sidecar) and return a dense array which is mapped read-write onto it
+        template<class T, int n>
+        GArrayDense<T,n> createMappedDense(const std::string & filename, guides::GuidePackDyn<n> gp, std::string name="mapped"){
+            const size_t nel=gp.num_elements();
+            const auto ext=gp.extent();
+            MappedHeader hdr{sizeof(T),name,std::vector<size_t>(ext.begin(),ext.end())};
+            auto mfile=std::make_shared<MappedFile>(filename,nel*sizeof(T));
+            hdr.write(filename);
+            return GArrayDense<T,n>(std::move(gp),name,mappedStorage<T>(mfile,nel));
+        }
+
+        /*!@brief map an existing file onto a writable dense array
+         * The guides must agree with the extents in the sidecar, the content of the guides itself is not stored
+         * Read only mappings are rejected, use openMappedDenseConst for those
+         */
+        template<class T, int n>
+        GArrayDense<T,n> openMappedDense(const std::string & filename, guides::GuidePackDyn<n> gp, const MapMode mode=MapMode::CopyOnWrite){
+            if (mode == MapMode::ReadOnly){
+                THROWINPUTEXCEPTION("Read only mappings of "+filename+" can only be opened as const arrays");
+            }
+            auto hdr=readMappedHeader<T,n>(filename,gp);
+            const size_t nel=gp.num_elements();
+            auto mfile=std::make_shared<MappedFile>(filename,mode,nel*sizeof(T));
+            return GArrayDense<T,n>(std::move(gp),hdr.name,mappedStorage<T>(mfile,nel));
+        }
+
+        ///@brief map an existing file read only onto a dense array which is only accessible as const
+        template<class T, int n>
+        std::shared_ptr<const GArrayDense<T,n>> openMappedDenseConst(const std::string & filename, guides::GuidePackDyn<n> gp){
+            auto hdr=readMappedHeader<T,n>(filename,gp);
+            const size_t nel=gp.num_elements();
+            auto mfile=std::make_shared<MappedFile>(filename,MapMode::ReadOnly,nel*sizeof(T));
+            if (mfile->size() < nel*sizeof(T)){
+                THROWIOEXCEPTION("Mapped file "+filename+" is too small for the requested array");
+            }
+            //note: the array is only handed out as const, but copies share the storage, so the private pages stay writable
+            const MappedFile & cfile=*mfile;
+            std::shared_ptr<T[]> data(const_cast<T*>(static_cast<const T*>(cfile.data())),[mfile](T* p){});
+            return std::make_shared<const GArrayDense<T,n>>(std::move(gp),hdr.name,std::move(data));
+        }
+
+    }
+}
+
+#endif //FROMMLE_GARRAYMAPPED_HPP
@@ -0,0 +1,185 @@
+/*! \file
+ \brief Holds a sparse two dimensional array which is stored in compressed (row major) form
+ \copyright Roelof Rietbroek 2021
+ \license
+ This file is part of Frommle.
+ frommle is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3 of the License, or (at your option) any later version.
+
+ Frommle is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with Frommle; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "core/GArrayBase.hpp"
+#include "core/Exceptions.hpp"
+#include "io/Variable.hpp"
+#include <eigen3/Eigen/Sparse>
+#include <string>
+#include <vector>
+
+#ifndef FROMMLE_GARRAYSPARSE_HPP
+#define FROMMLE_GARRAYSPARSE_HPP
+namespace frommle{
+    namespace core{
+
+        /*!@brief contains a sparse array, where the entries are stored in an Eigen compressed row storage matrix
+         * Archives store the non-zero entries in COO form: the variables <name>_row, <name>_col and <name> share the dimension <name>_nnz
+         * An empty array is stored as a single explicit zero at (0,0), since a zero length dimension is unlimited in NetCDF (explicit zeros are dropped upon loading)
+         */
+        template<class T, int n=2>
+        class GArraySparse:public GArrayBase<T,n>{
+        public:
+            static_assert(n == 2,"Sparse GArrays are only supported for two dimensions");
+            using GAB=GArrayBase<T,n>;
+            using eigsp=Eigen::SparseMatrix<T,Eigen::RowMajor,ptrdiff_t>;
+            using triplet=Eigen::Triplet<T,ptrdiff_t>;
+            using GAB::gpp;
+            using GAB::gp;
+            using GAB::name;
+            using typename GAB::gp_ptr_t;
+
+            GArraySparse():GAB("sparse"){}
+
+            ///@brief constructs an empty sparse array (all zeros)
+            template<class GP, typename std::enable_if<std::is_base_of<guides::GuidePackDyn<n>, GP>::value, int> ::type = 0>
+            GArraySparse(GP guidepack):GAB(std::move(guidepack)){resize();}
+
+            template<class GP, typename std::enable_if<std::is_base_of<guides::GuidePackDyn<n>, GP>::value, int> ::type = 0>
+            GArraySparse(GP guidepack, std::string name):GAB(std::move(guidepack),name){resize();}
+
+            GArraySparse(gp_ptr_t guidepackptr):GAB(guidepackptr){resize();}
+
+            core::typehash hash()const override{return core::typehash("GArSparse_t");}
+
+            eigsp & eig(){return eig_;}
+            const eigsp & eig()const{return eig_;}
+
+            ///@brief number of stored (non-zero) entries
+            size_t nnz()const{return eig_.nonZeros();}
+
+            ///@brief replace the content with the entries from a list of triplets (duplicate entries are summed)
+            template<class Iter>
+            void setFromTriplets(Iter begin, Iter end){
+                resize();
+                eig_.setFromTriplets(begin,end);
+            }
+
+            ///@brief assigning zero clears the array, non-zero values are rejected as they would make the array dense
+            GArrayBase<T,n> &operator=(const T scalar)override{
+                if (scalar != T(0)){
+                    THROWINPUTEXCEPTION("Only zero can be assigned to the sparse array "+name());
+                }
+                eig_.setZero();
+                return *this;
+            }
+
+            void save(io::Group &ar) const override {
+                GAB::save(ar);
+                saveCOO(ar);
+            }
+
+            void load(io::Group &ar) override{
+                GAB::load(ar);
+                loadCOO(ar);
+            }
+
+            ///@brief write the non-zero entries in COO (triplet) form
+            void saveCOO(io::Group &ar)const;
+
+            ///@brief read the non-zero entries from their COO (triplet) form
+            void loadCOO(io::Group &ar);
+
+        private:
+            void resize(){
+                const auto & ext=gp().extent();
+                eig_.resize(ext[0],ext[1]);
+            }
+            eigsp eig_{};
+        };
+
+        template<class T, int n>
+        void GArraySparse<T,n>::saveCOO(io::Group &ar)const{
+            const size_t nz=nnz();
+            std::vector<size_t> rows;
+            std::vector<size_t> cols;
+            std::vector<T> vals;
+            rows.reserve(nz);
+            cols.reserve(nz);
+            vals.reserve(nz);
+            for(ptrdiff_t i=0;i<eig_.outerSize();++i){
+                for(typename eigsp::InnerIterator it(eig_,i);it;++it){
+                    rows.push_back(it.row());
+                    cols.push_back(it.col());
+                    vals.push_back(it.value());
+                }
+            }
+            if (rows.empty()){
+                rows.push_back(0);
+                cols.push_back(0);
+                vals.push_back(T(0));
+            }
+            const size_t nzstore=rows.size();
+
+            //all three variables share the same dimension
+            const std::vector<std::string> dims={name()+"_nnz"};
+            auto & rowvar=ar.template createVariable<size_t>(name()+"_row");
+            rowvar.attr().set("Dimensions",dims);
+            rowvar.setValue(HyperSlabConstRef<size_t>(boost::multi_array_ref<size_t,1>(rows.data(),boost::extents[nzstore])));
+
+            auto & colvar=ar.template createVariable<size_t>(name()+"_col");
+            colvar.attr().set("Dimensions",dims);
+            colvar.setValue(HyperSlabConstRef<size_t>(boost::multi_array_ref<size_t,1>(cols.data(),boost::extents[nzstore])));
+
+            auto & valvar=ar.template createVariable<T>(name());
+            valvar.attr().set("Dimensions",dims);
+            valvar.setValue(HyperSlabConstRef<T>(boost::multi_array_ref<T,1>(vals.data(),boost::extents[nzstore])));
+        }
+
+        template<class T, int n>
+        void GArraySparse<T,n>::loadCOO(io::Group &ar){
+            auto & rowvar=ar.template getVariable<size_t>(name()+"_row");
+            auto & colvar=ar.template getVariable<size_t>(name()+"_col");
+            auto & valvar=ar.template getVariable<T>(name());
+            const size_t nz=rowvar.shape().at(0);
+            std::vector<size_t> rows(nz);
+            std::vector<size_t> cols(nz);
+            std::vector<T> vals(nz);
+            if (nz > 0){
+                boost::multi_array_ref<size_t,1> rowref(rows.data(),boost::extents[nz]);
+                HyperSlabRef<size_t> rowslab(rowref);
+                rowvar.getValue(rowslab);
+                boost::multi_array_ref<size_t,1> colref(cols.data(),boost::extents[nz]);
+                HyperSlabRef<size_t> colslab(colref);
+                colvar.getValue(colslab);
+                boost::multi_array_ref<T,1> valref(vals.data(),boost::extents[nz]);
+                HyperSlabRef<T> valslab(valref);
+                valvar.getValue(valslab);
+            }
+
+            const auto ext=gp().extent();
+            std::vector<triplet> triplets;
+            triplets.reserve(nz);
+            for(size_t i=0;i<nz;++i){
+                if (vals[i] == T(0)){
+                    continue;
+                }
+                if (rows[i] >= ext[0] or cols[i] >= ext[1]){
+                    THROWINPUTEXCEPTION("Sparse entry ("+std::to_string(rows[i])+","+std::to_string(cols[i])+") of "+name()+" is outside of the guides");
+                }
+                triplets.emplace_back(rows[i],cols[i],vals[i]);
+            }
+            setFromTriplets(triplets.cbegin(),triplets.cend());
+        }
+
+
+    }
+}
+#endif //FROMMLE_GARRAYSPARSE_HPP
@@ -0,0 +1,129 @@
+/*! \file
+ \brief Linear operator which holds a block diagonal matrix
+ \copyright Roelof Rietbroek 2021
+ \license
+ This file is part of Frommle.
+ frommle is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3 of the License, or (at your option) any later version.
+
+ Frommle is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with Frommle; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "core/GOperatorBase.hpp"
+#include "core/GArrayBlockDiag.hpp"
+#include "core/Parallel.hpp"
+
+#ifndef FROMMLE_GOPERATORBLOCKDIAG_HPP
+#define FROMMLE_GOPERATORBLOCKDIAG_HPP
+
+namespace frommle{
+    namespace core{
+
+        /*!@brief Holds a block diagonal matrix to be used as linear operator
+         * The operator acts along the first dimension of the input, where each block is applied to all trailing columns with a single matrix product
+         * Blocks are processed concurrently
+         */
+        template<class T>
+        class GOperatorBlockDiag:public GOperatorDyn<T,1,1>{
+        public:
+            using GOp=GOperatorDyn<T,1,1>;
+            using GOp::gpo_;
+            using typename GOp::gpo_t;
+            using GOp::operator();
+            using garr=GArrayBlockDiag<T>;
+            using eigm=typename garr::eigm;
+            GOperatorBlockDiag(std::string name="blockdiagop"):GOp(name){}
+            GOperatorBlockDiag(guides::GuidePackDyn<1> gpo, std::vector<size_t> blockends, std::string name="blockdiagop"):GOp(std::move(gpo),name),blockdiag_(*gpo_,std::move(blockends)){}
+            GOperatorBlockDiag(garr blockdiag, std::string name="blockdiagop"):GOp(blockdiag.gp().strip(),name),blockdiag_(std::move(blockdiag)){}
+
+            core::typehash hash()const override {return core::typehash("GOpBlockDiag_t");}
+
+            void fwdOp(const GArrayBase<T,2> & gin, GArrayBase<T,2> & gout) override {
+
+                if (*(gout.gp()[0]) != *(gin.gp()[0])){
+                    THROWINPUTEXCEPTION("Input and output dimension size does not agree");
+                }
+
+                auto ginptr=gin.template as<const GArrayDense<T,2>*>();
+                auto goutptr=gout.template as<GArrayDense<T,2>*>();
+                apply(*ginptr,*goutptr);
+            }
+
+            ///@brief apply the blocks along the first dimension of a dense array of arbitrary rank (gin and gout may refer to the same data)
+            template<int n>
+            void apply(const GArrayDense<T,n> & gin, GArrayDense<T,n> & gout)const;
+
+            ///@brief apply the operator out of place and return a new array with the same guides as the input
+            template<int n>
+            GArrayDense<T,n> apply(const GArrayDense<T,n> & gin)const{
+                GArrayDense<T,n> gout(gin.gp());
+                apply(gin,gout);
+                return gout;
+            }
+
+            ///@brief set the number of threads used to process the blocks (values < 1 use all available cores)
+            void setNThreads(const int nthreads){nthreads_=nthreads;}
+            int nThreads()const{return nthreads_;}
+
+            garr & gblockdiag(){return blockdiag_;}
+            const garr & gblockdiag()const{return blockdiag_;}
+
+            size_t nblocks()const{return blockdiag_.nblocks();}
+            eigm & block(const size_t iblk){return blockdiag_.block(iblk);}
+            const eigm & block(const size_t iblk)const{return blockdiag_.block(iblk);}
+        protected:
+            garr blockdiag_{};
+            int nthreads_=0;
+        };
+
+        template<class T>
+        template<int n>
+        void GOperatorBlockDiag<T>::apply(const GArrayDense<T,n> & gin, GArrayDense<T,n> & gout)const{
+            using rowmat=Eigen::Matrix<T,Eigen::Dynamic,Eigen::Dynamic,Eigen::RowMajor>;
+            const auto & inar=gin.mat();
+            auto & outar=gout.mat();
+            const size_t nrow=inar.shape()[0];
+            if (blockdiag_.blockind().empty() or blockdiag_.blockind().back() != nrow){
+                THROWINPUTEXCEPTION("Block diagonal operator size does not agree with input");
+            }
+
+            if (!std::equal(inar.shape(),inar.shape()+n,outar.shape())){
+                THROWINPUTEXCEPTION("Input and output dimension size does not agree");
+            }
+
+            //the arrays are stored in row major order so the rows of a block and all trailing columns form a contiguous matrix
+            const size_t ncol=inar.num_elements()/nrow;
+            const T * din=inar.data();
+            T * dout=outar.data();
+            const bool inplace=(din == dout);
+
+            parallel_for(blockdiag_.nblocks(),[&](const int ithread, const size_t bstart, const size_t bend){
+                for(size_t iblk=bstart;iblk<bend;++iblk){
+                    const size_t st=blockdiag_.blockStart(iblk);
+                    const size_t sz=blockdiag_.blockSize(iblk);
+                    Eigen::Map<const rowmat> bin(din+st*ncol,sz,ncol);
+                    Eigen::Map<rowmat> bout(dout+st*ncol,sz,ncol);
+                    if (inplace){
+                        bout=blockdiag_.block(iblk)*bin;
+                    }else{
+                        bout.noalias()=blockdiag_.block(iblk)*bin;
+                    }
+                }
+            },nthreads_);
+        }
+
+
+    }
+
+}
+
+#endif //FROMMLE_GOPERATORBLOCKDIAG_HPP
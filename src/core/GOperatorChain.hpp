@@ -0,0 +1,172 @@
+/*! \file
+ \brief Lazy composition of operators which are applied in a single pass upon evaluation
+ \copyright Roelof Rietbroek 2021
+ \license
+ This file is part of Frommle.
+ frommle is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3 of the License, or (at your option) any later version.
+
+ Frommle is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with Frommle; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "core/GOperatorBase.hpp"
+#include "core/GOperatorDiag.hpp"
+#include <vector>
+#include <memory>
+
+#ifndef FROMMLE_GOPERATORCHAIN_HPP
+#define FROMMLE_GOPERATORCHAIN_HPP
+
+namespace frommle{
+    namespace core{
+
+        /*!@brief Records a chain of operators (in order of application) and applies them when evaluated
+         * Upon evaluation, adjacent diagonal operators (e.g. isotropic SH kernels) acting on the same guide are folded into a single diagonal,
+         * diagonal operators following another stage are applied in place, and the intermediate arrays are kept as scratch buffers for subsequent evaluations
+         * The folded diagonals are recomputed from the recorded operators upon every evaluation, so later modifications of those are taken into account
+         */
+        template<class T>
+        class GOperatorChain:public GOperatorDyn<T,1,1>{
+        public:
+            using GOp=GOperatorDyn<T,1,1>;
+            using GOpPtr=std::shared_ptr<GOp>;
+            using GOp::gpo_;
+            using GOp::operator();
+            GOperatorChain(std::string name="opchain"):GOp(name){}
+
+            core::typehash hash()const override {return core::typehash("GOpChain_t");}
+
+            ///@brief add an operator to the end of the chain
+            GOperatorChain & append(GOpPtr op){
+                if (!op or !op->gpp()){
+                    THROWINPUTEXCEPTION("Operators in a chain need to have their output guides set");
+                }
+                stages_.push_back(op);
+                gpo_=op->gpp();
+                fused_.clear();
+                folds_.clear();
+                scratch_.clear();
+                return *this;
+            }
+
+            ///@brief number of recorded operators
+            size_t nstages()const{return stages_.size();}
+
+            ///@brief number of operators which are applied after folding the diagonals
+            size_t nfused(){
+                compile();
+                return fused_.size();
+            }
+
+            ///@brief release the intermediate buffers (they are reallocated upon the next evaluation)
+            void clearScratch(){scratch_.assign(fused_.size(),nullptr);}
+
+            void fwdOp(const GArrayBase<T,2> & gin, GArrayBase<T,2> & gout) override {
+                if (stages_.empty()){
+                    THROWMETHODEXCEPTION("Cannot apply an empty operator chain");
+                }
+                compile();
+                refold();
+                const GArrayBase<T,2> * cur=&gin;
+                GArrayDense<T,2> * curbuf=nullptr;
+                const size_t nlast=fused_.size()-1;
+                for(size_t i=0;i<nlast;++i){
+                    auto diagop=std::dynamic_pointer_cast<GOperatorDiag<T>>(fused_[i]);
+                    if (diagop and curbuf){
+                        diagop->applyInPlace(*curbuf);
+                        continue;
+                    }
+                    curbuf=scratch(i,*fused_[i],gin);
+                    fused_[i]->fwdOp(*cur,*curbuf);
+                    cur=curbuf;
+                }
+                fused_[nlast]->fwdOp(*cur,gout);
+            }
+
+        private:
+            static bool sameGuide(const guides::GuideBasePtr & g1, const guides::GuideBasePtr & g2){
+                return g1->hash() == g2->hash() and g1->size() == g2->size();
+            }
+
+            ///@brief fold adjacent diagonal operators which act on the same guide
+            void compile(){
+                if (!fused_.empty()){
+                    return;
+                }
+                std::shared_ptr<GOperatorDiag<T>> lastdiag{};
+                for(auto & op:stages_){
+                    auto diagop=std::dynamic_pointer_cast<GOperatorDiag<T>>(op);
+                    if (diagop and lastdiag and sameGuide(diagop->gp()[0],lastdiag->gp()[0])){
+                        //replace the previous diagonal with a new one holding the product (note: the recorded operators are not modified)
+                        auto & folded=folds_.back();
+                        if (folded.empty()){
+                            folded.push_back(lastdiag);
+                            fused_.back()=std::make_shared<GOperatorDiag<T>>((*diagop)(*lastdiag));
+                        }
+                        folded.push_back(diagop);
+                        continue;
+                    }
+                    lastdiag=diagop;
+                    fused_.push_back(op);
+                    folds_.emplace_back();
+                }
+                scratch_.assign(fused_.size(),nullptr);
+            }
+
+            ///@brief recompute the folded diagonals from the current diagonals of the recorded operators (O(n))
+            void refold(){
+                for(size_t i=0;i<folds_.size();++i){
+                    const auto & folded=folds_[i];
+                    if (folded.empty()){
+                        continue;
+                    }
+                    auto prod=static_cast<GOperatorDiag<T>&>(*fused_[i]).eig().diagonal().array();
+                    for(size_t k=0;k<folded.size();++k){
+                        const auto diag=folded[k]->eig().diagonal().array();
+                        if (diag.size() != prod.size()){
+                            THROWINPUTEXCEPTION("The size of a diagonal operator in the chain has changed");
+                        }
+                        if (k == 0){
+                            prod=diag;
+                        }else{
+                            prod*=diag;
+                        }
+                    }
+                }
+            }
+
+            ///@brief retrieve (or allocate) the buffer holding the output of an intermediate stage
+            GArrayDense<T,2> * scratch(const size_t istage, const GOp & op, const GArrayBase<T,2> & gin){
+                auto & buf=scratch_[istage];
+                if (buf){
+                    const auto & bufgp=static_cast<const GArrayDense<T,2>&>(*buf).gp();
+                    if (sameGuide(bufgp[0],op.gp()[0]) and sameGuide(bufgp[1],gin.gp()[1])){
+                        return buf.get();
+                    }
+                }
+                buf=std::make_shared<GArrayDense<T,2>>(op.gp().append(gin.gp().gv(1)));
+                return buf.get();
+            }
+
+            std::vector<GOpPtr> stages_{};
+            std::vector<GOpPtr> fused_{};
+            ///@brief recorded diagonal operators which are folded into the corresponding fused stage (empty for stages which are not folded)
+            std::vector<std::vector<std::shared_ptr<GOperatorDiag<T>>>> folds_{};
+            std::vector<std::shared_ptr<GArrayDense<T,2>>> scratch_{};
+        };
+
+
+    }
+
+}
+
+#endif //FROMMLE_GOPERATORCHAIN_HPP
@@ -24,6 +24,7 @@
 
 #include "core/GOperatorBase.hpp"
 #include "core/GArrayDiag.hpp"
+#include "core/Parallel.hpp"
 
 #ifndef FROMMLE_DIAGGOPERATOR_HPP
 #define FROMMLE_DIAGGOPERATOR_HPP
@@ -44,7 +45,12 @@ namespace frommle{
             GOperatorDiag(std::string name="diagop"):GOp(name){}
             GOperatorDiag(guides::GuidePackDyn<1> gpo, std::string name="diagop"):GOp(std::move(gpo),name),diag_(*gpo_){}
 
-            GOperatorDiag( std::shared_ptr<guides::GuidePackDyn<1>> gpo, eigd diag,std::string name="diagop"):GOp(gpo,name),diag_(*gpo_){}
+            GOperatorDiag( std::shared_ptr<guides::GuidePackDyn<1>> gpo, eigd diag,std::string name="diagop"):GOp(gpo,name),diag_(*gpo_){
+                if (diag.diagonal().size() != diag_.eig().diagonal().size()){
+                    THROWINPUTEXCEPTION("Size of the diagonal does not agree with the guide");
+                }
+                diag_.eig()=std::move(diag);
+            }
             GOperatorDiag(garr diag ,std::string name="diagop"):GOp(diag.gp().strip(),name),diag_(diag){}
 
             core::typehash hash()const override {return core::typehash("GOpDiag_t");} 
@@ -74,11 +80,6 @@ namespace frommle{
 
             void fwdOp(const GArrayBase<T,2> & gin, GArrayBase<T,2> & gout) override {
 
-                    //some sanity checks
-                    if (diag_.eig().diagonal().size() != gin.gp()[0]->size()){
-                        THROWINPUTEXCEPTION("Stored diagonal size does not agree with input");
-                    }
-
                     if (*(gout.gp()[0]) != *(gin.gp()[0])){
                         THROWINPUTEXCEPTION("Input and output dimension size does not agree");
                     }
@@ -86,25 +87,28 @@ namespace frommle{
                     auto ginptr=gin.template as<const GArrayDense<T,2>*>();
 
                     auto goutptr=gout.template as<GArrayDense<T,2>*>();
-                    //let the eigen library do the math (multiple desne matrix with diagonal matrix)
-                    goutptr->eig()=diag_.eig()*ginptr->eig();
-                    
-                    //Eigen::DiagonalMatrix<double,-1> dia(3);
-                    //dia.diagonal()[0]=1;
-                    //dia.diagonal()[1]=2;
-                    //dia.diagonal()[2]=3;
-                    
-                    
-                    //Eigen::Matrix<double,Eigen::Dynamic,Eigen::Dynamic> mat(3,2);
-                    //mat.fill(1.0);
-
-                    //LOGINFO << dia.diagonal();
-                    //LOGINFO << mat ;
-                    //LOGINFO << dia*mat;
+                    apply(*ginptr,*goutptr);
             }
 
+            ///@brief apply the diagonal along the first dimension of a dense array of arbitrary rank (gin and gout may refer to the same data)
+            template<int n>
+            void apply(const GArrayDense<T,n> & gin, GArrayDense<T,n> & gout)const;
 
+            ///@brief scale a dense array along its first dimension in place
+            template<int n>
+            void applyInPlace(GArrayDense<T,n> & ginout)const{apply(ginout,ginout);}
 
+            ///@brief apply the diagonal out of place and return a new array with the same guides as the input
+            template<int n>
+            GArrayDense<T,n> apply(const GArrayDense<T,n> & gin)const{
+                GArrayDense<T,n> gout(gin.gp());
+                apply(gin,gout);
+                return gout;
+            }
+
+            ///@brief set the number of threads used in the application of the diagonal (values < 1 use all available cores)
+            void setNThreads(const int nthreads){nthreads_=nthreads;}
+            int nThreads()const{return nthreads_;}
 
             garr & gdiag(){return diag_;}
             const garr & gdiag()const{return diag_;}
@@ -144,6 +148,7 @@ namespace frommle{
             }
         protected:
             garr diag_{};
+            int nthreads_=0;
         private:
             void checkBothGuides(const GOperatorDiag & in)const{
                 if (!(gpo_ and in.gpo_)){
@@ -153,6 +158,46 @@ namespace frommle{
 
         };
 
+        template<class T>
+        template<int n>
+        void GOperatorDiag<T>::apply(const GArrayDense<T,n> & gin, GArrayDense<T,n> & gout)const{
+            const auto & inar=gin.mat();
+            auto & outar=gout.mat();
+            const size_t nrow=inar.shape()[0];
+            if (diag_.eig().diagonal().size() != nrow){
+                THROWINPUTEXCEPTION("Stored diagonal size does not agree with input");
+            }
+
+            if (!std::equal(inar.shape(),inar.shape()+n,outar.shape())){
+                THROWINPUTEXCEPTION("Input and output dimension size does not agree");
+            }
+
+            if (nrow == 0){
+                return;
+            }
+
+            //the arrays are stored in row major order, so each entry of the diagonal scales a contiguous row of the trailing dimensions
+            const size_t ncol=inar.num_elements()/nrow;
+            const T * din=inar.data();
+            T * dout=outar.data();
+            const T * dia=diag_.eig().diagonal().data();
+
+            //spread blocks of columns over the threads, but keep enough work per block to make threading worthwhile
+            const size_t minwork=32768;
+            const size_t nth=core::nThreads(nthreads_);
+            const size_t chunk=std::max((ncol+nth-1)/nth,(minwork+nrow-1)/nrow);
+
+            parallel_for(ncol,[&](const int ithread, const size_t cstart, const size_t cend){
+                for(size_t i=0;i<nrow;++i){
+                    const T d=dia[i];
+                    const T * rin=din+i*ncol;
+                    T * rout=dout+i*ncol;
+                    for(size_t j=cstart;j<cend;++j){
+                        rout[j]=d*rin[j];
+                    }
+                }
+            },nthreads_,chunk);
+        }
 
     }
 
@@ -0,0 +1,113 @@
+/*! \file
+ \brief Linear operator which holds a sparse matrix
+ \copyright Roelof Rietbroek 2021
+ \license
+ This file is part of Frommle.
+ frommle is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3 of the License, or (at your option) any later version.
+
+ Frommle is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with Frommle; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "core/GOperatorBase.hpp"
+#include "core/GArraySparse.hpp"
+#include "core/Parallel.hpp"
+#include <numeric>
+
+#ifndef FROMMLE_GOPERATORSPARSE_HPP
+#define FROMMLE_GOPERATORSPARSE_HPP
+
+namespace frommle{
+    namespace core{
+
+        /*!@brief Holds a sparse matrix (e.g. masks, interpolation weights or selections) to be used as linear operator
+         * The operator maps the first dimension of dense input arrays with sparse x dense products, where blocks of output rows are processed concurrently
+         */
+        template<class T>
+        class GOperatorSparse:public GOperatorDyn<T,1,1>{
+        public:
+            using GOp=GOperatorDyn<T,1,1>;
+            using GOp::gpo_;
+            using typename GOp::gpo_t;
+            using GOp::operator();
+            using garr=GArraySparse<T,2>;
+            using eigsp=typename garr::eigsp;
+            GOperatorSparse(std::string name="sparseop"):GOp(name){}
+            ///@brief construct an empty operator which maps from the second to the first guide of the guidepack
+            GOperatorSparse(guides::GuidePackDyn<2> gp, std::string name="sparseop"):GOp(gp.strip(),name),sparse_(std::move(gp)){}
+            GOperatorSparse(garr sparse, std::string name="sparseop"):GOp(sparse.gp().strip(),name),sparse_(std::move(sparse)){}
+
+            core::typehash hash()const override {return core::typehash("GOpSparse_t");}
+
+            void fwdOp(const GArrayBase<T,2> & gin, GArrayBase<T,2> & gout) override {
+                auto ginptr=gin.template as<const GArrayDense<T,2>*>();
+                auto goutptr=gout.template as<GArrayDense<T,2>*>();
+                apply(*ginptr,*goutptr);
+            }
+
+            ///@brief apply the operator along the first dimension of dense arrays of arbitrary rank (trailing dimensions must agree)
+            template<int n>
+            void apply(const GArrayDense<T,n> & gin, GArrayDense<T,n> & gout)const;
+
+            ///@brief set the number of threads (values < 1 use all available cores)
+            void setNThreads(const int nthreads){nthreads_=nthreads;}
+            int nThreads()const{return nthreads_;}
+
+            garr & gsparse(){return sparse_;}
+            const garr & gsparse()const{return sparse_;}
+            eigsp & eig(){return sparse_.eig();}
+            const eigsp & eig()const{return sparse_.eig();}
+        protected:
+            garr sparse_{};
+            int nthreads_=0;
+        };
+
+        template<class T>
+        template<int n>
+        void GOperatorSparse<T>::apply(const GArrayDense<T,n> & gin, GArrayDense<T,n> & gout)const{
+            using rowmat=Eigen::Matrix<T,Eigen::Dynamic,Eigen::Dynamic,Eigen::RowMajor>;
+            const auto & inar=gin.mat();
+            auto & outar=gout.mat();
+            const auto & sp=sparse_.eig();
+            if (inar.shape()[0] != sp.cols() or outar.shape()[0] != sp.rows()){
+                THROWINPUTEXCEPTION("Sparse operator size does not agree with input or output");
+            }
+
+            if (!std::equal(inar.shape()+1,inar.shape()+n,outar.shape()+1)){
+                THROWINPUTEXCEPTION("Trailing dimensions of the input and output do not agree");
+            }
+
+            if (inar.data() == outar.data()){
+                THROWINPUTEXCEPTION("Sparse operator cannot be applied in place");
+            }
+
+            //the arrays are stored in row major order so the trailing dimensions form the columns of a contiguous matrix
+            const size_t nrowin=inar.shape()[0];
+            const size_t nrowout=outar.shape()[0];
+            const size_t ncol=std::accumulate(inar.shape()+1,inar.shape()+n,size_t(1),std::multiplies<size_t>());
+            Eigen::Map<const rowmat> bin(inar.data(),nrowin,ncol);
+            Eigen::Map<rowmat> bout(outar.data(),nrowout,ncol);
+
+            //distribute contiguous blocks of output rows over the threads
+            const size_t nth=core::nThreads(nthreads_);
+            const size_t chunk=std::max<size_t>((nrowout+4*nth-1)/(4*nth),16);
+            parallel_for(nrowout,[&](const int ithread, const size_t rstart, const size_t rend){
+                bout.middleRows(rstart,rend-rstart).noalias()=sp.middleRows(rstart,rend-rstart)*bin;
+            },nthreads_,chunk);
+        }
+
+
+    }
+
+}
+
+#endif //FROMMLE_GOPERATORSPARSE_HPP
@@ -26,6 +26,7 @@
 //#include <boost/iterator/iterator_adaptor.hpp>
 #include <memory>
 #include <cmath>
+#include <atomic>
 #include "core/Logging.hpp"
 #include "core/frommle.hpp"
 namespace frommle {
@@ -53,9 +54,19 @@ class GuideBase:public core::Frommle {
     public:
         using typehash=core::typehash;
         GuideBase(std::string name="GuideBase"):Frommle(name){}
+        GuideBase(const GuideBase & in):Frommle(in){}
+        ///@brief assigning another guide counts as a modification
+        GuideBase & operator=(const GuideBase & in){
+            Frommle::operator=(in);
+            touch();
+            return *this;
+        }
         
         virtual ~GuideBase() {
         }
+
+        ///@brief modification stamp of the guide, which changes whenever its size may have changed (used to validate cached layouts of guidepacks)
+        size_t version()const{return version_.load(std::memory_order_acquire);}
         using Element=ptrdiff_t;
         using const_iterator=const size_t*;
         size_t dummyit=0;
@@ -121,10 +132,14 @@ class GuideBase:public core::Frommle {
             //}
         //}
     protected:
+        ///@brief derived guides must call this upon modifications which (may) change the size
+        void touch(){version_.fetch_add(1,std::memory_order_acq_rel);}
 //        using core::Frommle::type_;
 //        size_t size_ = 0;
 //        std::string name_="Guide";
         //std::vector<Element> descripcache_{}; 
+    private:
+        std::atomic<size_t> version_{0};
     };
 
 
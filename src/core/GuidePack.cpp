@@ -44,6 +44,21 @@ namespace frommle{
 				gpar_=in.gpar_;
 			}
 
+		template<int n>
+			GuidePackDyn<n> & GuidePackDyn<n>::operator=(const GuidePackDyn<n> & in){
+				gpar_=in.gpar_;
+				invalidate();
+				return *this;
+			}
+
+		template<int n>
+			void GuidePackDyn<n>::invalidate(){
+				std::lock_guard<std::mutex> lock(laymut_);
+				if(layseq_.load(std::memory_order_relaxed)%2 == 0){
+					layseq_.fetch_add(1,std::memory_order_acq_rel);
+				}
+			}
+
 
 		template<int n>
 			GuideBasePtr GuidePackDyn<n>::operator[](const int i){
@@ -62,7 +77,11 @@ namespace frommle{
 
 		//direct access to the underlying boost variants
 		template<int n>
-			GuideRegistry::Gvar & GuidePackDyn<n>::gv(const int i){return gpar_[i];}
+			GuideRegistry::Gvar & GuidePackDyn<n>::gv(const int i){
+				//the variant may be replaced by the caller
+				invalidate();
+				return gpar_[i];
+			}
 		template<int n>
 			const GuideRegistry::Gvar & GuidePackDyn<n>::gv(const int i)const {return gpar_[i];}
 
@@ -81,32 +100,81 @@ namespace frommle{
 
 		template<int n>
 			void GuidePackDyn<n>::load(io::Group &ar){
+				invalidate();
 				for(auto & gd:gpar_){
 					boost::apply_visitor(guides::gvar_load(&ar),gd);
 				}
 			}
 
+		template<int n>
+			const typename GuidePackDyn<n>::Layout & GuidePackDyn<n>::layout()const{
+				//lock free validation: the layout is valid when the sequence is even, unchanged and all guide stamps agree
+				const size_t seq=layseq_.load(std::memory_order_acquire);
+				if(seq%2 == 0){
+					bool valid=true;
+					for(int i=0;valid and i<n;++i){
+						valid=layguides_[i].load(std::memory_order_relaxed)->version() == layversions_[i].load(std::memory_order_relaxed);
+					}
+					std::atomic_thread_fence(std::memory_order_acquire);
+					if(valid and layseq_.load(std::memory_order_relaxed) == seq){
+						return lay_;
+					}
+				}
+				return rebuildLayout();
+			}
+
+		template<int n>
+			const typename GuidePackDyn<n>::Layout & GuidePackDyn<n>::rebuildLayout()const{
+				std::lock_guard<std::mutex> lock(laymut_);
+				size_t seq=layseq_.load(std::memory_order_relaxed);
+				if(seq%2 == 0){
+					//another thread may have rebuilt the layout already
+					bool valid=true;
+					for(int i=0;valid and i<n;++i){
+						valid=layguides_[i].load(std::memory_order_relaxed)->version() == layversions_[i].load(std::memory_order_relaxed);
+					}
+					if(valid){
+						return lay_;
+					}
+					seq=layseq_.fetch_add(1,std::memory_order_acq_rel)+1;
+				}
+				std::atomic_thread_fence(std::memory_order_release);
+
+				//note: the stamp is read before the size, so a concurrent modification triggers another rebuild
+				for(int i=0;i<n;++i){
+					layhold_[i]=boost::apply_visitor(gvar_baseptr(),gpar_[i]);
+					layguides_[i].store(layhold_[i].get(),std::memory_order_relaxed);
+					layversions_[i].store(layhold_[i]->version(),std::memory_order_relaxed);
+					lay_.extent[i]=layhold_[i]->size();
+				}
+				size_t str=1;
+				for(int i=n-1;i>=0;--i){
+					lay_.strides[i]=str;
+					str*=lay_.extent[i];
+				}
+				lay_.nelem=str;
+				layseq_.store(seq+1,std::memory_order_release);
+				return lay_;
+			}
+
 		template<int n>
 			size_t GuidePackDyn<n>::num_elements() const {
-				//extract the elements from the guides
 				//quick return when dimension is 0
 				if(n ==0){
 					return 0;
 				}
+				return layout().nelem;
+			}
 
-				auto ext=extent();
-				return std::accumulate(ext.cbegin(),ext.cend(),1,std::multiplies<size_t>());
+		template<int n>
+			const std::array<size_t,n> & GuidePackDyn<n>::extent()const{
+				return layout().extent;
 			}
 
 		template<int n>
-			std::array<size_t,n> GuidePackDyn<n>::extent()const{
-				std::array<size_t,n> ext;
-				std::transform(gpar_.cbegin(),gpar_.cend(),ext.begin(),[](const Gvar & gb){
-						return boost::apply_visitor(gvar_size(),gb);
-						//                return gb->size();
-						});
-				return ext;
-			};
+			const std::array<size_t,n> & GuidePackDyn<n>::strides()const{
+				return layout().strides;
+			}
 
 
 
@@ -19,6 +19,9 @@
   */
 
 #include "core/GuideAppender.hpp"
+#include <numeric>
+#include <atomic>
+#include <mutex>
 
 #ifndef CORE_GUIDEPACK_HPP_
 #define CORE_GUIDEPACK_HPP_
@@ -82,6 +85,7 @@ namespace frommle{
 
 
                     GuidePackDyn(const GuidePackDyn & in);
+                    GuidePackDyn & operator=(const GuidePackDyn & in);
 
 
                     //using Gvar=GuideRegistry::Gvar;
@@ -120,7 +124,7 @@ namespace frommle{
                     const GuideBasePtr at(const int i)const;
 
 
-                    //direct access to the underlying boost variants
+                    //direct access to the underlying boost variants (non-const access invalidates the cached layout)
                     Gvar & gv(const int i)override;
                     const Gvar & gv(const int i)const override;
 
@@ -137,9 +141,29 @@ namespace frommle{
                     template<class T>
                         std::shared_ptr<T> dyn_as(const int i);
 
+                    ///@brief extents and row-major strides of the pack at the moment of the call
+                    struct Layout{
+                        std::array<size_t,n> extent{};
+                        std::array<size_t,n> strides{};
+                        size_t nelem=0;
+                        ///@brief linear (row-major) offset of a multi-dimensional index
+                        size_t offset(const std::array<size_t,n> & index)const{
+                            return std::inner_product(index.cbegin(),index.cend(),strides.cbegin(),size_t(0));
+                        }
+                    };
+
+                    /*!@brief layout of the pack, which is cached together with the modification stamps of the guides
+                     * The guides may be shared (and resized or masked) through other packs, so the cache is validated against their (atomic) stamps on each call.
+                     * Validation is lock free (a sequence lock), only a rebuild of the layout takes a mutex.
+                     * The reference stays valid until the guides are modified, hot loops can also keep it and use Layout::offset directly.
+                     */
+                    const Layout & layout()const;
                     size_t num_elements()const override;
-                    std::array<size_t,n> extent()const;
-
+                    const std::array<size_t,n> & extent()const;
+                    ///@brief row-major strides (in elements) corresponding to the extents
+                    const std::array<size_t,n> & strides()const;
+                    ///@brief linear (row-major) offset of a multi-dimensional index
+                    size_t offset(const std::array<size_t,n> & index)const;
 
                     const_iterator begin()const override;
                     const_iterator end()const override;
@@ -148,6 +172,18 @@ namespace frommle{
                     void load(io::Group &ar);
                 protected:
                     std::array<Gvar,n> gpar_{};
+                    void invalidate();
+                private:
+                    const Layout & rebuildLayout()const;
+                    ///@brief serializes rebuilds and invalidations of the cached layout (validation does not lock)
+                    mutable std::mutex laymut_{};
+                    ///@brief sequence number of the cached layout, which is odd while it is invalid or being rebuilt
+                    mutable std::atomic<size_t> layseq_{1};
+                    mutable Layout lay_{};
+                    ///@brief guides (and their stamps) from which the layout was derived (the shared pointers keep them alive)
+                    mutable std::array<std::atomic<const GuideBase*>,n> layguides_{};
+                    mutable std::array<std::atomic<size_t>,n> layversions_{};
+                    mutable std::array<GuideBasePtr,n> layhold_{};
 
             };
 
@@ -176,6 +212,7 @@ namespace frommle{
             template<class GP, typename std::enable_if< std::is_base_of<GuidePackDyn<n>,GP>::value_type,int>::type >
             GuidePackDyn<n>::GuidePackDyn(GP && gpin):GauxVirtImpl<n>(this){
                 gpar_=std::move(gpin.gpar_);
+                static_cast<GuidePackDyn<n>&>(gpin).invalidate();
             }
 
         template<int n>
@@ -226,7 +263,9 @@ namespace frommle{
 
 		template<int n>
 			template<class T>
-			std::shared_ptr<T> GuidePackDyn<n>::as(const int i){return std::static_pointer_cast<T>(boost::apply_visitor(gvar_baseptr(),gpar_[i]));}
+			std::shared_ptr<T> GuidePackDyn<n>::as(const int i){
+				return std::static_pointer_cast<T>(boost::apply_visitor(gvar_baseptr(),gpar_[i]));
+			}
 
 		template<int n>
 			template<class T>
@@ -234,7 +273,14 @@ namespace frommle{
 
 		template<int n>
 			template<class T>
-			std::shared_ptr<T> GuidePackDyn<n>::dyn_as(const int i){return std::dynamic_pointer_cast<T>(boost::apply_visitor(gvar_baseptr(),gpar_[i]));}
+			std::shared_ptr<T> GuidePackDyn<n>::dyn_as(const int i){
+				return std::dynamic_pointer_cast<T>(boost::apply_visitor(gvar_baseptr(),gpar_[i]));
+			}
+
+		template<int n>
+			size_t GuidePackDyn<n>::offset(const std::array<size_t,n> & index)const{
+				return layout().offset(index);
+			}
 
 		template<int n>
 			template<int nadd>
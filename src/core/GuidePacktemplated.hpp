@@ -18,6 +18,10 @@
  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
  */
 #include "core/GuidePack.hpp"
+#include "core/Exceptions.hpp"
+#include <tuple>
+#include <utility>
+#include <algorithm>
 
 #ifndef SRC_CORE_GUIDEPACKTEMPLATED_HPP_
 #define SRC_CORE_GUIDEPACKTEMPLATED_HPP_
@@ -26,6 +30,8 @@ namespace frommle{
 
 /*!brief
  * Wraps several guides into a tuple and provide access functions
+ * The typed guide pointers are kept in a std::tuple (sharing the guides with the dynamic pack), so that index computations are resolved at compile time
+ * A GuidePack is a GuidePackDyn, so it can be passed as is to functions which accept dynamic packs
  * @tparam Guides: a variadic list of guides which spans the dimensions
  */
         template< class ... Guides >
@@ -35,10 +41,14 @@ namespace frommle{
             using GPdyn::ndim;
             using GPdyn::gpar_;
             using GPdyn::extent;
+            using GPdyn::strides;
             using GPdyn::num_elements;
+            using GPdyn::offset;
+            using typename GPdyn::Gvar;
 
             ///@brief alias to store the types of the input
             using guides_t=std::tuple<Guides...>;
+            using gptrs_t=std::tuple<std::shared_ptr<Guides>...>;
 
             ///@brief this allows the compile time extraction of the Guide type
             template<int n>
@@ -49,13 +59,20 @@ namespace frommle{
 
             GuidePack(){}
             explicit GuidePack(Guides && ... Args):GPdyn(std::move(Args)...){
-                //extent_={Args.size()...};
-//                guides_ = std::make_tuple(std::forward<(std::make_shared<Guides>(std::forward<Guides>(Args)...)...);
-                //guides_ = std::make_tuple(std::make_shared<Guides>(std::move(Args))...);
+                sync();
+            }
+
+            explicit GuidePack(const Guides & ... Args):GPdyn(Args...){sync();}
 
+            ///@brief construct from a dynamic pack (the guides are shared and their types are checked)
+            explicit GuidePack(const GPdyn & gpdyn):GPdyn(gpdyn){
+                sync();
+                checkTyped(std::index_sequence_for<Guides...>{});
             }
 
-            explicit GuidePack(const Guides & ... Args):GPdyn(Args...){}
+            ///@brief cheap conversion to the dynamic pack (e.g. at API boundaries)
+            const GPdyn & dyn()const{return *this;}
+            std::shared_ptr<GPdyn> dynptr()const{return std::make_shared<GPdyn>(*this);}
 
             /*!brief
              * Get the nth guide of the array
@@ -64,23 +81,84 @@ namespace frommle{
              */
             template<int n>
             gptr_t<n>  g() {
-                assert(n<=ndim);
-                return boost::get<gptr_t<n>>(gpar_[n]);
-//                return std::static_pointer_cast<g_t<n>>(gpar_[n]);
+                static_assert(n < ndim,"guide index out of range");
+                if (stale_){
+                    sync();
+                }
+                return std::get<n>(gptrs_);
             }
 //
             template<int n>
             const gptr_t<n> g()const{
-                assert(n<=ndim);
-                return boost::get<gptr_t<n>>(gpar_[n]);
+                static_assert(n < ndim,"guide index out of range");
+                if (stale_){
+                    return std::dynamic_pointer_cast<g_t<n>>(boost::apply_visitor(gvar_baseptr(),gpar_[n]));
+                }
+                return std::get<n>(gptrs_);
             }
 
             template<int i>
             size_t idx(const typename g_t<i>::Element & el)const{
-                return  g<i>()->idx(el);
+                return  typed<i>()->idx(el);
             }
 
+            ///@brief linear (row-major) offset of a set of guide elements, resolved without visiting the variants
+            size_t offset(const typename Guides::Element & ... els)const{
+                return offsetImpl(std::index_sequence_for<Guides...>{},els...);
+            }
+
+            ///@brief non-const access to the variants may replace guides, so the typed pointers are resynchronized upon the next non-const g()
+            Gvar & gv(const int i)override{
+                stale_=true;
+                return GPdyn::gv(i);
+            }
+            using GPdyn::gv;
+
         private:
+            /*!@brief typed pointer to the guide of dimension I
+             * Const access never modifies the pack, so it can be read from several threads.
+             * Until the pack is resynchronized after replacing guides through gv(), the pointer is resolved from the variant
+             */
+            template<size_t I>
+            const g_t<I> * typed()const{
+                if (stale_){
+                    return dynamic_cast<const g_t<I>*>(boost::apply_visitor(gvar_baseptr(),gpar_[I]).get());
+                }
+                return std::get<I>(gptrs_).get();
+            }
+
+            void sync(){
+                syncImpl(std::index_sequence_for<Guides...>{});
+                stale_=false;
+            }
+
+            template<size_t ... I>
+            void syncImpl(std::index_sequence<I...>){
+                gptrs_=gptrs_t(std::dynamic_pointer_cast<Guides>(boost::apply_visitor(gvar_baseptr(),gpar_[I]))...);
+            }
+
+            template<size_t ... I>
+            void checkTyped(std::index_sequence<I...>)const{
+                const bool valid[]={true,(std::get<I>(gptrs_) != nullptr)...};
+                if (!std::all_of(std::begin(valid),std::end(valid),[](const bool v){return v;})){
+                    THROWINPUTEXCEPTION("Guides of the dynamic guidepack do not agree with the requested types");
+                }
+            }
+
+            template<size_t ... I>
+            size_t offsetImpl(std::index_sequence<I...>, const typename Guides::Element & ... els)const{
+                //row-major offset, the extents are taken from the typed guides rather than from the variants
+                const size_t ext[]={typed<I>()->size()...};
+                const size_t idx[]={typed<I>()->idx(els)...};
+                size_t off=0;
+                for(int i=0;i<ndim;++i){
+                    off=off*ext[i]+idx[i];
+                }
+                return off;
+            }
+
+            gptrs_t gptrs_{};
+            bool stale_=true;
         };
     }
 
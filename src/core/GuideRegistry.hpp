@@ -24,6 +24,7 @@
 #include "sh/SHGuide.hpp"
 #include "geometry/OGRGuide.hpp"
 #include "geometry/Vec3DGuide.hpp"
+#include "geometry/GeoGrid.hpp"
 
 #ifndef FROMMLE_GUIDEREGISTRY_HPP
 #define FROMMLE_GUIDEREGISTRY_HPP
@@ -38,7 +39,7 @@ namespace frommle{
         };
 
 
-        using GuideRegistry=GuideTlist<GuideBase,DateGuide,PTimeGuide,SHnmtGuide,SHtmnGuide,SHnmGuide,SHGuide,Vec3DGuide,OGRPointGuide,OGRPolyGuide>;
+        using GuideRegistry=GuideTlist<GuideBase,DateGuide,PTimeGuide,SHnmtGuide,SHtmnGuide,SHnmGuide,SHGuide,Vec3DGuide,OGRPointGuide,OGRPolyGuide,GeoGrid>;
 
 
      //some useful visitors to be applied to the boost variant of the registered guides
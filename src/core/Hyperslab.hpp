@@ -261,6 +261,8 @@ namespace frommle{
 
             HyperSlabRef(const slice & slc, T* data=nullptr):HyperSlabBase<T>(slc),data_(data){}
             HyperSlabRef(const std::vector<slice> & slcvec,T* data=nullptr):HyperSlabBase<T>(slcvec),data_(data){}
+            ///@brief reference the data of an owning hyperslab (which must outlive this reference)
+            HyperSlabRef(HyperSlab<T> & hslab):HyperSlabBase<T>(hslab),data_(hslab.data()){}
 
             const T* data()const override{return data_;}
             T* data()override{return data_;}
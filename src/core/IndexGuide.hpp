@@ -45,6 +45,7 @@ namespace frommle{
             size_t idx(const Element & el)const {return el;}
             void append(){
                 ++size_;
+                touch();
             }
 
             core::typehash hash()const override {return core::typehash("IndexGuide_t").add(0).add(size_);}
@@ -52,6 +53,7 @@ namespace frommle{
                 auto gvar=Ar.getVariable(name());
                 auto spl=gvar->hash().split();
                 size_=std::stoi(spl[0]);
+                touch();
 
             }
 
@@ -19,6 +19,7 @@
  */
 
 #include "core/GuideBase.hpp"
+#include "core/Exceptions.hpp"
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index/random_access_index.hpp>
@@ -70,13 +71,30 @@ namespace frommle{
             return mindx_[i].el; 
         }
 
+        ///@brief index of an element in the (possibly masked) guide
+        size_t idx(const ELEM & el)const{
+            const auto & elidx=bmi::get<byel>(mindx_);
+            auto it=elidx.find(el);
+            if (it == elidx.end() or it->i < 0){
+                THROWINDEXCEPTION("Element is masked or not present in the guide");
+            }
+            if (nmask_ == 0){
+                return it->i;
+            }
+            //masked entries are not renumbered, so count the unmasked entries in front
+            const auto & iidx=bmi::get<byi>(mindx_);
+            return std::distance(iidx.lower_bound(0),iidx.find(it->i));
+        }
+
         template<class ... Args>
         void emplace_back(Args && ... args){
             mindx_.emplace_back(ELEM(std::forward<Args>(args)...),size());
+            touch();
         }
         
         void push_back(ELEM el){
             mindx_.push_back(indx_t(el,size()));
+            touch();
         }
        
         void reserve(size_t sz){mindx_.reserve(sz);}        
@@ -170,7 +188,9 @@ namespace frommle{
             return bmi::get<bymem>(mindx_);
         }
         
+        ///@brief non-const access to the index may be used to modify the guide
         memindx_t & memindx(){
+            touch();
             return bmi::get<bymem>(mindx_);
         }
 
@@ -179,6 +199,7 @@ namespace frommle{
         }
 
         iindx_t & iindx(){
+            touch();
             return bmi::get<byi>(mindx_);
         }
 
@@ -187,6 +208,7 @@ namespace frommle{
         }
 
         elindx_t & elindx(){
+            touch();
             return bmi::get<byel>(mindx_);
         }
 
@@ -202,6 +224,7 @@ namespace frommle{
                         ++nmask_;
                 }
             }
+            touch();
         
         }            
 
@@ -220,6 +243,7 @@ namespace frommle{
                         --nmask_;
                     }
              }
+             touch();
 
        }
         private:
@@ -19,6 +19,10 @@
  */
 
 #include "core/GuideBase.hpp"
+#include <memory>
+#include <vector>
+#include <limits>
+#include <atomic>
 
 #ifndef SRC_CORE_NONINDEXEDGUIDE_HPP_
 #define SRC_CORE_NONINDEXEDGUIDE_HPP_
@@ -35,6 +39,12 @@ namespace frommle{
 
     template<class ELEM>
         class NonIndexedGuide:public GuideBase{
+        ///@brief forward (masked index -> full index) and inverse (full index -> masked index) lookup tables
+        struct MaskTables{
+            std::vector<size_t> fwd{};
+            std::vector<size_t> inv{};
+        };
+        static const size_t masked=std::numeric_limits<size_t>::max();
         public:
         using Element=ELEM;
         NonIndexedGuide()=default;        
@@ -46,7 +56,12 @@ namespace frommle{
         virtual Element elfromi(size_t i)const=0;
         virtual size_t  ifromel(const ELEM & elem)const=0;
         
-        size_t size()const override{ return fullsize()-nmask_;}
+        size_t size()const override{
+            if (maskf_){
+                return maskTables()->fwd.size();
+            }
+            return fullsize();
+        }
        
         //cnvert this non-indexed guide to a indexed variant
         IndexedGuide<ELEM> getIndexed();     
@@ -67,31 +82,25 @@ namespace frommle{
                 THROWINDEXCEPTION("out of range");
             }
             
-            if (nmask_ == 0){
+            if (!maskf_){
                 return elfromi(i);
             }
-            size_t ith=0; 
-            //we need to find the corresponding unmasked element 
-            for(size_t ii=0;ii< fullsize();++ii){
-                auto el=elfromi(ii);
-                if (isMasked(el)){
-                    continue;
-                }else{
-                    if(ith == i){
-                        //found it!
-                        return el;
-                    }else{
-                        //we hit an unmasked value but need to search further
-                        ++ith;
-                        continue;
-                    }
+            return elfromi(maskTables()->fwd[i]);
+        }
 
-                }
-            
+        ///@brief index of an element in the (possibly masked) guide
+        size_t idx(const Element & el)const{
+            size_t ifull=ifromel(el);
+            if (!maskf_){
+                return ifull;
             }
-           //if we arrive here we didn't find a umasked value with the index 
-                THROWINDEXCEPTION("masked value out of range");
+            auto tables=maskTables();
+            if (ifull >= tables->inv.size() or tables->inv[ifull] == masked){
+                THROWINDEXCEPTION("Element is masked or out of range");
+            }
+            return tables->inv[ifull];
         }
+
         class const_iterator{
         public:
             //iterator traits
@@ -107,69 +116,33 @@ namespace frommle{
 
             const_iterator & operator = (const const_iterator & itin){
                 idx_=itin.idx_;
-                fullidx_=itin.fullidx_;
                 sz_=itin.sz_;
                 gd_ptr=itin.gd_ptr;
+                tables_=itin.tables_;
                 ElementCache_=itin.ElementCache_;
+                return *this;
             }
-            const_iterator(const const_iterator & in):idx_(in.idx_),fullidx_(in.fullidx_),sz_(in.sz_),fullsz_(in.fullsz_),nmask_(in.nmask_),gd_ptr(in.gd_ptr),ElementCache_(in.ElementCache_){
+            const_iterator(const const_iterator & in):idx_(in.idx_),sz_(in.sz_),gd_ptr(in.gd_ptr),tables_(in.tables_),ElementCache_(in.ElementCache_){
             }
-            const_iterator(const NonIndexedGuide * gd, ptrdiff_t advance=0):idx_(-1),fullidx_(-1),fullsz_(gd->fullsize()),sz_(gd->size()),gd_ptr(gd){
-                
+            const_iterator(const NonIndexedGuide * gd, ptrdiff_t advance=0):idx_(advance),sz_(gd->size()),gd_ptr(gd){
+                if (gd_ptr->maskf_){
+                    //note: the iterator holds on to the lookup tables which were valid upon construction
+                    tables_=gd_ptr->maskTables();
+                }
+
                 if(sz_ <= advance){
                     //all values already encountered , snap to 1 past the end
                     idx_=sz_;
-                    fullidx_=fullsz_;
                     return;
                 }
-
-
-                if( 0 < gd_ptr->nmask_ ){
-                    
-                    //we need to pass through the iterator and test for masked values on the way to know at which idx_ we are
-                    
-                    do{
-                        ++(*this);
-                    }while(idx_ < advance);
-
-                }else{
-                    //nothing is masked
-                    //idx_ == fullidx_ when nothin is masked
-                    idx_=advance;
-                    fullidx_=idx_;
-                    ElementCache_=gd_ptr->elfromi(idx_);
-                }
-
-
+                setCache();
             }
 
             const_iterator& operator++(){
-               ++fullidx_; 
-               
-               if (fullidx_ < fullsz_){
-                   ElementCache_=gd_ptr->elfromi(fullidx_);
-               }else{
-                   //quick return when we've reached the end of the iterator
-                   idx_=sz_; 
-                   return *this;
-               }
-
-                            
-                if (gd_ptr->maskf_){
-                    //skip forward through masked entries
-                    while( gd_ptr->maskf_(ElementCache_)){
-                        ++fullidx_;
-                        if(fullsz_ == fullidx_){
-                            //reached the end quick return
-                            idx_=sz_;
-                            return *this;
-                        }
-                        ElementCache_=gd_ptr->elfromi(fullidx_);      
-                    }
-
-                }
                 ++idx_;
-                
+                if (idx_ < sz_){
+                    setCache();
+                }
                 return *this;
             }
 
@@ -204,14 +177,15 @@ namespace frommle{
 
         protected:
             ptrdiff_t idx_=0;
-            ptrdiff_t fullidx_=0;
             size_t sz_=0;
-            size_t fullsz_=0;
-            size_t nmask_=0;
             //note the iterator does not own the guide pointer so we just use a normal one here
             const NonIndexedGuide* gd_ptr=nullptr;
+            std::shared_ptr<const MaskTables> tables_{};
             mutable Element ElementCache_;
         private:
+            inline void setCache(){
+                ElementCache_=gd_ptr->elfromi(tables_?tables_->fwd[idx_]:idx_);
+            }
         };
         
             const_iterator begin()const{
@@ -223,32 +197,59 @@ namespace frommle{
                 return const_iterator(this,fullsize());
             }
 
+        ///@brief mask elements for which maskf returns true (a mask which is already present is combined with the new one)
         void mask (std::function<bool(const Element &)> maskf){
-            if( maskf){
-                THROWINPUTEXCEPTION("Cannot currently apply 2 mask functions");
+            if (!maskf){
+                return;
             }
-            maskf_=maskf;
 
-            //check condition and increase nmask
-            for(const auto el:*this){
-                if (maskf_(el)){
-                    ++nmask_;
-                }
+            if( maskf_){
+                //combine with the existing mask
+                auto prevmask=maskf_;
+                maskf_=[prevmask,maskf](const Element & el){return prevmask(el) or maskf(el);};
+            }else{
+                maskf_=maskf;
             }
+            //the lookup tables will be rebuilt upon first use
+            std::atomic_store(&tables_,std::shared_ptr<const MaskTables>());
+            this->touch();
 
         }            
 
        void unmask(){
             maskf_=maskf_t();
-            nmask_=0;
+            std::atomic_store(&tables_,std::shared_ptr<const MaskTables>());
+            this->touch();
        }
 
 
         private:
         using maskf_t=std::function<bool(const Element &)>; 
+        ///@brief returns the lookup tables of the current mask (they are built when needed)
+        std::shared_ptr<const MaskTables> maskTables()const{
+            auto tables=std::atomic_load(&tables_);
+            if (!tables){
+                auto newtables=std::make_shared<MaskTables>();
+                const size_t nfull=fullsize();
+                newtables->inv.resize(nfull,masked);
+                for(size_t i=0;i<nfull;++i){
+                    if(!maskf_(elfromi(i))){
+                        newtables->inv[i]=newtables->fwd.size();
+                        newtables->fwd.push_back(i);
+                    }
+                }
+                tables=newtables;
+                std::atomic_store(&tables_,tables);
+            }
+            return tables;
+        }
         maskf_t maskf_{};
-        size_t nmask_=0; 
+        //note: the tables are immutable and may be shared between copies of the guide
+        mutable std::shared_ptr<const MaskTables> tables_{};
         };
+
+    template<class ELEM>
+    const size_t NonIndexedGuide<ELEM>::masked;
     }
 }
 
@@ -0,0 +1,97 @@
+/*! \file
+ \brief Lightweight helpers to distribute loops over multiple threads
+ \copyright Roelof Rietbroek 2020
+ \license
+ This file is part of Frommle.
+ frommle is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3 of the License, or (at your option) any later version.
+
+ Frommle is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with Frommle; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <exception>
+#include <algorithm>
+
+#ifndef FROMMLE_PARALLEL_HPP
+#define FROMMLE_PARALLEL_HPP
+
+namespace frommle{
+    namespace core{
+
+        ///@brief resolve the number of threads to use (values < 1 mean: use all available cores)
+        inline int nThreads(const int nthreads=0){
+            if (nthreads > 0){
+                return nthreads;
+            }
+            return std::max(1,static_cast<int>(std::thread::hardware_concurrency()));
+        }
+
+        /*!@brief Apply f(ithread,istart,iend) to chunks of [0,n) using nthreads threads
+         * Chunks are handed out dynamically so unevenly sized work items balance out.
+         * The calling thread takes part in the work and the first exception thrown by a worker is rethrown
+         */
+        template<class F>
+        void parallel_for(const size_t n, F && f, const int nthreads=0, size_t chunk=1){
+            if (n == 0){
+                return;
+            }
+            chunk=std::max<size_t>(chunk,1);
+            const int nth=std::min<size_t>(nThreads(nthreads),(n+chunk-1)/chunk);
+            if(nth == 1){
+                //quick return to avoid threading overhead
+                f(0,0,n);
+                return;
+            }
+
+            std::atomic<size_t> next{0};
+            std::exception_ptr eptr{};
+            std::mutex emut;
+
+            auto worker=[&](const int ithread){
+                try{
+                    size_t istart;
+                    while((istart=next.fetch_add(chunk)) < n){
+                        f(ithread,istart,std::min(istart+chunk,n));
+                    }
+                }catch(...){
+                    std::lock_guard<std::mutex> lock(emut);
+                    if(!eptr){
+                        eptr=std::current_exception();
+                    }
+                    //make sure other threads stop picking up new work
+                    next=n;
+                }
+            };
+
+            std::vector<std::thread> threads;
+            threads.reserve(nth-1);
+            for(int ith=1;ith<nth;++ith){
+                threads.emplace_back(worker,ith);
+            }
+            worker(0);
+            for(auto & th:threads){
+                th.join();
+            }
+
+            if(eptr){
+                std::rethrow_exception(eptr);
+            }
+        }
+
+    }
+}
+
+#endif //FROMMLE_PARALLEL_HPP
@@ -46,6 +46,13 @@ namespace frommle{
 
             std::tuple<double,double> lonlat(const lint ilon, const lint ilat)const;
 
+            lint nlon()const{return nlon_;}
+            lint nlat()const{return nlat_;}
+            double dlon()const{return dx_;}
+            double dlat()const{return dy_;}
+            gridreg reg()const{return reg_;}
+            const geometry::bbox & bbox()const{return bbox_;}
+
             ///@brief nested iterator class using boost iterators to loop over the points of the grid
         class const_iterator:public  boost::iterator_facade<const_iterator,geometry::geopoint const,boost::forward_traversal_tag>{
             public:
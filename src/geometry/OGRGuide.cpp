@@ -25,36 +25,113 @@ namespace frommle{
 
         template<class T>
         void OGRGuide<T>::push_back(T &&geometry) {
+            invalidate();
             geoms_.push_back(std::make_shared<T>(std::move(geometry)));
         }
 
         ///@brief create a boost rtree index of the geometry using the packing algorithm
         template<class T>
-        void OGRGuide<T>::buildRtree() {
-            //construct a vector with idxmap (box + index)
-            std::vector<idxmap> idxboxes{};
-            size_t indx=0;
-            OGREnvelope env{};
-            for(auto & geom:geoms_){
-                geom->getEnvelope(&env);
+        const typename OGRGuide<T>::rtree &OGRGuide<T>::getRtree()const {
+            auto rtreeptr=std::atomic_load(&rtreeIndex);
+            if(!rtreeptr){
+                //construct a vector with idxmap (box + index)
+                std::vector<idxmap> idxboxes{};
+                size_t indx=0;
+                OGREnvelope env{};
+                for(auto & geom:geoms_){
+                    geom->getEnvelope(&env);
+
+                    idxboxes.push_back(idxmap(box(point(env.MinX,env.MinY),point(env.MaxX,env.MaxY)),indx++));
+                }
+                rtreeptr=std::make_shared<const rtree>(idxboxes.cbegin(),idxboxes.cend());
+                std::atomic_store(&rtreeIndex,rtreeptr);
+            }
+            return *rtreeptr;
+        }
 
-                idxboxes.push_back(idxmap(box(point(env.MinX,env.MinY),point(env.MaxX,env.MaxY)),indx++));
+        template<class T>
+        const typename OGRGuide<T>::hashindex &OGRGuide<T>::getHashIndex()const {
+            auto hashptr=std::atomic_load(&hashIndex_);
+            if(!hashptr){
+                auto newindex=std::make_shared<hashindex>();
+                newindex->reserve(geoms_.size());
+                OGRGeomHash<T> hsh;
+                for(size_t i=0;i<geoms_.size();++i){
+                    newindex->emplace(hsh(*geoms_[i]),i);
+                }
+                hashptr=newindex;
+                std::atomic_store(&hashIndex_,hashptr);
             }
-            rtreeIndex=std::unique_ptr<rtree>(new rtree(idxboxes.cbegin(),idxboxes.cend()));
+            return *hashptr;
+        }
 
+        template<class T>
+        ptrdiff_t OGRGuide<T>::find(const T &geom)const {
+            const auto & index=getHashIndex();
+            auto range=index.equal_range(OGRGeomHash<T>()(geom));
+            ptrdiff_t ifound=-1;
+            for(auto it=range.first;it!=range.second;++it){
+                //resolve hash collisions with an exact comparison (and return the first occurrence)
+                if((ifound < 0 or it->second < ifound) and *geoms_[it->second] == geom){
+                    ifound=it->second;
+                }
+            }
 
+            if (ifound < 0 and !std::is_same<T,OGRPoint>::value){
+                //other geometries may be equal while having a different WKB representation (e.g. a different starting vertex)
+                for(size_t i=0;i<geoms_.size();++i){
+                    if(*geoms_[i] == geom){
+                        return i;
+                    }
+                }
+            }
+            return ifound;
         }
 
         template<class T>
-        const typename OGRGuide<T>::rtree &OGRGuide<T>::getRtree() {
-            if(!rtreeIndex){
-                buildRtree();
+        std::vector<ptrdiff_t> OGRGuide<T>::idx(const OGRGuide &other)const {
+            std::vector<ptrdiff_t> indices;
+            indices.reserve(other.size());
+            for(const auto & geom:other.geoms_){
+                indices.push_back(find(*geom));
+            }
+            return indices;
+        }
+
+        template<class T>
+        std::vector<ptrdiff_t> OGRGuide<T>::idx(const OGRGuide &other, const double tolerance)const {
+            const auto & rtreeidx=getRtree();
+            std::vector<ptrdiff_t> indices;
+            indices.reserve(other.size());
+            OGREnvelope env{};
+            std::vector<idxmap> candidates;
+            for(const auto & geom:other.geoms_){
+                geom->getEnvelope(&env);
+                const double xc=0.5*(env.MinX+env.MaxX);
+                const double yc=0.5*(env.MinY+env.MaxY);
+                //query the rtree for all geometries with envelopes near the search geometry
+                box search(point(env.MinX-tolerance,env.MinY-tolerance),point(env.MaxX+tolerance,env.MaxY+tolerance));
+                candidates.clear();
+                rtreeidx.query(bgi::intersects(search),std::back_inserter(candidates));
+                ptrdiff_t inear=-1;
+                double mindist=tolerance;
+                for(const auto & cand:candidates){
+                    const auto & cmin=cand.first.min_corner();
+                    const auto & cmax=cand.first.max_corner();
+                    const double dist=std::hypot(0.5*(cmin.getX()+cmax.getX())-xc,0.5*(cmin.getY()+cmax.getY())-yc);
+                    if(dist < mindist or (dist == mindist and (inear < 0 or cand.second < inear))){
+                        mindist=dist;
+                        inear=cand.second;
+                    }
+                }
+                indices.push_back(inear);
             }
-            return *rtreeIndex;
+            return indices;
         }
 
         template<class T>
         void OGRGuide<T>::push_back(const std::string &WKT) {
+            invalidate();
 //                geoms_.push_back(std::make_shared<T>());
             OGRGeometry ** geomptr= new OGRGeometry*;
 //                *geomptr=geoms_.back().get();
@@ -68,6 +145,7 @@ namespace frommle{
 
         template<class T>
         void OGRGuide<T>::push_back(const T &geometry) {
+            invalidate();
             geoms_.push_back(std::make_shared<T>(geometry));
         }
 
@@ -31,6 +31,8 @@
 #include <boost/geometry/geometries/box.hpp>
 #include <boost/geometry/geometries/polygon.hpp>
 #include <boost/geometry/index/rtree.hpp>
+#include <unordered_map>
+#include <cmath>
 
 namespace bg=boost::geometry;
 namespace bgi = boost::geometry::index;
@@ -40,6 +42,29 @@ namespace bgi = boost::geometry::index;
 
 namespace frommle{
     namespace guides{
+        ///@brief hash of a geometry based on its WKB representation (identical geometries have the same hash)
+        template<class T>
+        struct OGRGeomHash{
+            size_t operator()(const T & geom)const{
+                std::string wkb(geom.WkbSize(),'\0');
+                geom.exportToWkb(wkbNDR,reinterpret_cast<unsigned char*>(&wkb[0]));
+                return std::hash<std::string>()(wkb);
+            }
+        };
+
+        ///@brief points are hashed on their quantized coordinates (equal coordinates always end up with the same hash)
+        template<>
+        struct OGRGeomHash<OGRPoint>{
+            static constexpr double quantum=1e7;
+            size_t operator()(const OGRPoint & pnt)const{
+                std::hash<double> hsh;
+                size_t seed=hsh(std::round(pnt.getX()*quantum));
+                seed^=hsh(std::round(pnt.getY()*quantum))+0x9e3779b9+(seed<<6)+(seed>>2);
+                seed^=hsh(std::round(pnt.getZ()*quantum))+0x9e3779b9+(seed<<6)+(seed>>2);
+                return seed;
+            }
+        };
+
         template<class T>
         class OGRGuide:public GuideBase{
         public:
@@ -60,17 +85,23 @@ namespace frommle{
             const_iterator begin() const { return geoms_.cbegin(); }
             const_iterator end() const { return geoms_.cend(); }
 
-            iterator begin() { return geoms_.begin(); }
-            iterator end() { return geoms_.end(); }
-            Element & operator[](const size_t idx){return geoms_.at(idx);}
+            //note: non-const access may modify the geometries, so the spatial indices are invalidated
+            iterator begin() { invalidate(); return geoms_.begin(); }
+            iterator end() { invalidate(); return geoms_.end(); }
+            Element & operator[](const size_t idx){invalidate(); return geoms_.at(idx);}
             const Element & operator[](const size_t idx)const{return geoms_.at(idx);}
+            ///@brief index of the first geometry which equals the input (uses a hash index which is built upon first use)
             size_t idx(const T & geom)const{
-                size_t i=0;
-                for(auto & geo:geoms_){
-                    if(*geo == geom){return i;}
-                    ++i;
+                ptrdiff_t i=find(geom);
+                if (i < 0){
+                    THROWINDEXCEPTION("Geometry not found in OGRGuide");
                 }
+                return i;
             }
+            ///@brief indices of all geometries of another guide in this guide (-1 when absent)
+            std::vector<ptrdiff_t> idx(const OGRGuide & other)const;
+            ///@brief indices of the nearest geometries (envelope centres) in this guide within a tolerance in coordinate units (-1 when none are found)
+            std::vector<ptrdiff_t> idx(const OGRGuide & other, const double tolerance)const;
             //spatial queries
             //Rtree stuff (store the encompassing geo box of the OGR geometry in the rtree)
             //using point=bg::model::point<double,2,bg::cs::geographic<bg::degree>>;
@@ -80,7 +111,7 @@ namespace frommle{
             
             using idxmap=std::pair<box, size_t>;
             using rtree=bgi::rtree<idxmap,bgi::rstar<16,4>>;
-            const rtree & getRtree();
+            const rtree & getRtree()const;
             //operator core::MaskedGuide<OGRGuide>(){
             //return core::MaskedGuide<OGRGuide>(static_cast<const OGRGuide&>(*this));
             //}
@@ -96,10 +127,19 @@ namespace frommle{
 //            template<class Archive>
 //            void save(Archive & Ar)const;
 
+            using hashindex=std::unordered_multimap<size_t,size_t>;
 
             std::vector <Element> geoms_={};
-            std::shared_ptr<rtree> rtreeIndex{};
-            void buildRtree();
+            //note: the indices are immutable once built and may be shared by copies of the guide
+            mutable std::shared_ptr<const rtree> rtreeIndex{};
+            mutable std::shared_ptr<const hashindex> hashIndex_{};
+            ptrdiff_t find(const T & geom)const;
+            const hashindex & getHashIndex()const;
+            void invalidate(){
+                std::atomic_store(&rtreeIndex,std::shared_ptr<const rtree>());
+                std::atomic_store(&hashIndex_,std::shared_ptr<const hashindex>());
+                this->touch();
+            }
             OGRSpatialReference SpatialRef_=*OGRSpatialReference::GetWGS84SRS();
         };
 
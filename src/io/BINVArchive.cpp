@@ -0,0 +1,280 @@
+/*! \file BINVArchive.cpp
+ \brief Implementation of the memory mapped BINV reader
+ \copyright Roelof Rietbroek 2021
+ \license
+ This file is part of Frommle.
+ frommle is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3 of the License, or (at your option) any later version.
+
+ Frommle is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with Frommle; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "io/BINVArchive.hpp"
+#include "core/Exceptions.hpp"
+#include <cstring>
+#include <algorithm>
+#include <numeric>
+
+namespace frommle{
+    namespace io{
+
+        ///@brief sequential reader of the (possibly byte swapped) header fields in a memory mapped buffer
+        class BINVCursor{
+        public:
+            BINVCursor(const char * begin, const char * end):c_(begin),end_(end){}
+
+            template<class T>
+            T get(){
+                T val;
+                std::memcpy(&val,take(sizeof(T)),sizeof(T));
+                if(swap_){
+                    char * b=reinterpret_cast<char*>(&val);
+                    std::reverse(b,b+sizeof(T));
+                }
+                return val;
+            }
+
+            std::string getString(const size_t nchar){
+                return std::string(take(nchar),nchar);
+            }
+
+            ///@brief fixed width description string with trailing blanks removed
+            std::string getName(const size_t nchar=24){
+                std::string name=getString(nchar);
+                name.erase(name.find_last_not_of(" \0",std::string::npos,2)+1);
+                return name;
+            }
+
+            const char * take(const size_t nbytes){
+                if(c_+nbytes > end_){
+                    THROWIOEXCEPTION("Unexpected end of BINV file");
+                }
+                const char * cur=c_;
+                c_+=nbytes;
+                return cur;
+            }
+
+            void setSwap(const bool swap){swap_=swap;}
+        private:
+            const char * c_=nullptr;
+            const char * end_=nullptr;
+            bool swap_=false;
+        };
+
+        BINVArchive::BINVArchive(const std::string &filename):ArchiveBase(filename,"r"),mfile_(filename) {
+            BINVCursor cur(mfile_.data(),mfile_.data()+mfile_.size());
+
+            //check the endianness from the magic number (the file starts with the characters BI)
+            const uint16_t magic=18754;
+            swap_=(cur.get<uint16_t>() != magic);
+            cur.setSwap(swap_);
+
+            std::string version=std::string("BI")+cur.getString(6);
+            const double vnum=std::stod(version.substr(4,3));
+            attr().set("version",version);
+            type_=cur.getString(8);
+            attr().set("type",type_);
+            attr().set("description",cur.getString(80));
+
+            const size_t nints=cur.get<uint32_t>();
+            const size_t ndbls=cur.get<uint32_t>();
+            nval1_=cur.get<uint32_t>();
+            nval2_=cur.get<uint32_t>();
+            size_t pval1,pval2;
+            if(vnum < 2.4){
+                pval1=cur.get<uint32_t>();
+                pval2=cur.get<uint32_t>();
+            }else{
+                pval1=cur.get<uint64_t>();
+                pval2=cur.get<uint64_t>();
+            }
+
+            size_t nread=0;
+            if(vnum <= 2.1){
+                //older versions derive the amount of vectors from the type
+                if(type_ == "SYMV1___"){
+                    nvec_=1;
+                }else if(type_ == "SYMV2___"){
+                    nvec_=2;
+                }
+                pval2=(type_ == "FULLSQV0")?pval1:1;
+                nval2_=nval1_;
+            }else{
+                nvec_=cur.get<uint32_t>();
+                nread=cur.get<uint32_t>();
+            }
+
+            //determine the storage layout
+            const bool blockdiag=(type_ == "BDSYMV0_" or type_ == "BDSYMVN_" or type_ == "BDFULLV0" or type_ == "BDFULLVN");
+            if(type_ == "DIAVN___"){
+                layout_=storage::diagonal;
+            }else if(type_.compare(0,4,"SYMV") == 0){
+                layout_=storage::symmetric;
+            }else if(type_ == "BDSYMV0_" or type_ == "BDSYMVN_"){
+                layout_=storage::blockSymmetric;
+            }else if(type_ == "BDFULLV0" or type_ == "BDFULLVN"){
+                layout_=storage::blockFull;
+            }else if(type_ == "FULLSQV0" or type_ == "FULLSQVN" or type_ == "FULL2DVN"){
+                layout_=storage::full;
+            }else{
+                THROWIOEXCEPTION("Unsupported BINV matrix type "+type_);
+            }
+
+            size_t nblk=0;
+            if(blockdiag){
+                nblk=cur.get<uint32_t>();
+            }
+
+            if(nread > 0){
+                attr().set("readme",cur.getString(nread*80));
+            }
+
+            //meta data (integer names and values followed by the double names and values)
+            for(size_t i=0;i<nints;++i){
+                metanames_.push_back(cur.getName());
+            }
+            for(size_t i=0;i<nints;++i){
+                attr().set(metanames_[i],(vnum <= 2.4)?size_t(cur.get<uint32_t>()):size_t(cur.get<uint64_t>()));
+            }
+            for(size_t i=0;i<ndbls;++i){
+                metanames_.push_back(cur.getName());
+            }
+            for(size_t i=nints;i<nints+ndbls;++i){
+                attr().set(metanames_[i],cur.get<double>());
+            }
+
+            side1_.reserve(nval1_);
+            for(size_t i=0;i<nval1_;++i){
+                side1_.push_back(cur.getName());
+            }
+
+            //set up the diagonal blocks and their offsets in the packed payload
+            if(blockdiag){
+                for(size_t i=0;i<nblk;++i){
+                    blockend_.push_back(cur.get<uint32_t>());
+                }
+            }else if (layout_ == storage::diagonal){
+                blockend_.resize(nval1_);
+                std::iota(blockend_.begin(),blockend_.end(),1);
+            }else{
+                blockend_.push_back(nval1_);
+            }
+
+            if(layout_ == storage::blockFull or type_ == "FULLSQV0" or type_ == "FULLSQVN"){
+                if(vnum <= 2.2){
+                    side2_=side1_;
+                }else{
+                    for(size_t i=0;i<nval1_;++i){
+                        side2_.push_back(cur.getName());
+                    }
+                }
+            }else if(type_ == "FULL2DVN"){
+                for(size_t i=0;i<nval2_;++i){
+                    side2_.push_back(cur.getName());
+                }
+            }
+
+            size_t off=0;
+            for(size_t i=0;i<nblocks();++i){
+                blockoff_.push_back(off);
+                off+=packedSize(i);
+            }
+
+            npack_=pval1*pval2;
+            if(off != npack_){
+                THROWIOEXCEPTION("Inconsistent size of the packed BINV matrix");
+            }
+
+            //vectors and packed matrix
+            const size_t nvecval=nvec_*nval1_;
+            const char * vecdata=cur.take(nvecval*sizeof(double));
+            const char * packdata=cur.take(npack_*sizeof(double));
+            if(swap_){
+                //byte swap the payload once (copies the data)
+                swapbuf_.resize(nvecval+npack_);
+                BINVCursor swpcur(vecdata,packdata+npack_*sizeof(double));
+                swpcur.setSwap(true);
+                for(auto & val:swapbuf_){
+                    val=swpcur.get<double>();
+                }
+                vec_=swapbuf_.data();
+                pack_=swapbuf_.data()+nvecval;
+            }else{
+                //note: the data is used directly from the memory map (doubles may be unaligned in the file, which is fine on x86)
+                vec_=reinterpret_cast<const double*>(vecdata);
+                pack_=reinterpret_cast<const double*>(packdata);
+            }
+
+            attr().set("nval1",nval1_);
+            attr().set("nval2",nval2_);
+            attr().set("nvec",nvec_);
+            attr().set("nblocks",nblocks());
+        }
+
+        size_t BINVArchive::packedSize(const size_t iblk) const {
+            const size_t sz=blockSize(iblk);
+            switch(layout_){
+                case storage::diagonal:
+                    return 1;
+                case storage::symmetric:
+                case storage::blockSymmetric:
+                    return (sz*(sz+1))/2;
+                case storage::full:
+                    return sz*nval2_;
+                case storage::blockFull:
+                    return sz*sz;
+            }
+            return 0;
+        }
+
+        BINVArchive::cmat BINVArchive::block(const size_t iblk) const {
+            if(packedTriangular()){
+                THROWMETHODEXCEPTION("Blocks in packed triangular storage need to be unpacked explicitly");
+            }
+            const size_t sz=blockSize(iblk);
+            return cmat(pack_+blockoff_.at(iblk),sz,(layout_ == storage::full)?nval2_:sz);
+        }
+
+        Eigen::MatrixXd BINVArchive::unpackBlock(const size_t iblk) const {
+            if(!packedTriangular()){
+                return block(iblk);
+            }
+            const size_t sz=blockSize(iblk);
+            Eigen::MatrixXd mat(sz,sz);
+            const double * pck=pack_+blockoff_.at(iblk);
+            //column major packed upper triangle
+            for(size_t j=0;j<sz;++j){
+                for(size_t i=0;i<=j;++i){
+                    mat(i,j)=*pck;
+                    mat(j,i)=*pck;
+                    ++pck;
+                }
+            }
+            return mat;
+        }
+
+        Eigen::MatrixXd BINVArchive::unpack() const {
+            Eigen::MatrixXd mat=Eigen::MatrixXd::Zero(nval1_,nval2_);
+            if(layout_ == storage::full){
+                mat=block(0);
+                return mat;
+            }
+            for(size_t iblk=0;iblk<nblocks();++iblk){
+                const size_t st=blockStart(iblk);
+                const size_t sz=blockSize(iblk);
+                mat.block(st,st,sz,sz)=unpackBlock(iblk);
+            }
+            return mat;
+        }
+
+    }
+}
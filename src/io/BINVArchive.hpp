@@ -0,0 +1,109 @@
+/*! \file
+ \brief Memory mapped reader for (block diagonal) matrices stored in the binary BINV format of the RLFTlbx
+ \copyright Roelof Rietbroek 2021
+ \license
+ This file is part of Frommle.
+ frommle is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3 of the License, or (at your option) any later version.
+
+ Frommle is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with Frommle; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <string>
+#include <vector>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <eigen3/Eigen/Core>
+#include "io/ArchiveBase.hpp"
+
+#ifndef FROMMLE_BINVARCHIVE_HPP
+#define FROMMLE_BINVARCHIVE_HPP
+
+namespace frommle{
+    namespace io{
+
+        /*!@brief Archive which memory maps a BINV file and provides zero-copy access to its (packed) matrix blocks
+         * Supported are diagonal (DIAVN___), symmetric (SYMV*), block diagonal (BDSYMV*, BDFULLV*) and full (FULLSQV*, FULL2DVN) matrices
+         * Symmetric matrices are stored as packed upper triangles (column major) and are only unpacked upon request
+         * When the endianness of the file differs from the machine, the payload is byte swapped into memory once (no zero-copy access possible)
+         * The meta data of the file is stored in the attributes
+         */
+        class BINVArchive:public ArchiveBase{
+        public:
+            using cmat=Eigen::Map<const Eigen::MatrixXd>;
+            using cvec=Eigen::Map<const Eigen::VectorXd>;
+            enum class storage{diagonal,symmetric,full,blockSymmetric,blockFull};
+            BINVArchive():ArchiveBase(){}
+            explicit BINVArchive(const std::string & filename);
+            ///@brief no copies as the data pointers refer to the memory map or swap buffer of this instance
+            BINVArchive(const BINVArchive &)=delete;
+            BINVArchive & operator=(const BINVArchive &)=delete;
+
+            const std::string & type()const{return type_;}
+            storage layout()const{return layout_;}
+            ///@brief true when the blocks are stored as packed upper triangles
+            bool packedTriangular()const{return layout_ == storage::symmetric or layout_ == storage::blockSymmetric;}
+            ///@brief true when the file holds data in a byte order different from the machine
+            bool swapped()const{return swap_;}
+
+            size_t nval1()const{return nval1_;}
+            size_t nval2()const{return nval2_;}
+            size_t nvec()const{return nvec_;}
+            ///@brief number of diagonal blocks (diagonal matrices have 1x1 blocks, full matrices a single block)
+            size_t nblocks()const{return blockend_.size();}
+            ///@brief first row/column of a diagonal block
+            size_t blockStart(const size_t iblk)const{return (iblk == 0)?0:blockend_.at(iblk-1);}
+            size_t blockSize(const size_t iblk)const{return blockend_.at(iblk)-blockStart(iblk);}
+            ///@brief cumulative end indices of the diagonal blocks (as stored in the file)
+            const std::vector<size_t> & blockind()const{return blockend_;}
+
+            const std::vector<std::string> & side1()const{return side1_;}
+            const std::vector<std::string> & side2()const{return side2_;}
+            ///@brief names of the meta data entries (stored in the attributes)
+            const std::vector<std::string> & metaNames()const{return metanames_;}
+
+            ///@brief the complete packed payload
+            cvec pack()const{return cvec(pack_,npack_);}
+            ///@brief the vectors stored in the file (nval1 x nvec)
+            cmat vec()const{return cmat(vec_,nval1_,nvec_);}
+            ///@brief the packed payload of a single block (a packed upper triangle for symmetric storage)
+            cvec packedBlock(const size_t iblk)const{return cvec(pack_+blockoff_.at(iblk),packedSize(iblk));}
+            ///@brief zero-copy access to a full (column major) block, not possible for packed triangular storage
+            cmat block(const size_t iblk)const;
+            ///@brief explicitly unpack a block (symmetric blocks are mirrored)
+            Eigen::MatrixXd unpackBlock(const size_t iblk)const;
+            ///@brief unpack the complete matrix (nval1 x nval2)
+            Eigen::MatrixXd unpack()const;
+            size_t packedSize(const size_t iblk)const;
+        private:
+            std::string type_="";
+            storage layout_=storage::full;
+            bool swap_=false;
+            size_t nval1_=0;
+            size_t nval2_=0;
+            size_t nvec_=0;
+            size_t npack_=0;
+            std::vector<size_t> blockend_{};
+            std::vector<size_t> blockoff_{};
+            std::vector<std::string> side1_{};
+            std::vector<std::string> side2_{};
+            std::vector<std::string> metanames_{};
+            boost::iostreams::mapped_file_source mfile_{};
+            ///@brief holds the byte swapped vectors and payload when the endianness differs
+            std::vector<double> swapbuf_{};
+            const double * vec_=nullptr;
+            const double * pack_=nullptr;
+        };
+
+    }
+}
+
+#endif //FROMMLE_BINVARCHIVE_HPP
@@ -0,0 +1,278 @@
+/*! \file
+ \brief Implementation of the block oriented line reader
+ \copyright Roelof Rietbroek 2021
+ \license
+ This file is part of Frommle.
+ frommle is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3 of the License, or (at your option) any later version.
+
+ Frommle is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with Frommle; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "io/BlockLineReader.hpp"
+#include "core/Exceptions.hpp"
+#include "core/Parallel.hpp"
+#include <iostream>
+#include <cstring>
+#include <cstdint>
+
+namespace frommle{
+    namespace io{
+
+        const size_t BlockLineReader::defaultBlockSize;
+
+        static uint32_t le32(const unsigned char * b){
+            return uint32_t(b[0]) | (uint32_t(b[1]) << 8) | (uint32_t(b[2]) << 16) | (uint32_t(b[3]) << 24);
+        }
+
+        static bool isGzipHeader(const unsigned char * b){
+            return b[0] == 0x1f and b[1] == 0x8b and b[2] == 8;
+        }
+
+        ///@brief extract the size of a BGZF member from the extra field of the gzip header (returns 0 if not present)
+        static size_t bgzfBlockSize(const unsigned char * extra, const size_t xlen){
+            size_t i=0;
+            while(i+4 <= xlen){
+                const size_t slen=extra[i+2] | (extra[i+3] << 8);
+                if (extra[i] == 'B' and extra[i+1] == 'C' and slen == 2 and i+6 <= xlen){
+                    return (extra[i+4] | (extra[i+5] << 8))+1;
+                }
+                i+=4+slen;
+            }
+            return 0;
+        }
+
+        BlockLineReader::BlockLineReader(const std::string &filename, const bool gzip, const size_t blocksize):gzip_(gzip) {
+            openfile(filename);
+            //reserve one extra byte so the last line can always be null terminated
+            buf_.resize(std::max<size_t>(blocksize,64)+1);
+            if (!gzip_){
+                return;
+            }
+
+            zbuf_.resize(std::max<size_t>(blocksize/4,size_t(1) << 16));
+            fillRaw();
+            const auto * hdr=reinterpret_cast<const unsigned char*>(zbuf_.data());
+            if (zend_ >= 18 and isGzipHeader(hdr) and (hdr[3] & 4)){
+                const size_t xlen=hdr[10] | (hdr[11] << 8);
+                bgzf_=(12+xlen <= zend_ and bgzfBlockSize(hdr+12,xlen) > 0);
+            }
+
+            if (!bgzf_){
+                //16+MAX_WBITS: expect a gzip header
+                if (inflateInit2(&zstrm_,16+MAX_WBITS) != Z_OK){
+                    THROWIOEXCEPTION("Cannot initialize gzip decompression");
+                }
+                zinit_=true;
+            }
+        }
+
+        BlockLineReader::~BlockLineReader() {
+            if (zinit_){
+                inflateEnd(&zstrm_);
+            }
+        }
+
+        void BlockLineReader::openfile(const std::string &filename) {
+            if (filename == "-"){
+                in_=&std::cin;
+                return;
+            }
+            file_=std::unique_ptr<std::ifstream>(new std::ifstream(filename,std::ios_base::in | std::ios_base::binary));
+            if (!file_->good()){
+                THROWIOEXCEPTION("Could not open file "+filename);
+            }
+            in_=file_.get();
+        }
+
+        bool BlockLineReader::getline(string_view &line) {
+            while(true){
+                char * start=buf_.data()+pos_;
+                auto nl=static_cast<char*>(std::memchr(start,'\n',end_-pos_));
+                if (nl){
+                    *nl='\0';
+                    line=string_view(start,nl-start);
+                    pos_=nl-buf_.data()+1;
+                    ++nline_;
+                    return true;
+                }
+
+                if (eof_){
+                    if (pos_ < end_){
+                        //last line without a trailing newline
+                        buf_[end_]='\0';
+                        line=string_view(start,end_-pos_);
+                        pos_=end_;
+                        ++nline_;
+                        return true;
+                    }
+                    return false;
+                }
+
+                //move the incomplete line to the front of the buffer and append new data
+                if (pos_ > 0){
+                    std::memmove(buf_.data(),start,end_-pos_);
+                    end_-=pos_;
+                    pos_=0;
+                }
+
+                if (end_+1 >= buf_.size()){
+                    //the line is longer than the buffer
+                    buf_.resize(2*buf_.size());
+                }
+
+                const size_t nread=read(buf_.data()+end_,buf_.size()-1-end_);
+                if (nread == 0){
+                    eof_=true;
+                }
+                end_+=nread;
+            }
+        }
+
+        size_t BlockLineReader::read(char *dest, const size_t n) {
+            if (!gzip_){
+                in_->read(dest,n);
+                return in_->gcount();
+            }
+            return bgzf_?readBGZF(dest,n):readInflate(dest,n);
+        }
+
+        bool BlockLineReader::fillRaw() {
+            if (zpos_ < zend_){
+                return true;
+            }
+            in_->read(zbuf_.data(),zbuf_.size());
+            zpos_=0;
+            zend_=in_->gcount();
+            return zend_ > 0;
+        }
+
+        size_t BlockLineReader::readRaw(char *dest, const size_t n) {
+            size_t nread=0;
+            while(nread < n and fillRaw()){
+                const size_t ncp=std::min(n-nread,zend_-zpos_);
+                std::memcpy(dest+nread,zbuf_.data()+zpos_,ncp);
+                zpos_+=ncp;
+                nread+=ncp;
+            }
+            return nread;
+        }
+
+        size_t BlockLineReader::readInflate(char *dest, const size_t n) {
+            zstrm_.next_out=reinterpret_cast<Bytef*>(dest);
+            zstrm_.avail_out=n;
+            while(zstrm_.avail_out > 0){
+                if (!fillRaw()){
+                    if (zmember_){
+                        THROWIOEXCEPTION("Unexpected end of gzip stream");
+                    }
+                    break;
+                }
+                zstrm_.next_in=reinterpret_cast<Bytef*>(zbuf_.data()+zpos_);
+                zstrm_.avail_in=zend_-zpos_;
+                const int ret=inflate(&zstrm_,Z_NO_FLUSH);
+                zpos_=zend_-zstrm_.avail_in;
+                zmember_=true;
+                if (ret == Z_STREAM_END){
+                    //possibly continue with the next member of a multi-member file
+                    inflateReset(&zstrm_);
+                    zmember_=false;
+                }else if (ret != Z_OK){
+                    THROWIOEXCEPTION("Error while decompressing gzip stream");
+                }
+            }
+            return n-zstrm_.avail_out;
+        }
+
+        size_t BlockLineReader::readBGZF(char *dest, const size_t n) {
+            while (bgzpos_ == bgzbuf_.size()){
+                if (!fillRaw()){
+                    return 0;
+                }
+                decompressBGZFbatch();
+            }
+            const size_t ncp=std::min(n,bgzbuf_.size()-bgzpos_);
+            std::memcpy(dest,bgzbuf_.data()+bgzpos_,ncp);
+            bgzpos_+=ncp;
+            return ncp;
+        }
+
+        void BlockLineReader::decompressBGZFbatch() {
+            struct member{
+                size_t coff;
+                size_t clen;
+                size_t uoff;
+                uint32_t isize;
+                uint32_t crc;
+            };
+
+            //collect the compressed members of a batch (roughly the size of the compressed buffer)
+            std::vector<member> members;
+            std::vector<unsigned char> comp;
+            size_t utotal=0;
+            unsigned char hdr[12];
+            std::vector<unsigned char> extra;
+            while(comp.size() < zbuf_.size() and fillRaw()){
+                if (readRaw(reinterpret_cast<char*>(hdr),12) != 12 or !isGzipHeader(hdr) or !(hdr[3] & 4)){
+                    THROWIOEXCEPTION("Invalid BGZF member header");
+                }
+                const size_t xlen=hdr[10] | (hdr[11] << 8);
+                extra.resize(xlen);
+                if (readRaw(reinterpret_cast<char*>(extra.data()),xlen) != xlen){
+                    THROWIOEXCEPTION("Truncated BGZF member header");
+                }
+                const size_t bsize=bgzfBlockSize(extra.data(),xlen);
+                if (bsize < 12+xlen+8){
+                    THROWIOEXCEPTION("Invalid BGZF block size");
+                }
+                //remaining deflate data and the crc32/isize trailer
+                const size_t nrest=bsize-12-xlen;
+                const size_t off=comp.size();
+                comp.resize(off+nrest);
+                if (readRaw(reinterpret_cast<char*>(comp.data()+off),nrest) != nrest){
+                    THROWIOEXCEPTION("Truncated BGZF member");
+                }
+                const unsigned char * trailer=comp.data()+off+nrest-8;
+                members.push_back({off,nrest-8,utotal,le32(trailer+4),le32(trailer)});
+                utotal+=members.back().isize;
+            }
+
+            bgzbuf_.resize(utotal);
+            bgzpos_=0;
+
+            //the members are independent deflate streams, so they can be decompressed concurrently
+            core::parallel_for(members.size(),[&](const int ithread, const size_t mstart, const size_t mend){
+                for(size_t im=mstart;im<mend;++im){
+                    const auto & mem=members[im];
+                    z_stream strm{};
+                    if (inflateInit2(&strm,-MAX_WBITS) != Z_OK){
+                        THROWIOEXCEPTION("Cannot initialize deflate decompression");
+                    }
+                    strm.next_in=const_cast<Bytef*>(comp.data()+mem.coff);
+                    strm.avail_in=mem.clen;
+                    auto out=reinterpret_cast<Bytef*>(bgzbuf_.data()+mem.uoff);
+                    strm.next_out=out;
+                    strm.avail_out=mem.isize;
+                    const int ret=inflate(&strm,Z_FINISH);
+                    inflateEnd(&strm);
+                    if ((ret != Z_STREAM_END and !(ret == Z_BUF_ERROR and mem.isize == 0)) or strm.avail_out != 0){
+                        THROWIOEXCEPTION("Error while decompressing BGZF member");
+                    }
+                    if (crc32(0,out,mem.isize) != mem.crc){
+                        THROWIOEXCEPTION("CRC mismatch in BGZF member");
+                    }
+                }
+            },nthreads_);
+        }
+
+    }
+}
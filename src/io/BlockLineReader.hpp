@@ -0,0 +1,117 @@
+/*! \file
+ \brief Block oriented reader which hands out lines of (gzipped) text files as views into a large buffer
+ \copyright Roelof Rietbroek 2021
+ \license
+ This file is part of Frommle.
+ frommle is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3 of the License, or (at your option) any later version.
+
+ Frommle is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with Frommle; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <boost/utility/string_view.hpp>
+#include <istream>
+#include <fstream>
+#include <memory>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <zlib.h>
+
+#ifndef FROMMLE_BLOCKLINEREADER_HPP
+#define FROMMLE_BLOCKLINEREADER_HPP
+
+namespace frommle{
+    namespace io{
+
+        /*!@brief Reads (gzipped) text in large blocks and returns the lines as views into the internal buffer
+         * Lines are handed out without allocation: the newline is replaced by a null character, so the views are also valid C strings
+         * Multi-member gzip files are supported, and members of bgzip (BGZF) files are decompressed in parallel
+         */
+        class BlockLineReader{
+        public:
+            using string_view=boost::string_view;
+            static const size_t defaultBlockSize=size_t(1) << 20;
+            ///@brief open a file ("-" reads from standard input)
+            explicit BlockLineReader(const std::string & filename="-", const bool gzip=false, const size_t blocksize=defaultBlockSize);
+            ~BlockLineReader();
+            BlockLineReader(const BlockLineReader &)=delete;
+            BlockLineReader & operator=(const BlockLineReader &)=delete;
+
+            ///@brief retrieve the next line (without newline), the view is valid until the next call
+            bool getline(string_view & line);
+
+            ///@brief number of lines which have been handed out
+            size_t lineNumber()const{return nline_;}
+            ///@brief true when the input is a bgzip file with independently decompressed members
+            bool isBGZF()const{return bgzf_;}
+            ///@brief set the number of threads used to decompress BGZF members (values < 1 use all available cores)
+            void setNThreads(const int nthreads){nthreads_=nthreads;}
+        private:
+            void openfile(const std::string & filename);
+            ///@brief fill dest with at most n bytes of decompressed data (returns 0 at the end of the input)
+            size_t read(char * dest, const size_t n);
+            size_t readInflate(char * dest, const size_t n);
+            size_t readBGZF(char * dest, const size_t n);
+            ///@brief read raw (compressed) bytes, starting with the data which is still held in the compressed buffer
+            size_t readRaw(char * dest, const size_t n);
+            bool fillRaw();
+            void decompressBGZFbatch();
+            ///@brief (uninitialized) character buffer which keeps its capacity
+            struct charbuf{
+                std::unique_ptr<char[]> data_{};
+                size_t size_=0;
+                size_t capacity_=0;
+                char * data(){return data_.get();}
+                char & operator[](const size_t i){return data_[i];}
+                size_t size()const{return size_;}
+                void resize(const size_t n){
+                    if (n > capacity_){
+                        std::unique_ptr<char[]> tmp(new char[n]);
+                        std::copy(data_.get(),data_.get()+size_,tmp.get());
+                        data_=std::move(tmp);
+                        capacity_=n;
+                    }
+                    size_=n;
+                }
+            };
+
+            std::unique_ptr<std::ifstream> file_{};
+            std::istream * in_=nullptr;
+            bool gzip_=false;
+            bool bgzf_=false;
+            int nthreads_=0;
+
+            //decompressed data and the part which is not handed out yet
+            charbuf buf_{};
+            size_t pos_=0;
+            size_t end_=0;
+            bool eof_=false;
+            size_t nline_=0;
+
+            //compressed input
+            charbuf zbuf_{};
+            size_t zpos_=0;
+            size_t zend_=0;
+            z_stream zstrm_{};
+            bool zinit_=false;
+            bool zmember_=false;
+
+            //batch of decompressed BGZF members
+            charbuf bgzbuf_{};
+            size_t bgzpos_=0;
+        };
+
+    }
+}
+
+#endif //FROMMLE_BLOCKLINEREADER_HPP
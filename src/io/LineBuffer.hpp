@@ -18,19 +18,19 @@
  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
  */
 
-#include <boost/iostreams/filtering_stream.hpp>
+#include "io/BlockLineReader.hpp"
 #include <iostream>
 #include <sstream>
+#include <string>
 #ifndef FROMMLE_LINEBUFFER_HPP
 #define FROMMLE_LINEBUFFER_HPP
 
-namespace bio=boost::iostreams;
-
 namespace frommle{
     namespace io{
         ///@brief A class which allows reading lines from (gzipped) text files, while keeping part of it in a buffer
         class LineBuffer{
         public:
+            using string_view=BlockLineReader::string_view;
             explicit LineBuffer(const std::string &filename="-");
             LineBuffer(const std::string &filename,bool gzip);
             ~LineBuffer();
@@ -46,29 +46,39 @@ namespace frommle{
                 iterator &operator++();
                 bool operator==(const iterator &other) const;
                 bool operator!=(const iterator & other) const {return !(*this == other);}
-                std::stringstream & operator*() {return currentLine_;}
+                ///@brief access the current line as a stringstream (which is only filled upon request)
+                std::stringstream & operator*() {
+                    if(!sset_){
+                        currentLine_.clear();
+                        currentLine_.str(std::string(line_.data(),line_.size()));
+                        sset_=true;
+                    }
+                    return currentLine_;
+                }
+                ///@brief direct access to the current (null terminated) line, which avoids the stringstream overhead
+                const char * line()const{return line_.data();}
+                ///@brief view of the current line (valid until the iterator is incremented)
+                string_view view()const{return line_;}
                 iterator(){}
-                iterator(std::istream *stream):strbuf(new char [maxchar]),currentLine_(strbuf.get()),stream_(stream){
+                iterator(BlockLineReader *reader):reader_(reader){
                     this->operator++();
                 }
 
             private:
-                std::streamsize maxchar=10000;
-                std::unique_ptr<char[]> strbuf{};
                 std::stringstream currentLine_{};
-                std::istream * stream_=nullptr;
+                string_view line_{};
+                size_t lineno_=0;
+                bool sset_=false;
+                BlockLineReader * reader_=nullptr;
             };
-            iterator begin(){return iterator(inStream);}
+            iterator begin(){return iterator(&reader_);}
             iterator end(){return iterator();}
 
+            ///@brief access to the underlying block reader (e.g. to iterate over string_views directly)
+            BlockLineReader & reader(){return reader_;}
+
         private:
-            std::string fname_="-";
-            std::istream * inStream = { nullptr };
-            bool gzip_=false;
-            bio::filtering_istream bioin = {};
-            std::unique_ptr<std::ifstream> file = { nullptr };
-            ///@brief opens a file for reading
-            void openfile();
+            BlockLineReader reader_;
 
         };
 
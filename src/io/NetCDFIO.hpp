@@ -127,14 +127,30 @@ namespace frommle {
 
             void getAttr();
 
+            ///@brief set the extents of the complete variable, needed when it is written in parts (an extent of 0 creates an unlimited dimension)
+            void setExtents(const std::vector<size_t> &extents){extents_=extents;}
+            ///@brief set the chunk shape which is used when the variable is defined
+            void setChunking(const std::vector<size_t> &chunks){chunks_=chunks;}
+            ///@brief compress the variable with the given deflate level (1-9), optionally preceded by the shuffle filter
+            void setDeflate(const int level, const bool shuffle=true){deflate_=level;shuffle_=shuffle;}
+
+            ///@brief current extents of the variable in the file
+            std::vector<size_t> shape()const override{return currentExtents();}
+
         private:
             void parentHook();
 
-            void setUpVariable(const std::vector<size_t> &extents);
+            void setUpVariable(const core::HyperSlabBase<T> &hslab);
+
+            std::vector<size_t> currentExtents()const;
 
             size_t ndim_ = 1;
             //supports variables with up to 10 dimensions..
             std::vector<int> dimids{};
+            std::vector<size_t> extents_{};
+            std::vector<size_t> chunks_{};
+            int deflate_=0;
+            bool shuffle_=false;
 
         };
 
@@ -180,34 +196,37 @@ namespace frommle {
 
         }
 
+        ///@brief writes (part of) a variable, the offset, shape and stride of the hyperslab determine where the (contiguous) data ends up
         template<class T>
         void NetCDFVariable<T>::setValue(const core::HyperSlabBase<T> &hslab) {
-            setUpVariable(hslab.extents());
-            NetCDFCheckerror(nc_put_var(ncparent_->id(), id_, hslab.data()));
+            if (id_ == -1) {
+                setUpVariable(hslab);
+            }
 
+            if (hslab.ndim() != ndim_){
+                THROWINPUTEXCEPTION("hyperslab dimension does not agree with netcdf variable");
+            }
+            NetCDFCheckerror(nc_put_vars(ncparent_->id(), id_, hslab.offset().data(),hslab.shape().data(),hslab.stride().data(), hslab.data()));
 
         }
 
         template<class T>
         void NetCDFVariable<T>::getValue(core::HyperSlabBase<T> &hslab)const {
 
-            std::vector<size_t> extents(ndim_,0);
-            for(auto &did:dimids){
-                NetCDFCheckerror(nc_inq_dimlen(ncparent_->id(),did,&extents[did]));
-            }
+            std::vector<size_t> extents=currentExtents();
 
             //let's check if the hyperslab has already data
             if (!hslab.data()){
                 //create new hyperslab (with data allocated internally)
                 hslab=core::HyperSlab<T>(extents);
             }else{
-                //currently  we need to check whether the internal extents are the same as the extents from the hyperslab
+                //check whether the hyperslab fits within the netcdf variable
                 if (hslab.ndim() != ndim_){
                     THROWINPUTEXCEPTION("hyperslab dimension does not agree with netcdf variable");
                 }
                 for(int i=0;i<ndim_;++i){
-                    if(extents[i] != hslab.shape(i)){
-                        THROWINPUTEXCEPTION("Shape of requested hyperslab does not agree with shape of the netcdf variable");
+                    if(hslab.shape()[i] > 0 and hslab.offset()[i]+(hslab.shape()[i]-1)*hslab.stride()[i] >= extents[i]){
+                        THROWINPUTEXCEPTION("Requested hyperslab exceeds the shape of the netcdf variable");
 
                     }
                 }
@@ -216,15 +235,36 @@ namespace frommle {
             NetCDFCheckerror(nc_get_vars(ncparent_->id(), id_, hslab.offset().data(),hslab.shape().data(),hslab.stride().data(), hslab.data()));
         }
 
+        ///@brief retrieve the current length of the dimensions of the variable from the file
+        template<class T>
+        std::vector<size_t> NetCDFVariable<T>::currentExtents()const {
+            std::vector<size_t> extents(ndim_,0);
+            for(int i=0;i<ndim_;++i){
+                NetCDFCheckerror(nc_inq_dimlen(ncparent_->id(),dimids[i],&extents[i]));
+            }
+            return extents;
+        }
+
 
         template<class T>
-        void NetCDFVariable<T>::setUpVariable(const std::vector<size_t> &extents) {
+        void NetCDFVariable<T>::setUpVariable(const core::HyperSlabBase<T> &hslab) {
 
             if (writable()) {
                 //dynamically set number of dimensions
-                ndim_ = extents.size();
+                ndim_ = hslab.ndim();
                 dimids = std::vector<int>(ndim_, -1);
 
+                std::vector<size_t> extents=extents_;
+                if (extents.empty()){
+                    //derive the extents from the first hyperslab which is written
+                    for (int i = 0; i < ndim_; ++i) {
+                        const size_t cnt=hslab.shape()[i];
+                        extents.push_back((cnt == 0)?0:hslab.offset()[i]+(cnt-1)*hslab.stride()[i]+1);
+                    }
+                }else if (extents.size() != ndim_){
+                    THROWINPUTEXCEPTION("Extents of the netcdf variable do not agree with the dimension of the hyperslab");
+                }
+
                 //create/reuse dimensions from parent
                 for (int i = 0; i < ndim_; ++i) {
                     std::string fallback(name());
@@ -234,8 +274,13 @@ namespace frommle {
                             fallback += std::to_string(i);
                         }
 
-                        //tryto find a dimension which ahs the same size
-                        dimids[i] = ncparent_->getdimid(extents[i]);
+                        if (extents[i] == NC_UNLIMITED){
+                            //unlimited dimensions can only be matched by name
+                            dimids[i] = ncparent_->getdimid(fallback);
+                        }else{
+                            //tryto find a dimension which ahs the same size
+                            dimids[i] = ncparent_->getdimid(extents[i]);
+                        }
 
                     } else {
                         fallback = (attr().template get<std::vector<std::string> >(
@@ -257,6 +302,18 @@ namespace frommle {
                 NetCDFCheckerror(
                         nc_def_var(ncparent_->id(), name().c_str(), NetCDFtype<T>::type(), ndim_, dimids.data(),
                                    &id_));
+
+                //storage settings (need to be set before any data is written)
+                if (!chunks_.empty()) {
+                    if (chunks_.size() != ndim_){
+                        THROWINPUTEXCEPTION("Chunk shape does not agree with the dimension of the netcdf variable");
+                    }
+                    NetCDFCheckerror(nc_def_var_chunking(ncparent_->id(), id_, NC_CHUNKED, chunks_.data()));
+                }
+
+                if (deflate_ > 0 or shuffle_) {
+                    NetCDFCheckerror(nc_def_var_deflate(ncparent_->id(), id_, shuffle_?1:0, (deflate_ > 0)?1:0, deflate_));
+                }
                 //also setup attributes
 //                CF::setVarAttr(*this);
 
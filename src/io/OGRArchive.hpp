@@ -50,6 +50,8 @@ namespace frommle {
 			OGRSpatialReference *getOGRspatialRef();;
 
 			OGRLayer* loadLayer(const std::string & layername);
+			///@brief the underlying GDAL dataset (e.g. to manage transactions)
+			GDALDataset * getDataset()const{return poDS;}
 			OGRLayer * createLayer(const std::string & layername, const OGRwkbGeometryType geotype=wkbUnknown);
 
 //			virtual core::TreeNodeRef & operator[](const std::string & name){
@@ -20,6 +20,10 @@
 #include "io/OGRIOArchives.hpp"
 #include "io/OGRArchive.hpp"
 #include "core/Exceptions.hpp"
+#include "core/Logging.hpp"
+#include <algorithm>
+#include <cstring>
+#include <limits>
 namespace frommle{
     namespace io{
 
@@ -172,9 +176,7 @@ OGRSpatialReference *OGRGroup::getOGRspatialRef()const{
                if (idx != -1 and currentFeat->GetFID() == idx){return currentFeat;}
 
                 if (writable()){
-                    if( layer_->CreateFeature(currentFeat) != OGRERR_NONE){
-                        throw core::IOException("Cannot set feature in GDAl data source");
-                    }
+                    createFeature(currentFeat,transactionSize_);
                 }
 //                if(writable()) {
 //                    layer_->SetFeature(currentFeat);
@@ -246,17 +248,470 @@ OGRSpatialReference *OGRGroup::getOGRspatialRef()const{
         }
 
         OGRGroup::~OGRGroup() {
-            if(currentFeat and layer_ and writable()){
+            releaseArrowStream();
+            if(layer_ and writable()){
                 //write the last feature if it is still opened
-//                auto geom=currentFeat->GetGeometryRef();
-//                char ** wkt=new char*;
-//                geom->exportToWkt(wkt);
-                layer_->CreateFeature(currentFeat);
-                OGRFeature::DestroyFeature(currentFeat);
+                try{
+                    flush();
+                }catch(const std::exception & excep){
+                    LOGERROR << "Failed to write remaining features to layer "<<name()<<": "<<excep.what()<<std::endl;
+                }
                 layer_->SyncToDisk();
             }
         }
 
+        void OGRGroup::flush() {
+            if (currentFeat and writable()){
+                createFeature(currentFeat,transactionSize_);
+                OGRFeature::DestroyFeature(currentFeat);
+                currentFeat=nullptr;
+            }
+            commitTransaction();
+        }
+
+        GDALDataset * OGRGroup::getDataset() const {
+            auto par=dynamic_cast<const OGRArchive*>(getParent());
+            return par?par->getDataset():nullptr;
+        }
+
+        void OGRGroup::createFeature(OGRFeature *feat, const size_t ntransact) {
+            if (transaction_ == 0 and ntransact > 0){
+                //start a new transaction (prefer dataset transactions as e.g. GeoPackage only supports those)
+                auto ds=getDataset();
+                if (ds and ds->TestCapability(ODsCTransactions) and ds->StartTransaction() == OGRERR_NONE){
+                    transaction_=1;
+                }else if(layer_->TestCapability(OLCTransactions) and layer_->StartTransaction() == OGRERR_NONE){
+                    transaction_=2;
+                }
+            }
+
+            if( layer_->CreateFeature(feat) != OGRERR_NONE){
+                //don't leave a partial transaction behind which would be committed later on
+                rollbackTransaction();
+                throw core::IOException("Cannot set feature in GDAl data source");
+            }
+
+            if (transaction_ != 0 and ++ntransact_ >= ntransact){
+                commitTransaction();
+            }
+        }
+
+        void OGRGroup::rollbackTransaction() {
+            OGRErr err=OGRERR_NONE;
+            if (transaction_ == 1){
+                err=getDataset()->RollbackTransaction();
+            }else if (transaction_ == 2){
+                err=layer_->RollbackTransaction();
+            }
+            transaction_=0;
+            ntransact_=0;
+            if (err != OGRERR_NONE){
+                LOGERROR << "Cannot roll back transaction of layer "<<name()<<std::endl;
+            }
+        }
+
+        void OGRGroup::commitTransaction() {
+            OGRErr err=OGRERR_NONE;
+            if (transaction_ == 1){
+                err=getDataset()->CommitTransaction();
+            }else if (transaction_ == 2){
+                err=layer_->CommitTransaction();
+            }
+            transaction_=0;
+            ntransact_=0;
+            if (err != OGRERR_NONE){
+                throw core::IOException("Cannot commit transaction to GDAL data source");
+            }
+        }
+
+        void OGRGroup::writeBatch(const OGRBatch &batch) {
+            if (!writable()){
+                throw core::IOException("Archive not opened for writing");
+            }
+            //write a pending single feature first, so fields can still be created
+            if (currentFeat){
+                createFeature(currentFeat,transactionSize_);
+                OGRFeature::DestroyFeature(currentFeat);
+                currentFeat=nullptr;
+            }
+
+            const size_t nfeat=batch.size();
+            std::vector<int> fieldids;
+            fieldids.reserve(batch.columns.size());
+            for(const auto & col:batch.columns){
+                if (col.size() != nfeat){
+                    throw core::InputException("Column "+col.name+" does not have the same length as the geometries");
+                }
+                OGRFieldDefn fielddef(col.name.c_str(),col.type);
+                fieldids.push_back(getField(&fielddef));
+            }
+
+            //reuse a single feature for all entries
+            std::unique_ptr<OGRFeature,void(*)(OGRFeature*)> feat(OGRFeature::CreateFeature(layerdef_),OGRFeature::DestroyFeature);
+            for(size_t i=0;i<nfeat;++i){
+                feat->SetFID(OGRNullFID);
+                feat->SetGeometryDirectly(batch.geometry(i).release());
+                for(size_t ic=0;ic<batch.columns.size();++ic){
+                    const auto & col=batch.columns[ic];
+                    if (col.isInteger()){
+                        feat->SetField(fieldids[ic],static_cast<GIntBig>(col.ivals[i]));
+                    }else if(col.isReal()){
+                        feat->SetField(fieldids[ic],col.dvals[i]);
+                    }else{
+                        feat->SetField(fieldids[ic],col.getString(i).c_str());
+                    }
+                }
+                createFeature(feat.get(),batchTransactionSize_);
+            }
+        }
+
+        size_t OGRGroup::readBatch(OGRBatch &batch, const size_t nmax) {
+            if (!layer_){
+                throw core::IOException("No layer is opened");
+            }
+            batch.clear();
+            size_t nread=0;
+            if (readBatchArrow(batch,nmax,nread)){
+                return nread;
+            }
+            return readBatchFeatures(batch,nmax);
+        }
+
+        size_t OGRGroup::readBatchFeatures(OGRBatch &batch, const size_t nmax) {
+            const size_t nfields=layerdef_->GetFieldCount();
+            if (batch.columns.size() != nfields){
+                batch.columns.clear();
+                for(size_t i=0;i<nfields;++i){
+                    auto fdef=layerdef_->GetFieldDefn(i);
+                    auto type=fdef->GetType();
+                    if (type != OFTInteger and type != OFTInteger64 and type != OFTReal){
+                        //other types are converted to strings
+                        type=OFTString;
+                    }
+                    batch.columns.emplace_back(fdef->GetNameRef(),type);
+                }
+            }
+
+            size_t nread=0;
+            while(nread < nmax){
+                std::unique_ptr<OGRFeature,void(*)(OGRFeature*)> feat(layer_->GetNextFeature(),OGRFeature::DestroyFeature);
+                if (!feat){
+                    break;
+                }
+                batch.fids.push_back(feat->GetFID());
+                batch.pushGeometry(feat->GetGeometryRef());
+                for(size_t i=0;i<nfields;++i){
+                    auto & col=batch.columns[i];
+                    if (col.isInteger()){
+                        col.ivals.push_back(feat->GetFieldAsInteger64(i));
+                    }else if(col.isReal()){
+                        col.dvals.push_back(feat->IsFieldSetAndNotNull(i)?feat->GetFieldAsDouble(i):std::numeric_limits<double>::quiet_NaN());
+                    }else{
+                        const char * str=feat->GetFieldAsString(i);
+                        col.pushString(str,std::strlen(str));
+                    }
+                }
+                ++nread;
+            }
+            return nread;
+        }
+
+        void OGRGroup::releaseArrowStream() {
+            arrowbatch_.reset();
+            arrowpos_=0;
+            arrowschema_.reset();
+            arrowstream_.reset();
+        }
+
+#ifdef GDAL_COMPUTE_VERSION
+#if GDAL_VERSION_NUM >= GDAL_COMPUTE_VERSION(3,6,0)
+#define FROMMLE_OGR_ARROW
+#endif
+#endif
+
+#ifdef FROMMLE_OGR_ARROW
+        ///@brief returns whether entry i of an Arrow array is valid (not null)
+        static bool arrowValid(const ArrowArray * arr, const int64_t i){
+            auto validity=static_cast<const uint8_t*>(arr->buffers[0]);
+            return !validity or ((validity[i/8] >> (i%8)) & 1);
+        }
+
+        ///@brief copy the variable length entries of an Arrow (large) utf8/binary array
+        template<class Offset, class F>
+        static void arrowVarBinary(const ArrowArray * arr, const int64_t start, const int64_t n, F && f){
+            auto offsets=static_cast<const Offset*>(arr->buffers[1]);
+            auto data=static_cast<const char*>(arr->buffers[2]);
+            for(int64_t i=start;i<start+n;++i){
+                if (arrowValid(arr,i)){
+                    f(data+offsets[i],static_cast<size_t>(offsets[i+1]-offsets[i]));
+                }else{
+                    f(data,0);
+                }
+            }
+        }
+
+        template<class T, class Vec>
+        static void arrowPrimitive(const ArrowArray * arr, const int64_t start, const int64_t n, Vec & vec, const typename Vec::value_type nullval){
+            auto values=static_cast<const T*>(arr->buffers[1]);
+            for(int64_t i=start;i<start+n;++i){
+                vec.push_back(arrowValid(arr,i)?static_cast<typename Vec::value_type>(values[i]):nullval);
+            }
+        }
+
+        ///@brief copy the entries of a (bit packed) Arrow boolean array as integers
+        template<class Vec>
+        static void arrowBoolean(const ArrowArray * arr, const int64_t start, const int64_t n, Vec & vec){
+            auto bits=static_cast<const uint8_t*>(arr->buffers[1]);
+            for(int64_t i=start;i<start+n;++i){
+                vec.push_back(arrowValid(arr,i)?((bits[i/8] >> (i%8)) & 1):0);
+            }
+        }
+
+        ///@brief column type of an Arrow format string (OFTMaxType when the feature path would convert the field to a string)
+        static OGRFieldType arrowFieldType(const std::string & fmt){
+            if (fmt == "i" or fmt == "s" or fmt == "c" or fmt == "b"){
+                return OFTInteger;
+            }else if(fmt == "l"){
+                return OFTInteger64;
+            }else if(fmt == "g" or fmt == "f"){
+                return OFTReal;
+            }else if(fmt == "u" or fmt == "U"){
+                return OFTString;
+            }
+            return OFTMaxType;
+        }
+#endif
+
+        bool OGRGroup::readBatchArrow(OGRBatch &batch, const size_t nmax, size_t & nread) {
+#ifdef FROMMLE_OGR_ARROW
+            if (arrowstate_ == 0){
+                return false;
+            }
+            if (arrowstate_ == 2){
+                nread=0;
+                return true;
+            }
+
+            std::string fidname=layer_->GetFIDColumn();
+            if (fidname.empty()){
+                fidname="OGC_FID";
+            }
+            std::string geomname=layer_->GetGeometryColumn();
+            if (geomname.empty()){
+                geomname="wkb_geometry";
+            }
+
+            if (arrowstate_ == -1){
+                if (!layer_->TestCapability(OLCFastGetArrowStream)){
+                    arrowstate_=0;
+                    return false;
+                }
+                auto stream=std::shared_ptr<ArrowArrayStream>(new ArrowArrayStream{},[](ArrowArrayStream * strm){
+                    if(strm->release){
+                        strm->release(strm);
+                    }
+                    delete strm;
+                });
+                //note: the batch size is only a hint, as later calls may request less features
+                const std::string maxfeat="MAX_FEATURES_IN_BATCH="+std::to_string(nmax);
+                const char * options[]={maxfeat.c_str(),"INCLUDE_FID=YES",nullptr};
+                layer_->ResetReading();
+                if (!layer_->GetArrowStream(stream.get(),const_cast<char**>(options))){
+                    arrowstate_=0;
+                    return false;
+                }
+                auto schema=std::shared_ptr<ArrowSchema>(new ArrowSchema{},[](ArrowSchema * sch){
+                    if(sch->release){
+                        sch->release(sch);
+                    }
+                    delete sch;
+                });
+                if (stream->get_schema(stream.get(),schema.get()) != 0){
+                    throw core::IOException("Cannot retrieve the Arrow schema of the layer");
+                }
+                //fields which are not integer, real or string are converted to strings when reading features one by one
+                for(int64_t ic=0;ic<schema->n_children;++ic){
+                    const std::string name=schema->children[ic]->name;
+                    if (name != fidname and name != geomname and arrowFieldType(schema->children[ic]->format) == OFTMaxType){
+                        arrowstate_=0;
+                        stream.reset();
+                        layer_->ResetReading();
+                        return false;
+                    }
+                }
+                arrowstream_=stream;
+                arrowschema_=schema;
+                arrowstate_=1;
+            }
+
+            auto stream=static_cast<ArrowArrayStream*>(arrowstream_.get());
+            while (!arrowbatch_){
+                auto array=std::shared_ptr<ArrowArray>(new ArrowArray{},[](ArrowArray * arr){
+                    if(arr->release){
+                        arr->release(arr);
+                    }
+                    delete arr;
+                });
+                if (stream->get_next(stream,array.get()) != 0){
+                    throw core::IOException("Cannot retrieve the next Arrow batch of the layer");
+                }
+                if (!array->release){
+                    //end of the stream
+                    arrowstate_=2;
+                    releaseArrowStream();
+                    nread=0;
+                    return true;
+                }
+                if (array->length > 0){
+                    arrowbatch_=array;
+                    arrowpos_=0;
+                }
+            }
+            const ArrowSchema & schema=*static_cast<ArrowSchema*>(arrowschema_.get());
+            const ArrowArray & array=*static_cast<ArrowArray*>(arrowbatch_.get());
+
+            //the Arrow batch is consumed in slices of at most nmax features
+            const int64_t n=std::min(static_cast<int64_t>(nmax),array.length-arrowpos_);
+
+            //set up the columns upon the first call
+            if (batch.columns.empty()){
+                for(int64_t ic=0;ic<schema.n_children;++ic){
+                    const std::string name=schema.children[ic]->name;
+                    if (name == fidname or name == geomname){
+                        continue;
+                    }
+                    batch.columns.emplace_back(name,arrowFieldType(schema.children[ic]->format));
+                }
+            }
+
+            for(int64_t ic=0;ic<schema.n_children;++ic){
+                const std::string name=schema.children[ic]->name;
+                const std::string fmt=schema.children[ic]->format;
+                const ArrowArray * child=array.children[ic];
+                //note: the offset of the struct array applies to the children as well
+                const int64_t start=array.offset+child->offset+arrowpos_;
+                if (name == fidname and fmt == "l"){
+                    arrowPrimitive<int64_t>(child,start,n,batch.fids,-1);
+                    continue;
+                }
+                if (name == geomname){
+                    auto pushwkb=[&batch](const char * data, const size_t len){
+                        batch.wkb.insert(batch.wkb.end(),data,data+len);
+                        batch.wkboffsets.push_back(batch.wkb.size());
+                    };
+                    if (fmt == "z"){
+                        arrowVarBinary<int32_t>(child,start,n,pushwkb);
+                    }else if(fmt == "Z"){
+                        arrowVarBinary<int64_t>(child,start,n,pushwkb);
+                    }
+                    continue;
+                }
+                const int icol=batch.columnIndex(name);
+                if (icol < 0){
+                    continue;
+                }
+                auto & col=batch.columns[icol];
+                if (fmt == "i"){
+                    arrowPrimitive<int32_t>(child,start,n,col.ivals,0);
+                }else if(fmt == "s"){
+                    arrowPrimitive<int16_t>(child,start,n,col.ivals,0);
+                }else if(fmt == "c"){
+                    arrowPrimitive<int8_t>(child,start,n,col.ivals,0);
+                }else if(fmt == "b"){
+                    arrowBoolean(child,start,n,col.ivals);
+                }else if(fmt == "l"){
+                    arrowPrimitive<int64_t>(child,start,n,col.ivals,0);
+                }else if(fmt == "g"){
+                    arrowPrimitive<double>(child,start,n,col.dvals,std::numeric_limits<double>::quiet_NaN());
+                }else if(fmt == "f"){
+                    arrowPrimitive<float>(child,start,n,col.dvals,std::numeric_limits<double>::quiet_NaN());
+                }else if(fmt == "u"){
+                    arrowVarBinary<int32_t>(child,start,n,[&col](const char * data, const size_t len){col.pushString(data,len);});
+                }else if(fmt == "U"){
+                    arrowVarBinary<int64_t>(child,start,n,[&col](const char * data, const size_t len){col.pushString(data,len);});
+                }
+            }
+
+            //layers without geometry or fid column
+            while(batch.wkboffsets.size() < static_cast<size_t>(n)+1){
+                batch.wkboffsets.push_back(batch.wkb.size());
+            }
+            while(batch.fids.size() < static_cast<size_t>(n)){
+                batch.fids.push_back(-1);
+            }
+
+            arrowpos_+=n;
+            if (arrowpos_ >= array.length){
+                arrowbatch_.reset();
+            }
+            nread=n;
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        size_t OGRColumn::size() const {
+            if (isInteger()){
+                return ivals.size();
+            }else if (isReal()){
+                return dvals.size();
+            }
+            return soffsets.size()-1;
+        }
+
+        void OGRColumn::pushString(const char *str, const size_t len) {
+            svals.insert(svals.end(),str,str+len);
+            soffsets.push_back(svals.size());
+        }
+
+        void OGRColumn::clear() {
+            ivals.clear();
+            dvals.clear();
+            svals.clear();
+            soffsets.assign(1,0);
+        }
+
+        void OGRBatch::pushGeometry(const OGRGeometry *geom) {
+            if (geom){
+                const size_t nbytes=geom->WkbSize();
+                const size_t off=wkb.size();
+                wkb.resize(off+nbytes);
+                geom->exportToWkb(wkbNDR,wkb.data()+off,wkbVariantIso);
+            }
+            wkboffsets.push_back(wkb.size());
+        }
+
+        std::unique_ptr<OGRGeometry> OGRBatch::geometry(const size_t i) const {
+            const size_t nbytes=wkboffsets.at(i+1)-wkboffsets[i];
+            if (nbytes == 0){
+                return std::unique_ptr<OGRGeometry>();
+            }
+            OGRGeometry * geom=nullptr;
+            if (OGRGeometryFactory::createFromWkb(const_cast<unsigned char*>(wkb.data()+wkboffsets[i]),nullptr,&geom,nbytes,wkbVariantIso) != OGRERR_NONE){
+                throw core::IOException("Cannot create geometry from WKB");
+            }
+            return std::unique_ptr<OGRGeometry>(geom);
+        }
+
+        int OGRBatch::columnIndex(const std::string &name) const {
+            for(size_t i=0;i<columns.size();++i){
+                if (columns[i].name == name){
+                    return i;
+                }
+            }
+            return -1;
+        }
+
+        void OGRBatch::clear() {
+            fids.clear();
+            wkb.clear();
+            wkboffsets.assign(1,0);
+            for(auto & col:columns){
+                col.clear();
+            }
+        }
+
 
         std::string GDALPOSTGISSource(const std::string PGname, const std::string schemas) {
             using us=core::UserSettings;
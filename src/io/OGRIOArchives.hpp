@@ -21,7 +21,10 @@
 #include "core/Singleton.hpp"
 #include "core/UserSettings.hpp"
 #include <ogrsf_frmts.h>
+#include <cstdint>
 #include <string>
+#include <vector>
+#include <memory>
 //#include "geometry/OGRiteratorBase.hpp"
 #include "io/Group.hpp"
 #include "io/Variable.hpp"
@@ -138,6 +141,47 @@ namespace frommle{
 
 
 
+        ///@brief column of attribute values of a batch of features (integers, reals or strings, depending on the type)
+        struct OGRColumn{
+            OGRColumn(){}
+            OGRColumn(const std::string & fieldname, const OGRFieldType fieldtype):name(fieldname),type(fieldtype){}
+            std::string name{};
+            OGRFieldType type=OFTString;
+            ///@brief values of OFTInteger and OFTInteger64 fields
+            std::vector<long long int> ivals{};
+            ///@brief values of OFTReal fields
+            std::vector<double> dvals{};
+            ///@brief concatenated characters of string fields and the offsets (size()+1 entries) of the individual strings
+            std::vector<char> svals{};
+            std::vector<size_t> soffsets{0};
+            bool isInteger()const{return type == OFTInteger or type == OFTInteger64;}
+            bool isReal()const{return type == OFTReal;}
+            size_t size()const;
+            std::string getString(const size_t i)const{return std::string(svals.data()+soffsets[i],soffsets[i+1]-soffsets[i]);}
+            void pushString(const char * str, const size_t len);
+            void clear();
+        };
+
+        /*!@brief Column oriented storage of a batch of features
+         * Geometries are stored contiguously as well known binary (WKB), and attribute fields are stored as columns
+         */
+        struct OGRBatch{
+            std::vector<long long int> fids{};
+            std::vector<unsigned char> wkb{};
+            ///@brief offsets of the geometries in the wkb buffer (size()+1 entries)
+            std::vector<size_t> wkboffsets{0};
+            std::vector<OGRColumn> columns{};
+            size_t size()const{return wkboffsets.size()-1;}
+            ///@brief append a geometry (a null pointer results in an empty entry)
+            void pushGeometry(const OGRGeometry * geom);
+            ///@brief create a geometry from its WKB representation (returns nullptr for empty entries)
+            std::unique_ptr<OGRGeometry> geometry(const size_t i)const;
+            ///@brief find the index of a column by name (returns -1 when not found)
+            int columnIndex(const std::string & name)const;
+            ///@brief clear the content but keep the columns definitions (and allocated memory)
+            void clear();
+        };
+
         ///@brief an OGRGroup points to a certain layer in an GDAL data source
         class OGRGroup : public Group {
         public:
@@ -164,16 +208,70 @@ namespace frommle{
             const OGRFeature *getFeature(const ptrdiff_t idx = -1) const;
 
             core::TreeNodeRef convertChild(core::TreeNodeRef &&in);
+
+            /*!@brief read up to nmax features into the column buffers of batch (returns the number of features read, 0 at the end of the layer)
+             * The GDAL Arrow stream interface is used when the driver supports it (GDAL >= 3.6), otherwise features are read one by one
+             * Integer and real fields are read as such and all other fields as strings, the Arrow stream is only used when it holds no other field types
+             */
+            size_t readBatch(OGRBatch & batch, const size_t nmax=65536);
+
+            ///@brief enable (default) or disable the Arrow stream of readBatch, call this before reading (e.g. to compare it with the per-feature path)
+            void setArrowStream(const bool use){
+                releaseArrowStream();
+                arrowstate_=use?-1:0;
+            }
+            ///@brief whether readBatch currently reads from the Arrow stream
+            bool arrowStream()const{return arrowstate_ > 0;}
+
+            /*!@brief append a batch of features (missing attribute fields are created)
+             * The features are written within transactions of batchTransactionSize() features
+             */
+            void writeBatch(const OGRBatch & batch);
+
+            /*!@brief set the number of single features (written through getFeature) within a transaction (0, the default, disables transactions)
+             * Transactions are only used when the data source or layer supports them
+             */
+            void setTransactionSize(const size_t ntransact){transactionSize_=ntransact;}
+            size_t transactionSize()const{return transactionSize_;}
+
+            ///@brief set the number of features which writeBatch writes within a single transaction (default 20000, 0 disables transactions)
+            void setBatchTransactionSize(const size_t ntransact){batchTransactionSize_=ntransact;}
+            size_t batchTransactionSize()const{return batchTransactionSize_;}
+
+            ///@brief write pending features and commit the open transaction
+            void flush();
         private:
             void loadCollection();
 
             void parentHook();
 
+            ///@brief write a feature to the layer (within transactions of ntransact features, 0 writes it directly)
+            void createFeature(OGRFeature * feat, const size_t ntransact);
+            void commitTransaction();
+            ///@brief discard the features of the open transaction
+            void rollbackTransaction();
+            GDALDataset * getDataset()const;
+            size_t readBatchFeatures(OGRBatch & batch, const size_t nmax);
+            bool readBatchArrow(OGRBatch & batch, const size_t nmax, size_t & nread);
+            void releaseArrowStream();
 
             OGRLayer *layer_ = nullptr;
             OGRFeatureDefn *layerdef_ = nullptr;
             OGRFeature *currentFeat = nullptr;
 
+            size_t transactionSize_=0;
+            size_t batchTransactionSize_=20000;
+            size_t ntransact_=0;
+            ///@brief 0: no transaction, 1: dataset transaction, 2: layer transaction
+            int transaction_=0;
+            ///@brief state of the Arrow stream (-1: not tried, 0: unsupported, 1: open, 2: exhausted)
+            int arrowstate_=-1;
+            std::shared_ptr<void> arrowstream_{};
+            std::shared_ptr<void> arrowschema_{};
+            ///@brief Arrow batch which is not completely consumed yet, and the position of the next feature in it
+            std::shared_ptr<void> arrowbatch_{};
+            int64_t arrowpos_=0;
+
             bool readlayer();
 
             bool createlayer();
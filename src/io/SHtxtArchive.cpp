@@ -0,0 +1,413 @@
+/*! \file SHtxtArchive.cpp
+ \brief Implementation of the spherical harmonic text file readers
+ \copyright Roelof Rietbroek 2021
+ \license
+ This file is part of Frommle.
+ frommle is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3 of the License, or (at your option) any later version.
+
+ Frommle is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with Frommle; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "io/SHtxtArchive.hpp"
+#include "core/Exceptions.hpp"
+#include "core/Logging.hpp"
+#include "yaml-cpp/yaml.h"
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+namespace frommle{
+    namespace io{
+
+        ///@brief small hand-written scanner which extracts whitespace separated fields from a line without copying it
+        class FieldScanner{
+        public:
+            FieldScanner(const char * line):c_(line){}
+
+            ///@brief returns true when the line starts with the given key (followed by whitespace)
+            static bool startsWith(const char * line, const char * key){
+                const size_t nkey=std::strlen(key);
+                return std::strncmp(line,key,nkey) == 0 and (line[nkey] == '\0' or isWhite(line[nkey]));
+            }
+
+            ///@brief skip the next field
+            FieldScanner & skip(){
+                skipWhite();
+                while(*c_ != '\0' and !isWhite(*c_)){
+                    ++c_;
+                }
+                return *this;
+            }
+
+            ///@brief returns true when there are more fields in the line
+            bool more(){
+                skipWhite();
+                return *c_ != '\0';
+            }
+
+            int getInt(){
+                skipWhite();
+                bool neg=false;
+                if(*c_ == '-' or *c_ == '+'){
+                    neg=(*c_ == '-');
+                    ++c_;
+                }
+                if(!isDigit(*c_)){
+                    THROWIOEXCEPTION(std::string("Cannot parse integer from line: ")+line_());
+                }
+                int val=0;
+                while(isDigit(*c_)){
+                    val=10*val+(*c_-'0');
+                    ++c_;
+                }
+                return neg?-val:val;
+            }
+
+            double getDouble(){
+                skipWhite();
+                const char * start=c_;
+                //find the end of the field and check for Fortran style exponents
+                const char * dexp=nullptr;
+                while(*c_ != '\0' and !isWhite(*c_)){
+                    if(*c_ == 'D' or *c_ == 'd'){
+                        dexp=c_;
+                    }
+                    ++c_;
+                }
+                if(start == c_){
+                    THROWIOEXCEPTION(std::string("Cannot parse a floating point value from line: ")+line_());
+                }
+                char * end=nullptr;
+                double val;
+                if(dexp){
+                    //copy the field and replace the exponent character
+                    std::string field(start,c_);
+                    field[dexp-start]='e';
+                    val=std::strtod(field.c_str(),&end);
+                    if(end != field.c_str()+field.size()){
+                        THROWIOEXCEPTION(std::string("Cannot parse a floating point value from field: ")+field);
+                    }
+                }else{
+                    //note: strtod stops at the whitespace following the field
+                    val=std::strtod(start,&end);
+                    if(end != c_){
+                        THROWIOEXCEPTION(std::string("Cannot parse a floating point value from field: ")+std::string(start,c_));
+                    }
+                }
+                return val;
+            }
+
+            ///@brief retrieve the next field as a string
+            std::string getString(){
+                skipWhite();
+                const char * start=c_;
+                skip();
+                return std::string(start,c_);
+            }
+
+        private:
+            const char * c_=nullptr;
+            static inline bool isWhite(const char c){return c == ' ' or c == '\t' or c == '\r' or c == '\n';}
+            static inline bool isDigit(const char c){return c >= '0' and c <= '9';}
+            inline void skipWhite(){
+                while(isWhite(*c_)){
+                    ++c_;
+                }
+            }
+            std::string line_()const{return std::string(c_);}
+        };
+
+        ///@brief reject degrees and orders which don't describe a valid coefficient (they would index outside of the coefficient arrays)
+        static void checkDegreeOrder(const int n, const int m, const char * line){
+            if(n < 0 or m < 0 or m > n){
+                THROWINPUTEXCEPTION(std::string("Invalid degree and order in spherical harmonic line: ")+line);
+            }
+        }
+
+        static bool isGzipped(const std::string & filename){
+            return filename.size() > 3 and filename.compare(filename.size()-3,3,".gz") == 0;
+        }
+
+        SHtxtArchive::SHtxtArchive(const std::string &filename, const SHtxtFormat format, const int nmax):ArchiveBase(filename,"r"),nmax_(nmax) {
+            load(filename,format);
+        }
+
+        SHtxtArchive::SHtxtArchive(const std::string &filename, const int nmax):ArchiveBase(filename,"r"),nmax_(nmax) {
+            load(filename,guessFormat(filename));
+        }
+
+        SHtxtFormat SHtxtArchive::guessFormat(const std::string &filename) {
+            LineBuffer lbuf(filename,isGzipped(filename));
+            int nlines=0;
+            for(auto it=lbuf.begin();it != lbuf.end() and nlines < 100;++it,++nlines){
+                const char * ln=it.line();
+                if(nlines == 0 and FieldScanner::startsWith(ln,"META")){
+                    return SHtxtFormat::standard;
+                }else if(FieldScanner::startsWith(ln,"header:")){
+                    return SHtxtFormat::GSMv6;
+                }else if(FieldScanner::startsWith(ln,"begin_of_head") or FieldScanner::startsWith(ln,"end_of_head")){
+                    return SHtxtFormat::icgem;
+                }
+            }
+            THROWIOEXCEPTION("Cannot determine the format of the spherical harmonic file "+filename);
+        }
+
+        void SHtxtArchive::load(const std::string &filename, const SHtxtFormat format) {
+            LineBuffer lbuf(filename,isGzipped(filename));
+            switch(format){
+                case SHtxtFormat::icgem:
+                    loadICGEM(lbuf);
+                    break;
+                case SHtxtFormat::GSMv6:
+                    loadGSMv6(lbuf);
+                    break;
+                case SHtxtFormat::standard:
+                    loadStandard(lbuf);
+                    break;
+            }
+        }
+
+        void SHtxtArchive::allocate(const int nmaxfile) {
+            attr().set("nmaxfile",nmaxfile);
+            if (nmax_ < 0){
+                nmax_=nmaxfile;
+            }else if (nmax_ > nmaxfile){
+                LOGWARNING << "nmax requested larger than supported, higher degree coefficients will be set to zero"<<std::endl;
+            }
+            attr().set("nmax",nmax_);
+
+            guides::GuidePackDyn<1> gp{guides::SHnmtGuide(nmax_)};
+            cnm_=std::make_shared<garr_t>(gp,"cnm");
+            sigcnm_=std::make_shared<garr_t>(gp,"sigcnm");
+            std::fill(cnm_->mat().data(),cnm_->mat().data()+cnm_->mat().num_elements(),0.0);
+            std::fill(sigcnm_->mat().data(),sigcnm_->mat().data()+sigcnm_->mat().num_elements(),0.0);
+        }
+
+        void SHtxtArchive::loadICGEM(LineBuffer &lbuf) {
+            auto it=lbuf.begin();
+            //parse the name value pairs from the header
+            int nmaxfile=-1;
+            std::string format("icgem");
+            for(;it != lbuf.end();++it){
+                const char * ln=it.line();
+                if(FieldScanner::startsWith(ln,"end_of_head")){
+                    ++it;
+                    break;
+                }
+                FieldScanner scan(ln);
+                if(!scan.more()){
+                    continue;
+                }
+                std::string key=scan.getString();
+                if(!scan.more()){
+                    continue;
+                }
+                std::string val=scan.getString();
+                if(scan.more()){
+                    //only consider lines with name value pairs
+                    continue;
+                }
+                if(key == "max_degree"){
+                    nmaxfile=std::stoi(val);
+                }else if(key == "format"){
+                    format=val;
+                }else if(key == "earth_gravity_constant"){
+                    attr().set("gm",FieldScanner(val.c_str()).getDouble());
+                }else if(key == "radius"){
+                    attr().set("re",FieldScanner(val.c_str()).getDouble());
+                }else if(key == "modelname"){
+                    attr().set("modelname",val);
+                }else if(key == "tide_system"){
+                    if(val.find("zero_tide") != std::string::npos){
+                        attr().set("tidesystem",std::string("zero-tide"));
+                    }else if(val.find("tide_free") != std::string::npos){
+                        attr().set("tidesystem",std::string("tide-free"));
+                    }
+                }
+            }
+            attr().set("format",format);
+            if(format != "icgem"){
+                THROWIOEXCEPTION("The icgem format '"+format+"' is currently unsupported");
+            }
+            if(nmaxfile < 0){
+                THROWIOEXCEPTION("Cannot find max_degree in the icgem header");
+            }
+
+            allocate(nmaxfile);
+
+            double * cnm=cnm_->mat().data();
+            double * sigcnm=sigcnm_->mat().data();
+            for(;it != lbuf.end();++it){
+                const char * ln=it.line();
+                //note: time variable components (trnd, acos, asin) are not evaluated
+                const bool gfct=FieldScanner::startsWith(ln,"gfct");
+                if(!(gfct or FieldScanner::startsWith(ln,"gfc"))){
+                    continue;
+                }
+                FieldScanner scan(ln);
+                scan.skip();
+                const int n=scan.getInt();
+                const int m=scan.getInt();
+                checkDegreeOrder(n,m,ln);
+                if(n > nmax_){
+                    continue;
+                }
+                const double c=scan.getDouble();
+                const double s=scan.getDouble();
+                //count the remaining fields (gfct lines have an additional reference epoch)
+                FieldScanner rem(scan);
+                int nrem=0;
+                while(rem.more()){
+                    rem.skip();
+                    ++nrem;
+                }
+                double sigc=0.0;
+                double sigs=0.0;
+                if(nrem >= (gfct?3:2)){
+                    sigc=scan.getDouble();
+                    sigs=scan.getDouble();
+                }
+                const size_t idxc=guides::SHnmtGuide::i_from_nmt(n,m,guides::trigenum::C);
+                //note: multiple lines may contribute to the same coefficient
+                cnm[idxc]+=c;
+                sigcnm[idxc]+=sigc*sigc;
+                if(m > 0){
+                    const size_t idxs=idxc+1;
+                    cnm[idxs]+=s;
+                    sigcnm[idxs]+=sigs*sigs;
+                }
+            }
+
+            //convert the accumulated variances to standard deviations
+            std::for_each(sigcnm,sigcnm+sigcnm_->mat().num_elements(),[](double & val){val=std::sqrt(val);});
+        }
+
+        void SHtxtArchive::loadGSMv6(LineBuffer &lbuf) {
+            auto it=lbuf.begin();
+            //the yaml header is parsed as a whole
+            std::string hdrbuf;
+            for(;it != lbuf.end();++it){
+                const char * ln=it.line();
+                if(std::strstr(ln,"# End of YAML header")){
+                    ++it;
+                    break;
+                }
+                hdrbuf.append(ln);
+                hdrbuf.push_back('\n');
+            }
+            YAML::Node hdr=YAML::Load(hdrbuf)["header"];
+            if(!hdr){
+                THROWIOEXCEPTION("Cannot find the YAML header in the GSM file");
+            }
+
+            auto timeattr=[this](const std::string & name, const YAML::Node & node){
+                if(node){
+                    std::string tstr=node.as<std::string>();
+                    std::replace(tstr.begin(),tstr.end(),'T',' ');
+                    attr().set(name,boost::posix_time::time_from_string(tstr));
+                }
+            };
+            timeattr("tstart",hdr["global_attributes"]["time_coverage_start"]);
+            timeattr("tend",hdr["global_attributes"]["time_coverage_end"]);
+            auto nonstand=hdr["non-standard_attributes"];
+            attr().set("gm",nonstand["earth_gravity_param"]["value"].as<double>());
+            attr().set("re",nonstand["mean_equator_radius"]["value"].as<double>());
+
+            allocate(hdr["dimensions"]["degree"].as<int>());
+
+            double * cnm=cnm_->mat().data();
+            double * sigcnm=sigcnm_->mat().data();
+            for(;it != lbuf.end();++it){
+                const char * ln=it.line();
+                if(!FieldScanner::startsWith(ln,"GRCOF2")){
+                    continue;
+                }
+                FieldScanner scan(ln);
+                scan.skip();
+                const int n=scan.getInt();
+                const int m=scan.getInt();
+                checkDegreeOrder(n,m,ln);
+                if(n > nmax_){
+                    continue;
+                }
+                const size_t idxc=guides::SHnmtGuide::i_from_nmt(n,m,guides::trigenum::C);
+                cnm[idxc]=scan.getDouble();
+                const double s=scan.getDouble();
+                sigcnm[idxc]=scan.getDouble();
+                const double sigs=scan.getDouble();
+                if(m > 0){
+                    cnm[idxc+1]=s;
+                    sigcnm[idxc+1]=sigs;
+                }
+            }
+        }
+
+        void SHtxtArchive::loadStandard(LineBuffer &lbuf) {
+            auto it=lbuf.begin();
+            if(it == lbuf.end()){
+                THROWIOEXCEPTION("Empty spherical harmonic file");
+            }
+            //the first line holds the meta information: META nmax tstart tcent tend
+            FieldScanner meta(it.line());
+            meta.skip();
+            const int nmaxfile=meta.getInt();
+            const char * tags[]={"tstart","tcent","tend"};
+            for(auto tag:tags){
+                if(!meta.more()){
+                    break;
+                }
+                //note: times are stored in decimal years
+                const double decyr=meta.getDouble();
+                if(decyr > 0){
+                    attr().set(tag,decyr);
+                }
+            }
+            //an additional field in the meta line indicates that the file holds standard deviations as well
+            const bool witherrors=meta.more();
+            allocate(nmaxfile);
+            ++it;
+
+            double * cnm=cnm_->mat().data();
+            double * sigcnm=sigcnm_->mat().data();
+            for(;it != lbuf.end();++it){
+                const char * ln=it.line();
+                FieldScanner scan(ln);
+                if(!scan.more()){
+                    continue;
+                }
+                const int n=scan.getInt();
+                const int m=scan.getInt();
+                checkDegreeOrder(n,m,ln);
+                if(n > nmax_){
+                    continue;
+                }
+                const size_t idxc=guides::SHnmtGuide::i_from_nmt(n,m,guides::trigenum::C);
+                cnm[idxc]=scan.getDouble();
+                const double s=scan.getDouble();
+                if(m > 0){
+                    cnm[idxc+1]=s;
+                }
+                if(witherrors){
+                    sigcnm[idxc]=scan.getDouble();
+                    const double sigs=scan.getDouble();
+                    if(m > 0){
+                        sigcnm[idxc+1]=sigs;
+                    }
+                }
+            }
+        }
+
+    }
+}
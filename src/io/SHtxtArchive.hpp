@@ -0,0 +1,67 @@
+/*! \file
+ \brief Readers for spherical harmonic coefficient files in text formats (ICGEM, GRACE GSM v6, standard)
+ \copyright Roelof Rietbroek 2021
+ \license
+ This file is part of Frommle.
+ frommle is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3 of the License, or (at your option) any later version.
+
+ Frommle is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with Frommle; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <string>
+#include <memory>
+#include "io/ArchiveBase.hpp"
+#include "io/LineBuffer.hpp"
+#include "core/GArrayDense.hpp"
+#include "sh/SHGuide.hpp"
+
+#ifndef FROMMLE_SHTXTARCHIVE_HPP
+#define FROMMLE_SHTXTARCHIVE_HPP
+
+namespace frommle{
+    namespace io{
+
+        ///@brief supported text formats of spherical harmonic coefficient files
+        enum class SHtxtFormat{standard,icgem,GSMv6};
+
+        /*!@brief Archive which reads spherical harmonic coefficients (and their standard deviations) from a (gzipped) text file
+         * The coefficients are stored in dense arrays over an SHnmtGuide and the header information is stored in the attributes
+         * Coefficients above the requested maximum degree are skipped
+         */
+        class SHtxtArchive:public ArchiveBase{
+        public:
+            using garr_t=core::GArrayDense<double,1>;
+            SHtxtArchive():ArchiveBase(){}
+            ///@brief open and read a file (a negative nmax uses the maximum degree from the file)
+            SHtxtArchive(const std::string & filename, const SHtxtFormat format, const int nmax=-1);
+            ///@brief same as above but tries to detect the format from the file name
+            SHtxtArchive(const std::string & filename, const int nmax=-1);
+            std::shared_ptr<garr_t> cnm()const{return cnm_;}
+            std::shared_ptr<garr_t> sigcnm()const{return sigcnm_;}
+            int nmax()const{return nmax_;}
+            static SHtxtFormat guessFormat(const std::string & filename);
+        private:
+            int nmax_=-1;
+            std::shared_ptr<garr_t> cnm_{};
+            std::shared_ptr<garr_t> sigcnm_{};
+            void load(const std::string & filename, const SHtxtFormat format);
+            void allocate(const int nmaxfile);
+            void loadICGEM(LineBuffer & lbuf);
+            void loadGSMv6(LineBuffer & lbuf);
+            void loadStandard(LineBuffer & lbuf);
+        };
+
+    }
+}
+
+#endif //FROMMLE_SHTXTARCHIVE_HPP
@@ -0,0 +1,84 @@
+/*! \file
+ \brief Implementation of the DDK filter operator
+ \copyright Roelof Rietbroek 2021
+ \license
+ This file is part of Frommle.
+ frommle is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3 of the License, or (at your option) any later version.
+
+ Frommle is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with Frommle; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "sh/DDKfilter.hpp"
+#include "io/BINVArchive.hpp"
+#include <algorithm>
+
+namespace frommle{
+    namespace sh{
+
+        ///@brief retrieve integer meta data (stored as either integer or double in the file)
+        static int metaDegree(const io::BINVArchive & binv, const std::string & name){
+            if (!binv.attr().contains(name)){
+                THROWINPUTEXCEPTION("DDK filter file misses the meta data entry "+name);
+            }
+            try{
+                return binv.attr().get<size_t>(name);
+            }catch(boost::bad_any_cast & excep){
+                return binv.attr().get<double>(name);
+            }
+        }
+
+        DDKfilter::DDKfilter(const std::string &filename, const int nmax, const bool transpose, std::string name):GOpBlk(name) {
+            io::BINVArchive binv(filename);
+            if (binv.type() != "BDFULLV0"){
+                THROWINPUTEXCEPTION("Not an appropriate DDK filter matrix");
+            }
+            const int lmax=metaDegree(binv,"Lmax");
+            const int lmin=metaDegree(binv,"Lmin");
+            nmax_=(nmax < 0)?lmax:nmax;
+            if (nmax_ > lmax){
+                THROWINPUTEXCEPTION("Maximum degree of filter matrix is smaller than the requested maximum degree");
+            }
+
+            guides::SHtmnGuide shg(nmax_);
+            gpo_=std::make_shared<gpo_t>(shg);
+            blockdiag_=garr(*gpo_,shg.orderBlocks());
+            //the sine coefficients of order 0 have no filter block
+            blockdiag_.block(nmax_+1).setZero();
+
+            //the file stores the blocks as C0, C1, S1, C2, S2, ...
+            for(size_t iblk=0;iblk<binv.nblocks();++iblk){
+                const int m=(iblk+1)/2;
+                if (m > nmax_){
+                    break;
+                }
+                const int trig=(iblk == 0)?0:(iblk-1)%2;
+                const size_t sz=binv.blockSize(iblk);
+                //the filter blocks start at the minimum degree
+                const size_t shft=std::max(lmin,m)-m;
+                const size_t nblk=nmax_-m+1;
+                if(shft >= nblk){
+                    continue;
+                }
+                const size_t ntrunc=std::min(sz,nblk-shft);
+                auto filt=binv.block(iblk);
+                auto & blk=blockdiag_.block(trig*(nmax_+1)+m);
+                if (transpose){
+                    blk.block(shft,shft,ntrunc,ntrunc)=filt.transpose().topLeftCorner(ntrunc,ntrunc);
+                }else{
+                    blk.block(shft,shft,ntrunc,ntrunc)=filt.topLeftCorner(ntrunc,ntrunc);
+                }
+            }
+        }
+
+    }
+}
@@ -0,0 +1,47 @@
+/*! \file
+ \brief Anisotropic DDK filter of spherical harmonic coefficients as a block diagonal operator
+ \copyright Roelof Rietbroek 2021
+ \license
+ This file is part of Frommle.
+ frommle is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3 of the License, or (at your option) any later version.
+
+ Frommle is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with Frommle; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "core/GOperatorBlockDiag.hpp"
+#include "sh/SHGuide.hpp"
+
+#ifndef FROMMLE_DDKFILTER_HPP
+#define FROMMLE_DDKFILTER_HPP
+namespace frommle{
+    namespace sh{
+
+        /*!@brief DDK filter which is read from a block diagonal BINV file (BDFULLV0) with one block per order and trigonometric type
+         * The operator acts on SHtmnGuide sorted coefficients, and the blocks are truncated when nmax is smaller than the maximum degree of the filter
+         * Degrees below the minimum degree of the filter are passed through unaltered, while the (zero) sine coefficients of order 0 are set to zero
+         * When transpose is true, the transposed filter is applied (e.g. needed for filtering basins before averaging operations)
+         */
+        class DDKfilter:public core::GOperatorBlockDiag<double>{
+        public:
+            using GOpBlk=core::GOperatorBlockDiag<double>;
+            DDKfilter(const std::string & filename, const int nmax=-1, const bool transpose=false, std::string name="DDKfilter");
+            core::typehash hash()const override{return core::typehash("DDKfilter_t");}
+            int nmax()const{return nmax_;}
+        private:
+            int nmax_=-1;
+        };
+
+    }
+}
+
+#endif //FROMMLE_DDKFILTER_HPP
@@ -22,8 +22,10 @@
  */
 
 #include "sh/Legendre_nm.hpp"
+#include "core/Parallel.hpp"
 #include <math.h>
 #include <assert.h>
+#include <array>
 namespace frommle {
     namespace sh {
 
@@ -113,6 +115,177 @@ namespace frommle {
             return *this;
         }
 
+        ///@brief number of latitudes which are processed simultaneously in the batched version (fixed so the compiler can vectorize the lane loops)
+        constexpr int nLanes=8;
+        ///@brief amount of degrees which are buffered before writing them to the output
+        constexpr int nTile=64;
+
+        ///@brief recursion state for a block of latitudes
+        template<class ftype>
+        struct alignas(64) laneEntry {
+            std::array<ftype,nLanes> x{};
+            std::array<ftype,nLanes> sinTheta{};
+            std::array<ftype,nLanes> pnmin2{};
+            std::array<ftype,nLanes> pnmin1{};
+            std::array<ftype,nLanes> pn{};
+            std::array<ftype,nLanes> sectorial{};
+        };
+
+        template<class ftype>
+        void Legendre_nm<ftype>::setBatch(const ftype *costheta, const size_t nlat, ftype *out) const {
+            int nmax_=shg().nmax();
+            const size_t nnm=shg().size();
+            ftype numericStabilityFactor = 1e-280;
+            size_t idx;
+            laneEntry<ftype> lanes;
+            //temporary storage of a chunk of degrees for all lanes
+            alignas(64) ftype tile[nTile][nLanes];
+
+            for (size_t ilat0 = 0; ilat0 < nlat; ilat0 += nLanes) {
+                //number of active lanes in this block (the remaining ones are padded with the last value)
+                const int nl = std::min<size_t>(nLanes, nlat - ilat0);
+                ftype *outblk = out + ilat0 * nnm;
+
+                for (int l = 0; l < nLanes; ++l) {
+                    lanes.x[l] = costheta[ilat0 + std::min(l, nl - 1)];
+                    assert(lanes.x[l] >= -1.0 and lanes.x[l] <= 1.0);
+                    //note: same expression as used in set() so that results are bitwise identical
+                    lanes.sinTheta[l] = std::sqrt(1 - pow(lanes.x[l], 2));
+                    lanes.sectorial[l] = 1.0 / numericStabilityFactor;
+                }
+
+                for (int l = 0; l < nl; ++l) {
+                    outblk[l * nnm] = 1.0;
+                }
+
+                for (int m = 0; m < nmax_; ++m) {
+                    idx = shg_t::i_from_nm(m, m, nmax_);
+                    const ftype w1 = wnm_[idx + 1];
+                    for (int l = 0; l < nLanes; ++l) {
+                        lanes.pnmin2[l] = numericStabilityFactor;
+                        lanes.pnmin1[l] = w1 * lanes.x[l] * lanes.pnmin2[l];
+                    }
+                    for (int l = 0; l < nl; ++l) {
+                        outblk[l * nnm + idx + 1] = lanes.pnmin1[l] * lanes.sectorial[l];
+                    }
+
+                    //loop over the remaining degrees in chunks, so the output can be written contiguously per latitude
+                    for (int n0 = m + 2; n0 <= nmax_; n0 += nTile) {
+                        const int nt = std::min(nTile, nmax_ - n0 + 1);
+                        const size_t idx0 = shg_t::i_from_nm(n0, m, nmax_);
+                        for (int it = 0; it < nt; ++it) {
+                            //note: the storage index increments by one for each degree
+                            const ftype w = wnm_[idx0 + it];
+                            const ftype wmin1 = wnm_[idx0 + it - 1];
+                            for (int l = 0; l < nLanes; ++l) {
+                                lanes.pn[l] = w * (lanes.x[l] * lanes.pnmin1[l] - lanes.pnmin2[l] / wmin1);
+                                lanes.pnmin2[l] = lanes.pnmin1[l];
+                                lanes.pnmin1[l] = lanes.pn[l];
+                                tile[it][l] = lanes.pn[l] * lanes.sectorial[l];
+                            }
+                        }
+                        for (int l = 0; l < nl; ++l) {
+                            ftype *outl = outblk + l * nnm + idx0;
+                            for (int it = 0; it < nt; ++it) {
+                                outl[it] = tile[it][l];
+                            }
+                        }
+                    }
+
+                    //update the sectorials of all lanes
+                    idx = shg_t::i_from_nm(m + 1, m + 1, nmax_);
+                    for (int l = 0; l < nLanes; ++l) {
+                        lanes.sectorial[l] *= wnn_[m + 1] * lanes.sinTheta[l];
+                    }
+                    for (int l = 0; l < nl; ++l) {
+                        outblk[l * nnm + idx] = lanes.sectorial[l] * numericStabilityFactor;
+                    }
+                }
+            }
+
+        }
+
+        template<class ftype>
+        boost::multi_array<ftype,2> Legendre_nm<ftype>::setBatch(const std::vector<ftype> &costheta) const {
+            boost::multi_array<ftype,2> out(boost::extents[costheta.size()][shg().size()]);
+            setBatch(costheta.data(), costheta.size(), out.data());
+            return out;
+        }
+
+        template<class ftype>
+        void Legendre_nm<ftype>::setSectorials(const ftype *costheta, const size_t nlat, ftype *seeds) const {
+            int nmax_=shg().nmax();
+            ftype numericStabilityFactor = 1e-280;
+            for (size_t ilat = 0; ilat < nlat; ++ilat) {
+                assert(costheta[ilat] >= -1.0 and costheta[ilat] <= 1.0);
+                //note: same expressions as in set() so that results are bitwise identical
+                ftype sinTheta = std::sqrt(1 - pow(costheta[ilat], 2));
+                ftype * seed = seeds + ilat * (nmax_ + 1);
+                seed[0] = 1.0 / numericStabilityFactor;
+                for (int m = 0; m < nmax_; ++m) {
+                    seed[m + 1] = seed[m] * (wnn_[m + 1] * sinTheta);
+                }
+            }
+        }
+
+        template<class ftype>
+        void Legendre_nm<ftype>::setOrder(const int m, const ftype *costheta, const size_t nlat, const ftype *seeds, ftype *out) const {
+            int nmax_=shg().nmax();
+            assert(m >= 0 and m <= nmax_);
+            ftype numericStabilityFactor = 1e-280;
+            size_t idx = shg_t::i_from_nm(m, m, nmax_);
+
+            //sectorial
+            for (size_t ilat = 0; ilat < nlat; ++ilat) {
+                out[ilat] = (m == 0) ? 1.0 : seeds[ilat * (nmax_ + 1) + m] * numericStabilityFactor;
+            }
+            if (m == nmax_) {
+                return;
+            }
+
+            std::vector<ftype> sectorial(nlat);
+            std::vector<ftype> pnmin2(nlat, numericStabilityFactor);
+            std::vector<ftype> pnmin1(nlat);
+            const ftype w1 = wnm_[idx + 1];
+            ftype *outn = out + nlat;
+            for (size_t ilat = 0; ilat < nlat; ++ilat) {
+                sectorial[ilat] = seeds[ilat * (nmax_ + 1) + m];
+                pnmin1[ilat] = w1 * costheta[ilat] * pnmin2[ilat];
+                outn[ilat] = pnmin1[ilat] * sectorial[ilat];
+            }
+
+            for (int n = m + 2; n <= nmax_; ++n) {
+                idx = shg_t::i_from_nm(n, m, nmax_);
+                const ftype w = wnm_[idx];
+                const ftype wmin1 = wnm_[idx - 1];
+                outn += nlat;
+                for (size_t ilat = 0; ilat < nlat; ++ilat) {
+                    ftype pn = w * (costheta[ilat] * pnmin1[ilat] - pnmin2[ilat] / wmin1);
+                    outn[ilat] = pn * sectorial[ilat];
+                    pnmin2[ilat] = pnmin1[ilat];
+                    pnmin1[ilat] = pn;
+                }
+            }
+        }
+
+        template<class ftype>
+        Legendre_nm<ftype> & Legendre_nm<ftype>::setParallel(const ftype costheta, const int nthreads){
+            const int nmax_=shg().nmax();
+            //the sectorial seeds are the only serial dependency between the orders
+            std::vector<ftype> seeds(nmax_ + 1);
+            setSectorials(&costheta, 1, seeds.data());
+
+            ftype *pnm = mat().data();
+            //the amount of work decreases with order, so hand out small chunks of orders dynamically
+            core::parallel_for(nmax_ + 1, [&](const int ithread, const size_t mstart, const size_t mend) {
+                for (size_t m = mstart; m < mend; ++m) {
+                    //the degrees of one order are stored contiguously in the SHnmGuide layout
+                    setOrder(m, &costheta, 1, seeds.data(), pnm + shg_t::i_from_nm(m, m, nmax_));
+                }
+            }, nthreads, 16);
+            return *this;
+        }
+
 //        template<class ftype>
 //        std::vector<ftype> Legendre_nm<ftype>::d1at(const ftype costheta) const {
 //            return std::vector<ftype>();
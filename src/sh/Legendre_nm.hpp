@@ -44,6 +44,15 @@ namespace frommle{
             Legendre_nm(const int nmax);
             Legendre_nm()=default;
             Legendre_nm & set(const ftype costheta);
+            ///@brief same as set() but the orders are distributed over nthreads threads (worthwhile for very high degrees)
+            Legendre_nm & setParallel(const ftype costheta, const int nthreads=0);
+            ///@brief batched evaluation for multiple latitudes, out is a row-major (nlat x shg().size()) block
+            void setBatch(const ftype * costheta, const size_t nlat, ftype * out)const;
+            boost::multi_array<ftype,2> setBatch(const std::vector<ftype> & costheta)const;
+            ///@brief compute the rescaled sectorial seeds for nlat latitudes, seeds is a row-major (nlat x nmax+1) block
+            void setSectorials(const ftype * costheta, const size_t nlat, ftype * seeds)const;
+            ///@brief compute all degrees of a single order from precomputed seeds, out is a (nmax-m+1 x nlat) block with latitude varying fastest
+            void setOrder(const int m, const ftype * costheta, const size_t nlat, const ftype * seeds, ftype * out)const;
 
 //            std::vector<ftype> operator()(const ftype costheta)const;
 //            std::vector<ftype> d1at(const ftype costheta)const;
@@ -86,6 +95,11 @@ namespace frommle{
                return Pnm[nm(n,m)]*sincosmlon[m][t]; 
             }
             
+            ///@brief fast access with precomputed (n,m) index of the associated Legendre functions
+            inline T operator()(const size_t inm, const int m, const trig t)const{
+               return Pnm.mat()[inm]*sincosmlon[m][t];
+            }
+
             //convenience function to compute costheta from lat
             Ynm_cache & setlat(const T & lat){
                 return this->setx(sin(D2R*lat));
@@ -103,6 +117,7 @@ namespace frommle{
 
             }
 
+            ///@brief compute cos(m lon) and sin(m lon) with an angle-addition recurrence (re-seeded with a direct evaluation every reseed orders)
             Ynm_cache & setlon(const T & lon){
                
                 if (lon ==  lon_){
@@ -110,20 +125,33 @@ namespace frommle{
                     return *this;
                }
                 lon_=lon;
-                double mlon=0;
+                const T dlon=D2R*lon_;
+                const T c1=cos(dlon);
+                const T s1=sin(dlon);
+                T mlon=0;
                 for(int m=0;m<=nmax_;++m){
-                    //although I didn't test it I suspect calling cosine and sin on the same variable may be optimized  to calling a dedicated sincos function
-                    mlon=m*D2R*lon_;
-                    sincosmlon[m][0]=cos(mlon);
-                    sincosmlon[m][1]=sin(mlon);
+                    if(m%reseed == 0){
+                        //bound the error growth of the recurrence by evaluating directly
+                        mlon=m*dlon;
+                        sincosmlon[m][0]=cos(mlon);
+                        sincosmlon[m][1]=sin(mlon);
+                    }else{
+                        sincosmlon[m][0]=sincosmlon[m-1][0]*c1-sincosmlon[m-1][1]*s1;
+                        sincosmlon[m][1]=sincosmlon[m-1][1]*c1+sincosmlon[m-1][0]*s1;
+                    }
                 }
 
                 return *this;
 
             }
 
+            ///@brief access to the cached cos(m lon) (column 0) and sin(m lon) (column 1)
+            const boost::multi_array<T,2> & sincos()const{return sincosmlon;}
+
 
             private:
+                ///@brief amount of orders after which the trigonometric recurrence is re-seeded
+                static const int reseed=64;
                 int nmax_=0;
                 T costheta_=DBL_MAX; //note impossible value on purpose so that first call to setx will correctly initialize 
                 T lon_=DBL_MAX;
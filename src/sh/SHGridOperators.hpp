@@ -0,0 +1,410 @@
+/*! \file
+ \brief Fast spherical harmonic synthesis and analysis on equidistant grids
+ \copyright Roelof Rietbroek 2020
+ \license
+ This file is part of Frommle.
+ frommle is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3 of the License, or (at your option) any later version.
+
+ Frommle is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with Frommle; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "geometry/GeoGrid.hpp"
+#include "sh/SHGuide.hpp"
+#include "sh/Legendre_nm.hpp"
+#include "core/GOperatorBase.hpp"
+#include "core/Parallel.hpp"
+#include "core/FFT.hpp"
+#include "core/MacroMagic.hpp"
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <mutex>
+
+#ifndef FROMMLE_SHGRIDOPERATORS_HPP
+#define FROMMLE_SHGRIDOPERATORS_HPP
+namespace frommle{
+    namespace sh{
+
+        /*!@brief Engine which transforms between spherical harmonic coefficients and an equidistant grid
+         * The Legendre transform is applied per order for all latitude rings at once, while the longitude direction is handled by an FFT.
+         * Columns (e.g. time slices) are processed in blocks so that the Legendre functions are shared between columns
+         */
+        template<class T>
+        class SHGridEngine{
+        public:
+            using eigmat=Eigen::Matrix<T,Eigen::Dynamic,Eigen::Dynamic>;
+            using cplx=std::complex<T>;
+            ///@brief maximum amount of columns which are transformed together
+            static const size_t colblock=32;
+            ///@brief upper bound (in bytes) of the Fourier coefficients which are kept in memory for a block of columns
+            static const size_t fourierbytes=size_t(512)<<20;
+
+            SHGridEngine(const guides::SHGuide & shg, const guides::GeoGrid & grid, const bool analysis=false);
+
+            void synthesis(const core::GArrayDense<T,2> & gin, core::GArrayDense<T,2> & gout, const int nthreads=0)const;
+            /*!@brief spherical harmonic analysis of (a band of) the grid
+             * gin may hold only the latitude rings [ilat0,ilat0+nrows) (nrows follows from the size of gin), the remaining rings are treated as zero.
+             * When accumulate is true the contribution is added to gout, so a grid can be analyzed in chunks of rings
+             */
+            void analysis(const core::GArrayDense<T,2> & gin, core::GArrayDense<T,2> & gout, const int nthreads=0, const size_t ilat0=0, const bool accumulate=false)const;
+
+            const std::vector<T> & weights()const{return weights_;}
+            size_t nlat()const{return nlat_;}
+            size_t nlon()const{return nlon_;}
+        private:
+            int nmax_=0;
+            size_t nlat_=0;
+            size_t nlon_=0;
+            ///@brief number of longitude samples on a full circle
+            size_t nfft_=0;
+            ///@brief storage rows of the cosine and sine coefficients per order (degree, row)
+            std::vector<std::vector<std::pair<int,size_t>>> cidx_{};
+            std::vector<std::vector<std::pair<int,size_t>>> sidx_{};
+            std::vector<T> costheta_{};
+            std::vector<T> weights_{};
+            std::vector<T> seeds_{};
+            ///@brief exp(i m lon0) for the first longitude of the grid
+            std::vector<cplx> phase_{};
+            Legendre_nm<T> Pnm_{};
+            core::FFTplan<T> fft_{};
+            void quadratureWeights(const guides::GeoGrid & grid);
+            ///@brief number of columns per block, bounded by the memory needed for the Fourier coefficients of all orders
+            size_t columnBlock(const size_t ncol, const size_t nrows)const{
+                const size_t colbytes=std::max(size_t(1),2*(nmax_+1)*nrows*sizeof(T));
+                return std::max(size_t(1),std::min({size_t(colblock),ncol,fourierbytes/colbytes}));
+            }
+            static int maxdegree(const guides::SHGuide & shg){
+                int nmax=0;
+                for(const auto & nmt:shg){
+                    nmax=std::max(nmax,std::get<0>(nmt));
+                }
+                return nmax;
+            }
+        };
+
+        template<class T>
+        SHGridEngine<T>::SHGridEngine(const guides::SHGuide &shg, const guides::GeoGrid &grid, const bool analysis):nmax_(maxdegree(shg)),Pnm_(nmax_){
+            cidx_.resize(nmax_+1);
+            sidx_.resize(nmax_+1);
+            size_t row=0;
+            for(const auto & nmt:shg){
+                if(std::get<2>(nmt) == trigenum::C){
+                    cidx_[std::get<1>(nmt)].emplace_back(std::get<0>(nmt),row);
+                }else{
+                    sidx_[std::get<1>(nmt)].emplace_back(std::get<0>(nmt),row);
+                }
+                ++row;
+            }
+
+            nlat_=grid.nlat();
+            nlon_=grid.nlon();
+            const double nfft=360.0/grid.dlon();
+            nfft_=std::round(nfft);
+            if(std::abs(nfft-nfft_) > 1e-8*nfft){
+                THROWNOTIMPLEMENTED("The longitude spacing of the grid must divide 360 degrees");
+            }
+
+            double lon0,lat;
+            std::tie(lon0,lat)=grid.lonlat(0,0);
+            phase_.resize(nmax_+1);
+            for(int m=0;m<=nmax_;++m){
+                phase_[m]=std::polar(T(1.0),static_cast<T>(m*D2R*lon0));
+            }
+
+            costheta_.resize(nlat_);
+            for(size_t ilat=0;ilat<nlat_;++ilat){
+                std::tie(lon0,lat)=grid.lonlat(0,ilat);
+                costheta_[ilat]=sin(D2R*lat);
+            }
+
+            if(analysis){
+                if(nlon_ < nfft_){
+                    THROWINPUTEXCEPTION("Spherical harmonic analysis requires a grid which covers all longitudes");
+                }
+                quadratureWeights(grid);
+            }
+
+            seeds_.resize(nlat_*(nmax_+1));
+            Pnm_.setSectorials(costheta_.data(),nlat_,seeds_.data());
+            fft_=core::FFTplan<T>(nfft_);
+
+        }
+
+        ///@brief Fejer (pixel registration) or Clenshaw-Curtis (grid registration) weights, these integrate band limited functions exactly
+        template<class T>
+        void SHGridEngine<T>::quadratureWeights(const guides::GeoGrid &grid){
+            const double eps=1e-8;
+            bool isglobal=std::abs(grid.bbox().MinY+90.0) < eps;
+            if(grid.reg() == guides::GeoGrid::pix){
+                isglobal = isglobal and std::abs(nlat_*grid.dlat()-180.0) < eps;
+            }else{
+                isglobal = isglobal and std::abs((nlat_-1)*grid.dlat()-180.0) < eps;
+            }
+            if(!isglobal){
+                THROWINPUTEXCEPTION("Spherical harmonic analysis requires a grid which covers all latitudes");
+            }
+
+            if (nlat_ <= static_cast<size_t>(2*nmax_)){
+                LOGWARNING << "Latitude sampling is too coarse for an exact spherical harmonic analysis up to degree "<<nmax_<<std::endl;
+            }
+
+            weights_.resize(nlat_);
+            double lon,lat;
+            if(grid.reg() == guides::GeoGrid::pix){
+                //Fejer's first rule
+                const size_t nq=nlat_;
+                for(size_t ilat=0;ilat<nlat_;++ilat){
+                    std::tie(lon,lat)=grid.lonlat(0,ilat);
+                    T theta=D2R*(90.0-lat);
+                    T sum=0;
+                    for(size_t l=1;l<=nq/2;++l){
+                        sum+=cos(2*l*theta)/(4.0*l*l-1);
+                    }
+                    weights_[ilat]=2.0/nq*(1-2*sum);
+                }
+            }else{
+                //Clenshaw-Curtis rule
+                const size_t nq=nlat_-1;
+                for(size_t ilat=0;ilat<nlat_;++ilat){
+                    std::tie(lon,lat)=grid.lonlat(0,ilat);
+                    T theta=D2R*(90.0-lat);
+                    T sum=0;
+                    for(size_t l=1;l<=nq/2;++l){
+                        T b=(2*l == nq)?1.0:2.0;
+                        sum+=b*cos(2*l*theta)/(4.0*l*l-1);
+                    }
+                    T c=(ilat == 0 or ilat == nq)?1.0:2.0;
+                    weights_[ilat]=c/nq*(1-sum);
+                }
+            }
+        }
+
+        template<class T>
+        void SHGridEngine<T>::synthesis(const core::GArrayDense<T, 2> &gin, core::GArrayDense<T, 2> &gout, const int nthreads) const {
+            const size_t ncol=gin.mat().shape()[1];
+            auto cin=gin.eig();
+            auto outmat=gout.eig();
+            const int nth=core::nThreads(nthreads);
+
+            //Fourier coefficients per order (cosine and sine), latitude x columns (reused for all column blocks)
+            const size_t ncbmax=columnBlock(ncol,nlat_);
+            std::vector<eigmat> four(2*(nmax_+1),eigmat(nlat_,ncbmax));
+
+            for(size_t cb0=0;cb0<ncol;cb0+=ncbmax){
+                const size_t ncb=std::min(ncbmax,ncol-cb0);
+
+                //Legendre transform (parallel over orders)
+                core::parallel_for(nmax_+1,[&](const int ith, const size_t m0, const size_t m1){
+                    eigmat pm;
+                    eigmat cmat;
+                    for(size_t im=m0;im<m1;++im){
+                        const int m=im;
+                        const size_t nn=nmax_-m+1;
+                        pm.resize(nlat_,nn);
+                        Pnm_.setOrder(m,costheta_.data(),nlat_,seeds_.data(),pm.data());
+                        for(int t=0;t<2;++t){
+                            const auto & idx=(t==0)?cidx_[m]:sidx_[m];
+                            cmat.setZero(nn,ncb);
+                            for(const auto & nrow:idx){
+                                cmat.row(nrow.first-m)=cin.block(nrow.second,cb0,1,ncb);
+                            }
+                            four[2*m+t].leftCols(ncb).noalias()=pm*cmat;
+                        }
+                    }
+                },nth);
+
+                //longitude direction (parallel over latitude rings), two real columns are transformed with one complex FFT
+                core::parallel_for(nlat_,[&](const int ith, const size_t i0, const size_t i1){
+                    std::vector<cplx> z1(nfft_);
+                    std::vector<cplx> z2(nfft_);
+                    std::vector<cplx> h(nfft_);
+                    std::vector<cplx> x(nfft_);
+                    for(size_t ilat=i0;ilat<i1;++ilat){
+                        for(size_t c=0;c<ncb;c+=2){
+                            const bool pair=(c+1 < ncb);
+                            std::fill(z1.begin(),z1.end(),cplx(0.0));
+                            std::fill(z2.begin(),z2.end(),cplx(0.0));
+                            for(int m=0;m<=nmax_;++m){
+                                const size_t k=m%nfft_;
+                                z1[k]+=cplx(four[2*m](ilat,c),-four[2*m+1](ilat,c))*phase_[m];
+                                if(pair){
+                                    z2[k]+=cplx(four[2*m](ilat,c+1),-four[2*m+1](ilat,c+1))*phase_[m];
+                                }
+                            }
+                            //hermitian symmetric spectra so that both transforms are real
+                            for(size_t k=0;k<nfft_;++k){
+                                const size_t kn=(nfft_-k)%nfft_;
+                                h[k]=T(0.5)*(z1[k]+std::conj(z1[kn]))+cplx(0.0,0.5)*(z2[k]+std::conj(z2[kn]));
+                            }
+                            fft_.bwd(h.data(),x.data());
+                            for(size_t ilon=0;ilon<nlon_;++ilon){
+                                const size_t irow=ilat*nlon_+ilon;
+                                outmat(irow,cb0+c)=x[ilon%nfft_].real();
+                                if(pair){
+                                    outmat(irow,cb0+c+1)=x[ilon%nfft_].imag();
+                                }
+                            }
+                        }
+                    }
+                },nth);
+            }
+        }
+
+        template<class T>
+        void SHGridEngine<T>::analysis(const core::GArrayDense<T, 2> &gin, core::GArrayDense<T, 2> &gout, const int nthreads, const size_t ilat0, const bool accumulate) const {
+            if(weights_.size() != nlat_){
+                THROWMETHODEXCEPTION("Engine was not set up for a spherical harmonic analysis");
+            }
+            const size_t ncol=gin.mat().shape()[1];
+            const size_t nrows=gin.mat().shape()[0]/nlon_;
+            if(nrows*nlon_ != gin.mat().shape()[0] or ilat0+nrows > nlat_){
+                THROWINPUTEXCEPTION("Input does not hold complete latitude rings of the grid");
+            }
+            auto inmat=gin.eig();
+            auto outmat=gout.eig();
+            const int nth=core::nThreads(nthreads);
+
+            const size_t ncbmax=columnBlock(ncol,nrows);
+            std::vector<eigmat> four(2*(nmax_+1),eigmat(nrows,ncbmax));
+
+            for(size_t cb0=0;cb0<ncol;cb0+=ncbmax){
+                const size_t ncb=std::min(ncbmax,ncol-cb0);
+
+                //longitude direction (parallel over latitude rings)
+                core::parallel_for(nrows,[&](const int ith, const size_t i0, const size_t i1){
+                    std::vector<cplx> h(nfft_);
+                    std::vector<cplx> y(nfft_);
+                    for(size_t ilat=i0;ilat<i1;++ilat){
+                        //includes the normalization of the longitude integral and the 4 pi normalization
+                        const T fac=weights_[ilat0+ilat]/(2*nfft_);
+                        for(size_t c=0;c<ncb;c+=2){
+                            const bool pair=(c+1 < ncb);
+                            for(size_t ilon=0;ilon<nfft_;++ilon){
+                                const size_t irow=ilat*nlon_+ilon;
+                                h[ilon]=cplx(inmat(irow,cb0+c),pair?inmat(irow,cb0+c+1):0.0);
+                            }
+                            fft_.fwd(h.data(),y.data());
+                            for(int m=0;m<=nmax_;++m){
+                                const size_t k=m%nfft_;
+                                const size_t kn=(nfft_-k)%nfft_;
+                                cplx x1=T(0.5)*(y[k]+std::conj(y[kn]))*std::conj(phase_[m]);
+                                four[2*m](ilat,c)=fac*x1.real();
+                                four[2*m+1](ilat,c)=-fac*x1.imag();
+                                if(pair){
+                                    cplx x2=cplx(0.0,-0.5)*(y[k]-std::conj(y[kn]))*std::conj(phase_[m]);
+                                    four[2*m](ilat,c+1)=fac*x2.real();
+                                    four[2*m+1](ilat,c+1)=-fac*x2.imag();
+                                }
+                            }
+                        }
+                    }
+                },nth);
+
+                //Legendre transform (parallel over orders)
+                core::parallel_for(nmax_+1,[&](const int ith, const size_t m0, const size_t m1){
+                    eigmat pm;
+                    eigmat res;
+                    for(size_t im=m0;im<m1;++im){
+                        const int m=im;
+                        const size_t nn=nmax_-m+1;
+                        pm.resize(nrows,nn);
+                        Pnm_.setOrder(m,costheta_.data()+ilat0,nrows,seeds_.data()+ilat0*(nmax_+1),pm.data());
+                        for(int t=0;t<2;++t){
+                            const auto & idx=(t==0)?cidx_[m]:sidx_[m];
+                            res.noalias()=pm.transpose()*four[2*m+t].leftCols(ncb);
+                            for(const auto & nrow:idx){
+                                if(accumulate){
+                                    outmat.block(nrow.second,cb0,1,ncb)+=res.row(nrow.first-m);
+                                }else{
+                                    outmat.block(nrow.second,cb0,1,ncb)=res.row(nrow.first-m);
+                                }
+                            }
+                        }
+                    }
+                },nth);
+            }
+        }
+
+
+        /*!@brief Keeps the engine of the last transform so repeated calls with the same guides skip the setup
+         * The cache is shared by copies of an operator and may be used from several threads
+         */
+        template<class T>
+        class SHGridEngineCache{
+        public:
+            std::shared_ptr<const SHGridEngine<T>> get(const guides::SHGuide & shg, const guides::GeoGrid & grid, const bool analysis){
+                const auto & env=grid.bbox();
+                const std::array<double,8> gridkey={env.MinX,env.MaxX,env.MinY,env.MaxY,grid.dlon(),grid.dlat(),double(grid.reg()),double(analysis)};
+                std::lock_guard<std::mutex> lock(mut_);
+                if(!engine_ or gridkey != gridkey_ or shg.size() != shkey_.size() or !std::equal(shkey_.cbegin(),shkey_.cend(),shg.begin())){
+                    engine_=std::make_shared<const SHGridEngine<T>>(shg,grid,analysis);
+                    gridkey_=gridkey;
+                    shkey_.assign(shg.begin(),shg.end());
+                }
+                return engine_;
+            }
+        private:
+            std::mutex mut_{};
+            std::shared_ptr<const SHGridEngine<T>> engine_{};
+            std::array<double,8> gridkey_{};
+            std::vector<nmtEl> shkey_{};
+        };
+
+        ///@brief Operator which synthesizes spherical harmonic coefficients (SHGuide) on an equidistant grid (GeoGrid)
+        template<class T>
+        class SH2Grid:public core::GOperatorDyn<T,1,1>{
+        public:
+            using GOpBase=core::GOperatorDyn<T,1,1>;
+            SH2Grid():GOpBase("SH2Grid"){}
+            SH2Grid(const guides::GeoGrid & grid, const int nthreads=0):GOpBase(typename GOpBase::gpo_t(grid),"SH2Grid"),nthreads_(nthreads){}
+            void setNThreads(const int nthreads){nthreads_=nthreads;}
+
+            void fwdOp(const core::GArrayBase<T,2> & gin, core::GArrayBase<T,2> &gout)override{
+                auto shg=gin.gp().template dyn_as<guides::SHGuide>(0);
+                auto grid=gout.gp().template dyn_as<guides::GeoGrid>(0);
+                if(!shg or !grid){
+                    THROWINPUTEXCEPTION("SH2Grid requires an SHGuide as input and a GeoGrid as output");
+                }
+                cache_->get(*shg,*grid,false)->synthesis(*gin.template as<const core::GArrayDense<T,2>*>(),*gout.template as<core::GArrayDense<T,2>*>(),nthreads_);
+            }
+        private:
+            int nthreads_=0;
+            std::shared_ptr<SHGridEngineCache<T>> cache_=std::make_shared<SHGridEngineCache<T>>();
+        };
+
+        ///@brief Operator which computes spherical harmonic coefficients (SHGuide) from data on an equidistant global grid (GeoGrid)
+        template<class T>
+        class Grid2SH:public core::GOperatorDyn<T,1,1>{
+        public:
+            using GOpBase=core::GOperatorDyn<T,1,1>;
+            Grid2SH():GOpBase("Grid2SH"){}
+            Grid2SH(const guides::SHGuide & shg, const int nthreads=0):GOpBase(typename GOpBase::gpo_t(shg),"Grid2SH"),nthreads_(nthreads){}
+            void setNThreads(const int nthreads){nthreads_=nthreads;}
+
+            void fwdOp(const core::GArrayBase<T,2> & gin, core::GArrayBase<T,2> &gout)override{
+                auto grid=gin.gp().template dyn_as<guides::GeoGrid>(0);
+                auto shg=gout.gp().template dyn_as<guides::SHGuide>(0);
+                if(!shg or !grid){
+                    THROWINPUTEXCEPTION("Grid2SH requires a GeoGrid as input and an SHGuide as output");
+                }
+                cache_->get(*shg,*grid,true)->analysis(*gin.template as<const core::GArrayDense<T,2>*>(),*gout.template as<core::GArrayDense<T,2>*>(),nthreads_);
+            }
+        private:
+            int nthreads_=0;
+            std::shared_ptr<SHGridEngineCache<T>> cache_=std::make_shared<SHGridEngineCache<T>>();
+        };
+
+    }
+}
+
+#endif //FROMMLE_SHGRIDOPERATORS_HPP
@@ -76,7 +76,7 @@ namespace frommle {
              * @return zero based index of the corresponding entry
              */
         size_t SHtmnGuide::i_from_nmt(int n, int m, trigenum t,int nmax) {
-            size_t shft=(t==trigenum::C)?0:SHnmGuide::i_from_nm(nmax,nmax,nmax);
+            size_t shft=(t==trigenum::C)?0:SHnmGuide::i_from_nm(nmax,nmax,nmax)+1;
             return SHnmGuide::i_from_nm(n,m,nmax)+shft;
         }
         
@@ -96,9 +96,22 @@ namespace frommle {
                 if (nmax_==-1){
                     return 0;
                 }
-                return 2*SHnmGuide::i_from_nm(nmax_,nmax_,nmax_)+1;
+                //note: includes the sine coefficient of the last order
+                return 2*(SHnmGuide::i_from_nm(nmax_,nmax_,nmax_)+1);
          }
 
+        std::vector<size_t> SHtmnGuide::orderBlocks()const{
+            std::vector<size_t> blockends;
+            size_t end=0;
+            for(int t=0;t<2;++t){
+                for(int m=0;m<=nmax_;++m){
+                    end+=nmax_-m+1;
+                    blockends.push_back(end);
+                }
+            }
+            return blockends;
+        }
+
 
         //implementation for SHnmtGuide
 
@@ -108,9 +121,9 @@ namespace frommle {
             
             trigenum t=(idx%2==0)?trigenum::C : trigenum::S;
 
-            double ndbl=(std::sqrt(1.0+8*(idx/2))-1.0)/2.0;
-            n=(int)(ndbl);
-            m=(int)((ndbl-n)*(n+1));
+            const size_t inm=idx/2;
+            n=(int)((std::sqrt(1.0+8*inm)-1.0)/2.0);
+            m=inm-(n*(n+1))/2;
             return std::make_tuple(n,m,t);
         }
 
@@ -119,7 +132,8 @@ namespace frommle {
                 if (nmax_==-1){
                     return 0;
                 }
-                return 2*SHnmGuide::i_from_nm(nmax_,nmax_,nmax_)+1;
+                //note: includes the sine coefficient of the last order
+                return 2*(SHnmGuide::i_from_nm(nmax_,nmax_,nmax_)+1);
          }
 
         std::ostream &operator<<(std::ostream &os, nmtEl const &el){
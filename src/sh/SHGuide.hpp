@@ -85,7 +85,7 @@ namespace frommle{
             using Element=nmtEl;
             using NiGd=NonIndexedGuide<nmtEl>;
             SHtmnGuide():SHGuideMeta(),NiGd("shg"){}
-            SHtmnGuide(const int nmax):SHGuideMeta(nmax,0),NiGd("shg"),size_(2*SHnmGuide::i_from_nm(nmax,nmax,nmax)){}
+            SHtmnGuide(const int nmax):SHGuideMeta(nmax,0),NiGd("shg"),size_(2*(SHnmGuide::i_from_nm(nmax,nmax,nmax)+1)){}
             
             core::typehash hash()const override{return core::typehash("SHtmnGuide_t");}
             static size_t i_from_nmt(int n,int m, trigenum t,int nmax);
@@ -95,6 +95,9 @@ namespace frommle{
             Element elfromi(size_t i) const override;
 
             size_t fullsize()const override;
+
+            ///@brief cumulative end indices of the blocks with a constant order and trigonometric type (cosine orders first, then the sine orders)
+            std::vector<size_t> orderBlocks()const;
             
             private:
             using SHGuideMeta::nmax_;
@@ -22,6 +22,9 @@
 #include "sh/SHGuide.hpp"
 #include "sh/Legendre_nm.hpp"
 #include "core/GOperatorBase.hpp"
+#include "core/Parallel.hpp"
+#include <numeric>
+#include <algorithm>
 
 #ifndef SRC_SH_YNM_HPP_
 #define SRC_SH_YNM_HPP_
@@ -41,11 +44,16 @@ class Ynm:public GOperatorDyn<T,1,1 > {
         using GOpBase=GOperatorDyn<T,1,1>;
         Ynm():GOpBase("Ynm"){}
 
+        ///@brief constructor which registers the output points (nthreads <1 uses all available cores)
+        Ynm(const OGRPointGuide & geog, const int nthreads=0):GOpBase(typename GOpBase::gpo_t(geog),"Ynm"),nthreads_(nthreads){}
+
         /////@brief constructor which uses the "standard SHGuide"
         //Ynm(const int nmax):GOpBase(GuidePack<SHGuide>(SHGuide(nmax))){
 
         //}
 
+        void setNThreads(const int nthreads){nthreads_=nthreads;}
+        int nThreads()const{return nthreads_;}
 
         void fwdOp(const GArrayBase<T,2> & gin, GArrayBase<T,2> &gout){
             //dynamically tryout guide casts
@@ -65,53 +73,110 @@ class Ynm:public GOperatorDyn<T,1,1 > {
 
 
     private:
-        ///@brief templated version of the forward operator 
+        int nthreads_=0;
+        ///@brief maximum number of points which are synthesized together (shares a single matrix-matrix product)
+        static const size_t pntblock=32;
+        ///@brief upper bound (in bytes) of the per thread buffer holding the spherical harmonics of a point block
+        static const size_t ymatbytes=size_t(64)<<20;
+        ///@brief number of work items handed out to a thread at once
+        static const size_t workchunk=16;
+        ///@brief templated version of the forward operator (synthesis from spherical harmonic coefficients to points)
         template<class SHG, class OGRG>
         int fwdOpSpec(const GArrayBase<T,2> & gin, GArrayBase<T,2> & gout){
 
-                //auto shg=gout.gp().template  dyn_as<SHG>(0);
-                //if(! shg){
-                    ////dynamic cast failed for the SHGuide
-                    //return 1;
-                //}
-                //auto geog=gin.gp().template as<OGRG>(0);
-
-                //if(! geog){
-                    ////dynamic cast failed for the geometry guide
-                    //return 2;
-                //}
-                ////initialize associated Legendre functionss
-                //Ynm_cache<T> Ynm_c(shg->nmax());
-
-                //T ynm;
-
-                //gout=0;
-
-                //size_t pidx=0;
-
-                ////denotes all elements in a dimension
-                //auto allinrange=gout.mrange();
-                //auto indices_o=gout.mindices();
-                //auto indices_i=gin.mindices();
-
-                ////typename GArrayBase<T,ndim_i+1>::arr::index_gen indices_i;
-
-                ////loop over input points
-                //for(auto & pnt:*geog ){
-                        //Ynm_c.setlat(pnt->getY()).setlon(pnt->getX());
-
-                        //auto irow=gin.mat()[indices_i[pidx++][allinrange]];
-                        //size_t idx=0;
-                        //for(auto & nmt:*shg){
-                                //auto orow=gout.mat()[indices_o[idx++][allinrange]];
-                                //auto orow_it=orow.begin();
-                                //ynm=Ynm_c[nmt];
-                                //std::for_each(irow.begin(),irow.end(),[&orow_it, &ynm](const T & in){
-                                    //*orow_it+=in*ynm;
-                                    //++orow_it;
-                                //});
-                        //}
-                //}
+                auto shg=gin.gp().template  dyn_as<SHG>(0);
+                if(! shg){
+                    //dynamic cast failed for the SHGuide
+                    return 1;
+                }
+                auto geog=gout.gp().template dyn_as<OGRG>(0);
+
+                if(! geog){
+                    //dynamic cast failed for the geometry guide
+                    return 2;
+                }
+
+                auto ginptr=dynamic_cast<const GArrayDense<T,2>*>(&gin);
+                auto goutptr=dynamic_cast<GArrayDense<T,2>*>(&gout);
+                if(!ginptr or !goutptr){
+                    return 3;
+                }
+
+                //precompute the storage indices of the Legendre functions and the order and trigonometric type of the coefficients
+                const size_t nsh=shg->size();
+                int nmax=0;
+                for(const auto & nmt:*shg){
+                    nmax=std::max(nmax,std::get<0>(nmt));
+                }
+                std::vector<size_t> inm(nsh);
+                std::vector<int> mord(nsh);
+                std::vector<trigenum> trig(nsh);
+                size_t ish=0;
+                for(const auto & nmt:*shg){
+                    inm[ish]=SHnmGuide::i_from_nm(std::get<0>(nmt),std::get<1>(nmt),nmax);
+                    mord[ish]=std::get<1>(nmt);
+                    trig[ish]=std::get<2>(nmt);
+                    ++ish;
+                }
+
+                //group the points by latitude so that the associated Legendre functions can be reused
+                const size_t npnt=geog->size();
+                std::vector<size_t> order(npnt);
+                std::iota(order.begin(),order.end(),0);
+                std::stable_sort(order.begin(),order.end(),[&geog](const size_t i1, const size_t i2){
+                    return (*geog)[i1]->getY() < (*geog)[i2]->getY();
+                });
+
+                //the point block is bounded by the memory needed to store its spherical harmonics
+                const size_t nblkmax=std::max(size_t(1),std::min(size_t(pntblock),ymatbytes/(std::max(nsh,size_t(1))*sizeof(T))));
+
+                //work items consist of a block of points with the same latitude
+                std::vector<std::pair<size_t,size_t>> work;
+                size_t ip0=0;
+                for(size_t ip=1;ip<=npnt;++ip){
+                    if(ip == npnt or ip-ip0 == nblkmax or (*geog)[order[ip]]->getY() != (*geog)[order[ip0]]->getY()){
+                        work.emplace_back(ip0,ip);
+                        ip0=ip;
+                    }
+                }
+
+                //the input coefficients are accessed in place (shared by all threads)
+                using eigmat=Eigen::Matrix<T,Eigen::Dynamic,Eigen::Dynamic>;
+                using eigmatrow=Eigen::Matrix<T,Eigen::Dynamic,Eigen::Dynamic,Eigen::RowMajor>;
+                const auto cin=ginptr->eig();
+                auto outmat=goutptr->eig();
+
+                const int nth=core::nThreads(nthreads_);
+                //one set of cached spherical harmonics and work buffers per thread (allocated upon first use)
+                std::vector<std::unique_ptr<Ynm_cache<T>>> caches(nth);
+                std::vector<eigmatrow> ymats(nth);
+                std::vector<eigmat> results(nth);
+
+                core::parallel_for(work.size(),[&](const int ith, const size_t iw0, const size_t iw1){
+                    if(!caches[ith]){
+                        caches[ith]=std::unique_ptr<Ynm_cache<T>>(new Ynm_cache<T>(nmax));
+                        ymats[ith].resize(static_cast<Eigen::Index>(nblkmax),static_cast<Eigen::Index>(nsh));
+                        results[ith].resize(static_cast<Eigen::Index>(nblkmax),cin.cols());
+                    }
+                    Ynm_cache<T> & Ynm_c=*caches[ith];
+                    eigmatrow & ymat=ymats[ith];
+                    eigmat & res=results[ith];
+                    for(size_t iw=iw0;iw<iw1;++iw){
+                        const size_t nblk=work[iw].second-work[iw].first;
+                        for(size_t ip=0;ip<nblk;++ip){
+                            const auto & pnt=(*geog)[order[work[iw].first+ip]];
+                            Ynm_c.setlat(pnt->getY()).setlon(pnt->getX());
+                            for(size_t i=0;i<nsh;++i){
+                                ymat(ip,i)=Ynm_c(inm[i],mord[i],trig[i]);
+                            }
+                        }
+                        //synthesize all columns at once
+                        res.topRows(nblk).noalias()=ymat.topRows(nblk)*cin;
+                        for(size_t ip=0;ip<nblk;++ip){
+                            outmat.row(order[work[iw].first+ip])=res.row(ip);
+                        }
+                    }
+                },nth,workchunk);
 
                 //success
                 return 0;
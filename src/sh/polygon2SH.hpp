@@ -0,0 +1,360 @@
+/*! \file
+ \brief Operator which expands (weighted) polygons into spherical harmonic coefficients
+ \copyright Roelof Rietbroek 2021
+ \license
+ This file is part of Frommle.
+ frommle is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3 of the License, or (at your option) any later version.
+
+ Frommle is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with Frommle; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "core/GOperatorBase.hpp"
+#include "core/GArrayDense.hpp"
+#include "core/IndexGuide.hpp"
+#include "core/Parallel.hpp"
+#include "geometry/OGRGuide.hpp"
+#include "geometry/GeoGrid.hpp"
+#include "sh/SHGuide.hpp"
+#include "sh/SHGridOperators.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <tuple>
+#include <vector>
+
+#ifndef SRC_SH_POLYGON2SH_HPP_
+#define  SRC_SH_POLYGON2SH_HPP_
+
+namespace frommle{
+   namespace sh{
+
+    /*!@brief Operator which computes spherical harmonic coefficients of polygon indicator functions (1 inside, 0 outside)
+     * The polygons (lon/lat in degrees) are rasterized on an internal global quadrature grid, after which a grid analysis yields the coefficients.
+     * The input has an OGRPolyGuide as first dimension and each output column holds the sum of the indicator functions weighted by the input column,
+     * so applying the operator to a guide of polygons directly gives one column per polygon.
+     * Grid rows are rasterized in parallel, and the rtree of the polygon guide prunes the polygons which can not overlap a row.
+     * Only the latitude rows covered by the polygons are rasterized, in chunks of rows which are analyzed (and accumulated) one after another.
+     */
+    template<class T>
+    class Polygon2SH:public core::GOperatorDyn<T,1,1>{
+    public:
+        using GOpBase=core::GOperatorDyn<T,1,1>;
+        using GOpBase::operator();
+        Polygon2SH():GOpBase("Polygon2SH"){}
+        ///@brief constructor which registers the output spherical harmonic guide
+        /// The quadrature grid is oversample times finer than needed for the analysis (nthreads <1 uses all available cores)
+        Polygon2SH(const guides::SHGuide & shg, const int oversample=2, const int nthreads=0):GOpBase(typename GOpBase::gpo_t(shg),"Polygon2SH"),oversample_(oversample),nthreads_(nthreads){
+            if(oversample_ < 1){
+                THROWINPUTEXCEPTION("The oversampling factor of the quadrature grid must be at least 1");
+            }
+        }
+
+        bool isLinear()const override{return true;}
+        void setNThreads(const int nthreads){nthreads_=nthreads;}
+        int nThreads()const{return nthreads_;}
+        int oversample()const{return oversample_;}
+
+        ///@brief global pixel registered grid on which the polygons are rasterized
+        guides::GeoGrid quadratureGrid(const int nmax)const{
+            const double dgrid=180.0/(2*oversample_*(nmax+1));
+            return guides::GeoGrid(-180.0,180.0,-90.0,90.0,dgrid,dgrid,guides::GeoGrid::pix);
+        }
+
+        void fwdOp(const core::GArrayBase<T,2> & gin, core::GArrayBase<T,2> &gout)override;
+
+        ///@brief expand every polygon of the guide separately (the output has one column per polygon)
+        std::shared_ptr<core::GArrayBase<T,2>> operator()(const guides::OGRPolyGuide & polys);
+
+    private:
+        int oversample_=2;
+        int nthreads_=0;
+        ///@brief maximum amount of rasterized values which are kept in memory (latitude rows are processed in chunks)
+        static const size_t maxcells=size_t(1)<<24;
+        ///@brief maximum amount of columns which are rasterized together
+        static const size_t maxcolumns=32;
+
+        /*!@brief vertices of all rings of a polygon, ringstart holds the first vertex of each ring (and the total as last entry)
+         * Longitudes are unwrapped, so that rings crossing the dateline (e.g. stored as 170 -> -170) become continuous (170 -> 190).
+         * Interior rings are shifted by a multiple of 360 degrees to lie closest to the exterior ring
+         */
+        struct PolyRings{
+            std::vector<double> x{};
+            std::vector<double> y{};
+            std::vector<size_t> ringstart{0};
+            ///@brief latitude extent of the polygon
+            double ymin=std::numeric_limits<double>::max();
+            double ymax=std::numeric_limits<double>::lowest();
+            void append(const OGRLinearRing * ring){
+                if(!ring or ring->getNumPoints() == 0){
+                    return;
+                }
+                const size_t i0=x.size();
+                double shift=0;
+                double xprev=ring->getX(0);
+                double xsum=0;
+                for(int i=0;i<ring->getNumPoints();++i){
+                    const double dx=ring->getX(i)+shift-xprev;
+                    //edges spanning exactly 360 degrees (e.g. -180 -> 180 of global bands) are genuine and kept
+                    if(dx > 180.0 and dx < 360.0){
+                        shift-=360.0;
+                    }else if(dx < -180.0 and dx > -360.0){
+                        shift+=360.0;
+                    }
+                    xprev=ring->getX(i)+shift;
+                    x.push_back(xprev);
+                    y.push_back(ring->getY(i));
+                    ymin=std::min(ymin,y.back());
+                    ymax=std::max(ymax,y.back());
+                    xsum+=xprev;
+                }
+                const double xmean=xsum/(x.size()-i0);
+                if(i0 == 0){
+                    xref_=xmean;
+                }else{
+                    const double ringshift=360.0*std::round((xref_-xmean)/360.0);
+                    std::for_each(x.begin()+i0,x.end(),[ringshift](double & xv){xv+=ringshift;});
+                }
+                ringstart.push_back(x.size());
+            }
+        private:
+            ///@brief mean longitude of the exterior ring
+            double xref_=0;
+        };
+
+        static std::vector<PolyRings> polygonRings(const guides::OGRPolyGuide & polys){
+            std::vector<PolyRings> rings(polys.size());
+            for(size_t ip=0;ip<polys.size();++ip){
+                const OGRPolygon & poly=*polys[ip];
+                rings[ip].append(poly.getExteriorRing());
+                for(int ir=0;ir<poly.getNumInteriorRings();++ir){
+                    rings[ip].append(poly.getInteriorRing(ir));
+                }
+            }
+            return rings;
+        }
+
+        ///@brief sorted longitudes where the polygon boundary crosses a parallel (pairs enclose the interior, holes follow from the even-odd rule)
+        static void crossings(const PolyRings & pr, const double lat, std::vector<double> & xcross){
+            xcross.clear();
+            for(size_t ir=0;ir+1<pr.ringstart.size();++ir){
+                const size_t i0=pr.ringstart[ir];
+                const size_t i1=pr.ringstart[ir+1];
+                if(i1-i0 < 3){
+                    continue;
+                }
+                //note: the closing edge is included (it is degenerate for explicitly closed rings)
+                size_t iprev=i1-1;
+                for(size_t i=i0;i<i1;++i){
+                    const double ya=pr.y[iprev];
+                    const double yb=pr.y[i];
+                    if((ya <= lat) != (yb <= lat)){
+                        xcross.push_back(pr.x[iprev]+(lat-ya)*(pr.x[i]-pr.x[iprev])/(yb-ya));
+                    }
+                    iprev=i;
+                }
+            }
+            std::sort(xcross.begin(),xcross.end());
+        }
+
+        ///@brief latitudes of the cell centres of the grid rows
+        static std::vector<double> rowLatitudes(const guides::GeoGrid & grid){
+            std::vector<double> latc(grid.nlat());
+            for(size_t ilat=0;ilat<latc.size();++ilat){
+                std::tie(std::ignore,latc[ilat])=grid.lonlat(0,ilat);
+            }
+            return latc;
+        }
+
+        ///@brief rows [first,second) whose cell centres lie within [ymin,ymax] (the latitudes may be sorted either way)
+        static std::pair<size_t,size_t> rowRange(const std::vector<double> & latc, const double ymin, const double ymax){
+            size_t i0,i1;
+            if(latc.size() < 2 or latc.front() < latc.back()){
+                i0=std::lower_bound(latc.begin(),latc.end(),ymin)-latc.begin();
+                i1=std::upper_bound(latc.begin(),latc.end(),ymax)-latc.begin();
+            }else{
+                i0=std::lower_bound(latc.begin(),latc.end(),ymax,std::greater<double>())-latc.begin();
+                i1=std::upper_bound(latc.begin(),latc.end(),ymin,std::greater<double>())-latc.begin();
+            }
+            return std::make_pair(i0,std::max(i0,i1));
+        }
+
+        template<class Min>
+        void expandBlock(const SHGridEngine<T> & engine, const guides::GeoGrid & grid, const std::vector<double> & latc, const guides::OGRPolyGuide & polys,
+                         const std::vector<PolyRings> & rings, const std::vector<char> & active, const Min & weights, core::GArrayDense<T,2> & coef)const;
+
+        template<class Min, class Mout>
+        void rasterize(const guides::GeoGrid & grid, const guides::OGRPolyGuide & polys, const std::vector<PolyRings> & rings,
+                       const std::vector<char> & active, const Min & weights, const size_t ilat0, const size_t ilat1, Mout & cells)const;
+    };
+
+    template<class T>
+    template<class Min, class Mout>
+    void Polygon2SH<T>::rasterize(const guides::GeoGrid & grid, const guides::OGRPolyGuide & polys, const std::vector<PolyRings> & rings,
+                                  const std::vector<char> & active, const Min & weights, const size_t ilat0, const size_t ilat1, Mout & cells)const{
+        using box=typename guides::OGRPolyGuide::box;
+        using point=typename guides::OGRPolyGuide::point;
+        const auto & rtree=polys.getRtree();
+        const ptrdiff_t nlon=grid.nlon();
+        const double dlon=grid.dlon();
+        const double xmax=std::numeric_limits<double>::max();
+        double lon0;
+        std::tie(lon0,std::ignore)=grid.lonlat(0,0);
+
+        //rows are independent, so every thread writes to its own part of the cells (which start at row ilat0)
+        core::parallel_for(ilat1-ilat0,[&](const int ith, const size_t i0, const size_t i1){
+            std::vector<typename guides::OGRPolyGuide::idxmap> candidates;
+            std::vector<size_t> ipolys;
+            std::vector<double> xcross;
+            for(size_t ilat=ilat0+i0;ilat<ilat0+i1;++ilat){
+                double latc;
+                std::tie(std::ignore,latc)=grid.lonlat(0,ilat);
+                //only polygons whose envelope intersects the parallel through the cell centres can contribute
+                candidates.clear();
+                rtree.query(bgi::intersects(box(point(-xmax,latc),point(xmax,latc))),std::back_inserter(candidates));
+                ipolys.clear();
+                for(const auto & cand:candidates){
+                    if(active[cand.second]){
+                        ipolys.push_back(cand.second);
+                    }
+                }
+                //fixed summation order for overlapping polygons
+                std::sort(ipolys.begin(),ipolys.end());
+
+                const size_t rowstart=(ilat-ilat0)*nlon;
+                for(auto ip:ipolys){
+                    crossings(rings[ip],latc,xcross);
+                    for(size_t k=0;k+1<xcross.size();k+=2){
+                        //cell centres in [xa,xb), wrapped around the globe
+                        ptrdiff_t ia=std::ceil((xcross[k]-lon0)/dlon);
+                        ptrdiff_t ib=std::ceil((xcross[k+1]-lon0)/dlon);
+                        ib=std::min(ib,ia+nlon);
+                        for(ptrdiff_t i=ia;i<ib;++i){
+                            const ptrdiff_t ilon=((i%nlon)+nlon)%nlon;
+                            cells.row(rowstart+ilon)+=weights.row(ip);
+                        }
+                    }
+                }
+            }
+        },nthreads_);
+    }
+
+    /*!@brief rasterize and analyze a block of columns (weights holds one row per polygon), the coefficients are written to the first columns of coef
+     * Only the latitude band covered by the active polygons is rasterized, in chunks of at most maxcells values
+     */
+    template<class T>
+    template<class Min>
+    void Polygon2SH<T>::expandBlock(const SHGridEngine<T> & engine, const guides::GeoGrid & grid, const std::vector<double> & latc, const guides::OGRPolyGuide & polys,
+                                    const std::vector<PolyRings> & rings, const std::vector<char> & active, const Min & weights, core::GArrayDense<T,2> & coef)const{
+        size_t ilat0=latc.size();
+        size_t ilat1=0;
+        for(size_t ip=0;ip<rings.size();++ip){
+            if(!active[ip]){
+                continue;
+            }
+            const auto rows=rowRange(latc,rings[ip].ymin,rings[ip].ymax);
+            if(rows.first < rows.second){
+                ilat0=std::min(ilat0,rows.first);
+                ilat1=std::max(ilat1,rows.second);
+            }
+        }
+
+        coef.eig().setZero();
+        const size_t nlon=grid.nlon();
+        const size_t nb=weights.cols();
+        const size_t chunk=std::max(size_t(1),maxcells/(nlon*nb));
+        for(size_t r0=ilat0;r0<ilat1;r0+=chunk){
+            const size_t nr=std::min(chunk,ilat1-r0);
+            auto cells=core::createDenseGAr<T>::zeros(guides::IndexGuide(nr*nlon),guides::IndexGuide(nb));
+            auto cellmat=cells.eig();
+            rasterize(grid,polys,rings,active,weights,r0,r0+nr,cellmat);
+            engine.analysis(cells,coef,nthreads_,r0,true);
+        }
+    }
+
+    template<class T>
+    void Polygon2SH<T>::fwdOp(const core::GArrayBase<T,2> & gin, core::GArrayBase<T,2> &gout){
+        auto polys=gin.gp().template dyn_as<guides::OGRPolyGuide>(0);
+        auto shg=gout.gp().template dyn_as<guides::SHGuide>(0);
+        if(!polys or !shg){
+            THROWINPUTEXCEPTION("Polygon2SH requires an OGRPolyGuide as input and an SHGuide as output");
+        }
+        const auto inmat=gin.template as<const core::GArrayDense<T,2>*>()->eig();
+        auto outmat=gout.template as<core::GArrayDense<T,2>*>()->eig();
+        const size_t ncol=inmat.cols();
+
+        const guides::GeoGrid grid=quadratureGrid(shg->nmax());
+        SHGridEngine<T> engine(*shg,grid,true);
+        const auto rings=polygonRings(*polys);
+        const auto latc=rowLatitudes(grid);
+
+        const size_t nblock=std::max(size_t(1),std::min(ncol,size_t(maxcolumns)));
+        auto coef=core::createDenseGAr<T>::zeros(*shg,guides::IndexGuide(nblock));
+        std::vector<char> active(polys->size());
+        for(size_t cb0=0;cb0<ncol;cb0+=nblock){
+            const size_t nb=std::min(nblock,ncol-cb0);
+            //polygons without weight in this block don't need to be rasterized
+            for(size_t ip=0;ip<polys->size();++ip){
+                active[ip]=(inmat.block(ip,cb0,1,nb).array() != T(0)).any();
+            }
+            expandBlock(engine,grid,latc,*polys,rings,active,inmat.middleCols(cb0,nb),coef);
+            outmat.middleCols(cb0,nb)=coef.eig().leftCols(nb);
+        }
+    }
+
+    template<class T>
+    std::shared_ptr<core::GArrayBase<T,2>> Polygon2SH<T>::operator()(const guides::OGRPolyGuide & polys){
+        auto shg=this->gpo_->template dyn_as<guides::SHGuide>(0);
+        if(!shg){
+            THROWMETHODEXCEPTION("Polygon2SH requires an SHGuide as output guide");
+        }
+        auto gout=std::make_shared<core::GArrayDense<T,2>>(this->gpo_->append(guides::GuideRegistry::Gvar(std::make_shared<guides::OGRPolyGuide>(polys))));
+        auto outmat=gout->eig();
+
+        const guides::GeoGrid grid=quadratureGrid(shg->nmax());
+        SHGridEngine<T> engine(*shg,grid,true);
+        const auto rings=polygonRings(polys);
+        const auto latc=rowLatitudes(grid);
+
+        //polygons which are close in latitude share a block, so the rasterized band stays narrow
+        const size_t npoly=polys.size();
+        std::vector<size_t> order(npoly);
+        std::iota(order.begin(),order.end(),0);
+        std::sort(order.begin(),order.end(),[&rings](const size_t i1, const size_t i2){return rings[i1].ymin < rings[i2].ymin;});
+
+        const size_t nblock=std::max(size_t(1),std::min(npoly,size_t(maxcolumns)));
+        auto coef=core::createDenseGAr<T>::zeros(*shg,guides::IndexGuide(nblock));
+        Eigen::Matrix<T,Eigen::Dynamic,Eigen::Dynamic> weights(npoly,nblock);
+        std::vector<char> active(npoly);
+        for(size_t cb0=0;cb0<npoly;cb0+=nblock){
+            const size_t nb=std::min(nblock,npoly-cb0);
+            //unit weight for the polygon of each column
+            weights.setZero();
+            std::fill(active.begin(),active.end(),0);
+            for(size_t j=0;j<nb;++j){
+                weights(order[cb0+j],j)=1;
+                active[order[cb0+j]]=1;
+            }
+            expandBlock(engine,grid,latc,polys,rings,active,weights.leftCols(nb),coef);
+            for(size_t j=0;j<nb;++j){
+                outmat.col(order[cb0+j])=coef.eig().col(j);
+            }
+        }
+        return gout;
+    }
+
+   }
+}
+
+#endif
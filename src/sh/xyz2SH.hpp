@@ -1,6 +1,5 @@
-
 /*! \file
- \brief 
+ \brief Least-squares estimation of spherical harmonic coefficients from scattered point values
  \copyright Roelof Rietbroek 2021
  \license
  This file is part of Frommle.
@@ -21,18 +20,202 @@
 
 
 #include "core/GArrayDense.hpp"
+#include "core/GOperatorBase.hpp"
+#include "core/Parallel.hpp"
+#include "geometry/OGRGuide.hpp"
+#include "sh/SHGuide.hpp"
+#include "sh/Legendre_nm.hpp"
+#include <eigen3/Eigen/Cholesky>
+#include <algorithm>
+#include <memory>
 
 #ifndef SRC_SH_XYZ2SH_HPP_
 #define  SRC_SH_XYZ2SH_HPP_
 
 namespace frommle{
    namespace sh{
-    
-    frommle::core::GArrayDense<double,1> xyz2sh();
+
+    /*!@brief Operator which estimates spherical harmonic coefficients from values at scattered points (OGRPointGuide) by least squares
+     * The normal equations are accumulated per batch of points, so the full design matrix is never stored.
+     * Batches can be added in steps with accumulate() followed by solve(), or all at once by applying the operator.
+     * The accumulation order is fixed, so the result does not depend on the number of threads.
+     * Sine coefficients of order zero vanish identically, they are not estimated and are returned as zero.
+     */
+    template<class T>
+    class XYZ2SH:public core::GOperatorDyn<T,1,1>{
+    public:
+        using GOpBase=core::GOperatorDyn<T,1,1>;
+        using eigmat=Eigen::Matrix<T,Eigen::Dynamic,Eigen::Dynamic>;
+        XYZ2SH():GOpBase("XYZ2SH"){}
+        ///@brief constructor which registers the output spherical harmonic guide (nthreads <1 uses all available cores)
+        XYZ2SH(const guides::SHGuide & shg, const int nthreads=0):GOpBase(typename GOpBase::gpo_t(shg),"XYZ2SH"),nthreads_(nthreads){
+            initIndices(shg);
+        }
+
+        void setNThreads(const int nthreads){nthreads_=nthreads;}
+        int nThreads()const{return nthreads_;}
+
+        ///@brief number of points which have been added to the normal equations
+        size_t nobs()const{return nobs_;}
+        ///@brief access the (upper triangle of the) normal matrix (only holds the estimated coefficients, see estimated())
+        const eigmat & N()const{return N_;}
+        ///@brief positions in the SHGuide of the estimated coefficients (the rows of N and rhs)
+        const std::vector<size_t> & estimated()const{return iest_;}
+        ///@brief access the right hand side(s) of the normal equations
+        const eigmat & rhs()const{return rhs_;}
+
+        ///@brief clear the normal equations and prepare them for ncol right hand sides
+        void reset(const size_t ncol){
+            const Eigen::Index nsh=inm_.size();
+            N_=eigmat::Zero(nsh,nsh);
+            rhs_=eigmat::Zero(nsh,static_cast<Eigen::Index>(ncol));
+            nobs_=0;
+        }
+
+        ///@brief add a set of point observations (first dimension must be an OGRPointGuide) to the normal equations
+        void accumulate(const core::GArrayBase<T,2> & obs){
+            auto geog=obs.gp().template dyn_as<guides::OGRPointGuide>(0);
+            if(!geog){
+                THROWINPUTEXCEPTION("XYZ2SH requires an OGRPointGuide as first input dimension");
+            }
+            auto obsptr=obs.template as<const core::GArrayDense<T,2>*>();
+            const Eigen::Index ncol=obsptr->mat().shape()[1];
+            if(rhs_.size() == 0 and nobs_ == 0){
+                reset(ncol);
+            }else if(ncol != rhs_.cols()){
+                THROWINPUTEXCEPTION("The amount of columns of the observations does not match the normal equations");
+            }
+
+            const auto obsmat=obsptr->eig();
+            const size_t npnt=geog->size();
+            //one set of cached spherical harmonics per thread (allocated upon first use and shared by all batches)
+            std::vector<std::unique_ptr<Ynm_cache<T>>> caches(core::nThreads(nthreads_));
+            for(size_t ip0=0;ip0<npnt;ip0+=pntbatch){
+                const size_t nb=std::min(size_t(pntbatch),npnt-ip0);
+                accumulateBatch(*geog,ip0,nb,obsmat.middleRows(ip0,nb),caches);
+            }
+            nobs_+=npnt;
+        }
+
+        ///@brief solve the accumulated normal equations with a Cholesky decomposition
+        void solve(core::GArrayBase<T,2> & gout)const{
+            auto shg=gout.gp().template dyn_as<guides::SHGuide>(0);
+            if(!shg or shg->size() != nguide_){
+                THROWINPUTEXCEPTION("XYZ2SH requires an output SHGuide which matches the operator");
+            }
+            if(nobs_ == 0){
+                THROWMETHODEXCEPTION("No observations have been accumulated in the normal equations");
+            }
+            Eigen::LLT<eigmat,Eigen::Upper> llt(N_);
+            if(llt.info() != Eigen::Success){
+                THROWMETHODEXCEPTION("Normal matrix is not positive definite, the points do not sufficiently constrain the spherical harmonic coefficients");
+            }
+            const eigmat sol=llt.solve(rhs_);
+            auto outmat=gout.template as<core::GArrayDense<T,2>*>()->eig();
+            outmat.setZero();
+            for(size_t i=0;i<iest_.size();++i){
+                outmat.row(iest_[i])=sol.row(i);
+            }
+        }
+
+        void fwdOp(const core::GArrayBase<T,2> & gin, core::GArrayBase<T,2> &gout)override{
+            reset(gin.template as<const core::GArrayDense<T,2>*>()->mat().shape()[1]);
+            accumulate(gin);
+            solve(gout);
+        }
+
+    private:
+        int nthreads_=0;
+        int nmax_=0;
+        size_t nguide_=0;
+        size_t nobs_=0;
+        eigmat N_{};
+        eigmat rhs_{};
+        std::vector<size_t> inm_{};
+        std::vector<int> mord_{};
+        std::vector<guides::trigenum> trig_{};
+        std::vector<size_t> iest_{};
+        ///@brief number of points which are added to the normal equations in one go
+        static const size_t pntbatch=256;
+        ///@brief number of points for which the design matrix rows are computed by a single work item
+        static const size_t pntchunk=32;
+        ///@brief size of the square tiles of the normal matrix which are updated by a single work item
+        static const Eigen::Index tile=64;
+
+        void initIndices(const guides::SHGuide & shg){
+            //the guide may be constructed from arbitrary elements, so the maximum degree is taken from the elements themselves
+            nmax_=0;
+            for(const auto & nmt:shg){
+                nmax_=std::max(nmax_,std::get<0>(nmt));
+            }
+            nguide_=shg.size();
+            size_t ish=0;
+            for(const auto & nmt:shg){
+                const int m=std::get<1>(nmt);
+                const auto t=std::get<2>(nmt);
+                if(m != 0 or t != guides::trigenum::S){
+                    inm_.push_back(guides::SHnmGuide::i_from_nm(std::get<0>(nmt),m,nmax_));
+                    mord_.push_back(m);
+                    trig_.push_back(t);
+                    iest_.push_back(ish);
+                }
+                ++ish;
+            }
+        }
+
+        template<class Derived>
+        void accumulateBatch(const guides::OGRPointGuide & geog, const size_t ip0, const size_t nb, const Eigen::MatrixBase<Derived> & obs, std::vector<std::unique_ptr<Ynm_cache<T>>> & caches){
+            const Eigen::Index nsh=inm_.size();
+            const int nth=caches.size();
+
+            //compute the design matrix of this batch in parallel over chunks of points (rows are independent)
+            eigmat A(static_cast<Eigen::Index>(nb),nsh);
+            core::parallel_for(nb,[&](const int ith, const size_t ib0, const size_t ib1){
+                if(!caches[ith]){
+                    caches[ith]=std::unique_ptr<Ynm_cache<T>>(new Ynm_cache<T>(nmax_));
+                }
+                Ynm_cache<T> & Ynm_c=*caches[ith];
+                for(size_t ib=ib0;ib<ib1;++ib){
+                    const auto & pnt=geog[ip0+ib];
+                    Ynm_c.setlat(pnt->getY()).setlon(pnt->getX());
+                    for(Eigen::Index i=0;i<nsh;++i){
+                        A(ib,i)=Ynm_c(inm_[i],mord_[i],trig_[i]);
+                    }
+                }
+            },nth,pntchunk);
+
+            //update the upper triangular tiles of the normal matrix and the right hand side
+            //note: each tile is always updated by the same operation, independent of the thread which executes it
+            const Eigen::Index ntile=(nsh+tile-1)/tile;
+            std::vector<std::pair<Eigen::Index,Eigen::Index>> work;
+            for(Eigen::Index ti=0;ti<ntile;++ti){
+                //a negative column tile denotes an update of the right hand side
+                work.emplace_back(ti,-1);
+                for(Eigen::Index tj=ti;tj<ntile;++tj){
+                    work.emplace_back(ti,tj);
+                }
+            }
+
+            core::parallel_for(work.size(),[&](const int ith, const size_t iw0, const size_t iw1){
+                for(size_t iw=iw0;iw<iw1;++iw){
+                    const Eigen::Index r0=work[iw].first*tile;
+                    const Eigen::Index nr=std::min(Eigen::Index(tile),nsh-r0);
+                    if(work[iw].second < 0){
+                        rhs_.middleRows(r0,nr).noalias()+=A.middleCols(r0,nr).transpose()*obs;
+                    }else{
+                        const Eigen::Index c0=work[iw].second*tile;
+                        const Eigen::Index nc=std::min(Eigen::Index(tile),nsh-c0);
+                        N_.block(r0,c0,nr,nc).noalias()+=A.middleCols(r0,nr).transpose()*A.middleCols(c0,nc);
+                    }
+                }
+            },nth);
+        }
+
+    };
 
 
     }
 }
 
 
-#endif 
+#endif
@@ -0,0 +1,56 @@
+# This file is part of Frommle
+# Frommle is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 3 of the License, or (at your option) any later version.
+
+# Frommle is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Lesser General Public License for more details.
+
+# You should have received a copy of the GNU Lesser General Public
+# License along with Frommle; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+# Author Roelof Rietbroek (roelof@geod.uni-bonn.de), 2020
+import unittest
+import os
+import time
+import math
+from concurrent.futures import ThreadPoolExecutor
+from frommle.sh import Legendre_nm
+
+nmax=600
+ncalls=200
+
+def computeLegendre(ithread):
+    """compute associated Legendre functions for a range of latitudes with a private instance"""
+    pnm=Legendre_nm(nmax)
+    for i in range(ncalls):
+        pnm.set(math.cos((ithread+i/ncalls)*math.pi/180))
+    return ithread
+
+
+class testGILRelease(unittest.TestCase):
+    @unittest.skipIf((os.cpu_count() or 1) < 4, "needs at least 4 cores to show a speedup")
+    def testLegendreThreads(self):
+        nthreads=4
+        t0=time.perf_counter()
+        for ithread in range(nthreads):
+            computeLegendre(ithread)
+        tserial=time.perf_counter()-t0
+
+        t0=time.perf_counter()
+        with ThreadPoolExecutor(max_workers=nthreads) as pool:
+            self.assertEqual(list(pool.map(computeLegendre,range(nthreads))),list(range(nthreads)))
+        tthreaded=time.perf_counter()-t0
+
+        speedup=tserial/tthreaded
+        print("Legendre_nm.set speedup with %d python threads: %.2f"%(nthreads,speedup))
+        #the copy of the result still holds the GIL, so the speedup is not ideal
+        self.assertGreater(speedup,1.5)
+
+
+if __name__ == "__main__":
+    unittest.main()
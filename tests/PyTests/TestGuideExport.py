@@ -0,0 +1,60 @@
+# This file is part of Frommle
+# Frommle is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 3 of the License, or (at your option) any later version.
+
+# Frommle is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Lesser General Public License for more details.
+
+# You should have received a copy of the GNU Lesser General Public
+# License along with Frommle; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+# Author Roelof Rietbroek (roelof@geod.uni-bonn.de), 2020
+import unittest
+import numpy as np
+from frommle.core import monthlyRange,makeGArray
+from frommle.sh import SHnmtGuide,SHnmGuide
+from frommle.geometry import makeFibonacciGrid
+
+
+class testGuideExport(unittest.TestCase):
+    def testSH(self):
+        nmax=20
+        shg=SHnmtGuide(nmax)
+        arr=np.array(shg)
+        self.assertEqual(arr.dtype.names,("n","m","t"))
+        self.assertEqual(arr.dtype["n"],np.int32)
+        self.assertEqual(len(arr),len(shg))
+        for i in [0,1,len(shg)//2,len(shg)-1]:
+            self.assertEqual(tuple(arr[i])[0:2],tuple(shg[i])[0:2])
+
+        arrnm=np.array(SHnmGuide(nmax))
+        self.assertEqual(arrnm.dtype.names,("n","m"))
+        self.assertTrue(np.all(arrnm["m"] <= arrnm["n"]))
+
+    def testTime(self):
+        tg=monthlyRange(2011,4,2012,4)
+        arr=np.array(tg)
+        self.assertEqual(arr.dtype,np.dtype("datetime64[D]"))
+        self.assertEqual(arr[0],np.datetime64(tg[0].date()))
+
+    def testPoints(self):
+        pg=makeFibonacciGrid(1000)
+        arr=np.array(pg)
+        self.assertEqual(arr.dtype.names,("lon","lat"))
+        self.assertEqual(len(arr),1000)
+        self.assertTrue(np.all(np.abs(arr["lat"]) <= 90))
+
+    def testXarray(self):
+        gar=makeGArray(SHnmtGuide(10),monthlyRange(2011,4,2012,4))
+        xar=gar.xar()
+        self.assertEqual(xar.shape,gar.mat.shape)
+        self.assertEqual(list(xar.indexes[xar.dims[0]].names),["n","m","t"])
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,82 @@
+# This file is part of Frommle
+# Frommle is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 3 of the License, or (at your option) any later version.
+
+# Frommle is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Lesser General Public License for more details.
+
+# You should have received a copy of the GNU Lesser General Public
+# License along with Frommle; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+# Author Roelof Rietbroek (roelof@geod.uni-bonn.de), 2020
+import unittest
+import numpy as np
+from frommle.core import IndexGuide
+from frommle.core.garray import makeGArray
+
+
+def bufferAddress(arr):
+    return arr.__array_interface__["data"][0]
+
+
+def alignedArange(shape,align=64):
+    """Returns a float64 arange whose buffer is aligned to align bytes (covers any Eigen alignment requirement)"""
+    n=int(np.prod(shape))
+    buf=np.empty(n+align//8)
+    off=(-bufferAddress(buf)%align)//8
+    data=buf[off:off+n].reshape(shape)
+    data[...]=np.arange(n).reshape(shape)
+    return data
+
+
+class testNumpyZeroCopy(unittest.TestCase):
+    def testShared(self):
+        """A C-contiguous and aligned float64 array is used as storage without copying"""
+        data=alignedArange([3,4])
+        gar=makeGArray(IndexGuide(3),IndexGuide(4),data=data)
+        self.assertEqual(bufferAddress(gar.mat),bufferAddress(data))
+        #modifications are visible from both sides
+        data[1,2]=-1.0
+        self.assertEqual(gar.mat[1,2],-1.0)
+
+    def testLifetime(self):
+        """The garray keeps the numpy buffer alive"""
+        data=alignedArange([3,4])
+        addr=bufferAddress(data)
+        gar=makeGArray(IndexGuide(3),IndexGuide(4),data=data)
+        del data
+        self.assertEqual(bufferAddress(gar.mat),addr)
+        self.assertTrue(np.array_equal(gar.mat,np.arange(12.0).reshape(3,4)))
+
+    def testCopied(self):
+        """Non-contiguous or type mismatched input is copied"""
+        data=np.arange(12.0).reshape(4,3).T
+        gar=makeGArray(IndexGuide(3),IndexGuide(4),data=data)
+        self.assertNotEqual(bufferAddress(gar.mat),bufferAddress(data))
+        self.assertTrue(np.array_equal(gar.mat,data))
+
+        idata=np.arange(12,dtype=np.int32).reshape(3,4)
+        gar=makeGArray(IndexGuide(3),IndexGuide(4),data=idata)
+        self.assertNotEqual(bufferAddress(gar.mat),bufferAddress(idata))
+        self.assertTrue(np.array_equal(gar.mat,idata))
+
+    def testMisaligned(self):
+        """Views which are only element aligned are copied (dense garrays are mapped as aligned Eigen matrices)"""
+        base=alignedArange([15])
+        data=base[1:].reshape(2,7)
+        gar=makeGArray(IndexGuide(2),IndexGuide(7),data=data)
+        self.assertNotEqual(bufferAddress(gar.mat),bufferAddress(data))
+        self.assertTrue(np.array_equal(gar.mat,data))
+
+    def testShape(self):
+        with self.assertRaises(Exception):
+            makeGArray(IndexGuide(3),IndexGuide(5),data=np.zeros([3,4]))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,46 @@
+# This file is part of Frommle
+# Frommle is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 3 of the License, or (at your option) any later version.
+
+# Frommle is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Lesser General Public License for more details.
+
+# You should have received a copy of the GNU Lesser General Public
+# License along with Frommle; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+# Author Roelof Rietbroek (roelof@wobbly.earth), 2021
+import unittest
+import numpy as np
+from frommle.core import makeGArray,IndexGuide
+from frommle.sh import SHGuide,trig,xyz2sh
+from frommle.geometry import makeFibonacciGrid
+
+
+class testXYZ2SH(unittest.TestCase):
+    def testEstimate(self):
+        nmax=6
+        pg=makeFibonacciGrid(2000)
+        pnts=np.array(pg)
+        sinlat=np.sin(np.deg2rad(pnts["lat"]))
+        #a constant field and a (4 pi normalized) zonal degree 1 field
+        data=np.column_stack([2.0*np.ones(len(pnts)),np.sqrt(3.0)*sinlat])
+        obs=makeGArray(pg,IndexGuide(2),data=data)
+
+        est=xyz2sh(obs,nmax,nthreads=2)
+
+        shg=SHGuide(nmax)
+        ref=np.zeros([len(shg),2])
+        ref[shg.idx((0,0,trig.c)),0]=2.0
+        ref[shg.idx((1,0,trig.c)),1]=1.0
+        self.assertEqual(est.mat.shape,ref.shape)
+        #note: this includes the order zero sine coefficients, which are returned as zero
+        self.assertTrue(np.allclose(est.mat,ref,atol=1e-9))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -19,12 +19,16 @@ import unittest
 from frommle.io.shio import shopen,formats
 from frommle.sh import SHnmtGuide,trig
 from frommle.core import logInfo
+from frommle.core.logger import logger
 from frommle.core.garray import makeGArray
 from datetime import datetime
 import gzip
 import io
 import numpy as np
 import os
+import time
+from frommle.io.icgem import SHicgemArchive
+from frommle.io.GSM import SHGSMv6Archive
 
 def makeTestSh(shg):
     """Make a test garray from a Spherical harmonic guide"""
@@ -113,6 +117,31 @@ class SHIO(unittest.TestCase):
 
 
 
+    def test_native(self):
+        """Compare the C++ readers with the python implementations (values and timing)"""
+        files=[("../data/ITSG-Grace2018_n60_2010-04.gfc.gz",SHicgemArchive),
+               ("../data/GSM-2_2008001-2008031_GRAC_UTCSR_BA01_0600.gz",SHGSMv6Archive)]
+        nrep=5
+        for fname,archive in files:
+            res={}
+            for native in [True,False]:
+                t0=time.perf_counter()
+                for i in range(nrep):
+                    shar=archive(fname,native=native)
+                    shar.fload()
+                dt=(time.perf_counter()-t0)/nrep
+                cnm=makeGArray(SHnmtGuide(),name="cnm")
+                cnm.load(shar)
+                sigcnm=makeGArray(SHnmtGuide(),name="sigcnm")
+                sigcnm.load(shar)
+                res[native]=(dt,cnm.mat.copy(),sigcnm.mat.copy())
+
+            logger.info("Reading %s python: %f s, native: %f s, speedup %.1f"%(fname,res[False][0],res[True][0],res[False][0]/res[True][0]))
+            self.assertGreater(res[False][0],res[True][0])
+            #both readers parse the fields to the same doubles
+            self.assertTrue(np.array_equal(res[True][1],res[False][1]))
+            self.assertTrue(np.array_equal(res[True][2],res[False][2]))
+
     def checkmat(self,mat1,mat2):
         for i,o in zip(mat1,mat2):
             self.assertEqual(i,o)
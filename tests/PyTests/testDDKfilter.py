@@ -63,5 +63,12 @@ for i,(cf,cck,sf,sck) in enumerate(zip (coef.C,coefchk.C,coef.S,coefchk.S)):
     if (abs(cf-cck)> tol or abs(sf-sck) >tol):
         raise Exception("Comparison not within tolerance")
     # print(coef.nm(i),cf,cck,sf,sck)
+
+#the native (C++ block diagonal) filter must reproduce the same reference
+filtnative=DDKfilter(filtfile,native=True)
+coefnative=filtnative(coefin)
+for i,(cf,cck,sf,sck) in enumerate(zip (coefnative.C,coefchk.C,coefnative.S,coefchk.S)):
+    if (abs(cf-cck)> tol or abs(sf-sck) >tol):
+        raise Exception("Comparison of the native filter not within tolerance")
 # dat=readBIN(file)
 
@@ -25,6 +25,13 @@
 #include <boost/test/unit_test.hpp>
 //#include "core/GOperatorTesting.cpp"
 #include "core/IndexGuide.hpp"
+#include "core/GOperatorDiag.hpp"
+#include "core/GOperatorBlockDiag.hpp"
+#include "core/GOperatorChain.hpp"
+#include "core/GArrayAllocator.hpp"
+#include "core/GOperatorSparse.hpp"
+#include "core/GArrayMapped.hpp"
+#include <chrono>
 
 using namespace frommle::guides;
 using namespace frommle::core;
@@ -38,3 +45,330 @@ BOOST_AUTO_TEST_CASE(DiagonalGoperator){
 }
 
 
+
+///@brief micro benchmark which applies an operator repeatedly (allocating a new output array each time) with the aligned and pooled allocators
+BOOST_AUTO_TEST_CASE(PooledAllocation){
+    using clock=std::chrono::steady_clock;
+    const size_t nrow=2000,ncol=40,nrep=2000;
+    GuidePackDyn<1> gpo{IndexGuide(nrow)};
+    GOperatorDiag<double> diagop(gpo);
+    diagop.eig().diagonal().setConstant(2.0);
+    GArrayDense<double,2> gin(GuidePackDyn<2>{IndexGuide(nrow),IndexGuide(ncol)});
+    gin=1.0;
+    BOOST_TEST(reinterpret_cast<uintptr_t>(gin.mat().data())%DenseAllocator::alignment == 0);
+
+    auto aligned=std::make_shared<DenseAllocator>();
+    auto pooled=std::make_shared<PooledAllocator>();
+    double sum=0;
+    for(DenseAllocPtr alloc:{aligned,std::static_pointer_cast<DenseAllocator>(pooled)}){
+        setDefaultDenseAllocator(alloc);
+        auto t0=clock::now();
+        for(size_t i=0;i<nrep;++i){
+            auto gout=diagop(gin);
+            sum+=gout->template as<GArrayDense<double,2>*>()->mat()[i%nrow][0];
+        }
+        double dt=std::chrono::duration<double>(clock::now()-t0).count();
+        BOOST_TEST_MESSAGE((alloc == aligned?"aligned":"pooled")<<" allocator: "<<alloc->nRequests()<<" requests, "
+            <<alloc->nSysAlloc()<<" system allocations, "<<dt/nrep*1e6<<" us per application");
+    }
+    setDefaultDenseAllocator(nullptr);
+    BOOST_TEST(sum == 4.0*nrep);
+    BOOST_TEST(aligned->nSysAlloc() == nrep);
+    //the output buffer is recycled after each application
+    BOOST_TEST(pooled->nSysAlloc() == 1);
+    BOOST_TEST(pooled->cached() > 0);
+}
+
+///@brief apply diagonal operators along the first dimension of higher rank arrays (threaded, in place and chained)
+BOOST_AUTO_TEST_CASE(DiagonalGoperatorRankN){
+    const size_t n0=60,n1=30,n2=50;
+    GuidePackDyn<1> gpo{IndexGuide(n0)};
+    GOperatorDiag<double> diagop(gpo);
+    GOperatorDiag<double> diagop2(gpo);
+    for(size_t i=0;i<n0;++i){
+        diagop.eig().diagonal()[i]=i+1.0;
+        diagop2.eig().diagonal()[i]=0.5;
+    }
+    diagop.setNThreads(4);
+
+    GArrayDense<double,3> gin(GuidePackDyn<3>{IndexGuide(n0),IndexGuide(n1),IndexGuide(n2)});
+    for(size_t i=0;i<n0;++i){
+        for(size_t j=0;j<n1;++j){
+            for(size_t k=0;k<n2;++k){
+                gin.mat()[i][j][k]=j*n2+k;
+            }
+        }
+    }
+
+    //out of place
+    auto gout=diagop.apply(gin);
+    bool allequal=true;
+    for(size_t i=0;i<n0;++i){
+        for(size_t j=0;j<n1;++j){
+            for(size_t k=0;k<n2;++k){
+                allequal=allequal and (gout.mat()[i][j][k] == (i+1.0)*(j*n2+k));
+            }
+        }
+    }
+    BOOST_TEST(allequal);
+
+    //in place using a chained operator (diagop applied after diagop2)
+    auto chained=diagop(diagop2);
+    chained.applyInPlace(gin);
+    allequal=true;
+    for(size_t i=0;i<n0;++i){
+        for(size_t j=0;j<n1;++j){
+            for(size_t k=0;k<n2;++k){
+                allequal=allequal and (gin.mat()[i][j][k] == 0.5*gout.mat()[i][j][k]);
+            }
+        }
+    }
+    BOOST_TEST(allequal);
+
+    //the generic operator interface for 2D arrays uses the same path
+    GArrayDense<double,2> gin2(GuidePackDyn<2>{IndexGuide(n0),IndexGuide(n1)});
+    gin2=2.0;
+    auto gout2=diagop(gin2);
+    auto gout2ptr=gout2->template as<GArrayDense<double,2>*>();
+    BOOST_TEST(gout2ptr->mat()[n0-1][n1-1] == 2.0*n0);
+
+    //inverse
+    auto ginv=diagop.inverse().apply(gout);
+    BOOST_TEST(ginv.mat()[n0-1][n1-1][n2-1] == double((n1-1)*n2+n2-1));
+
+    GArrayDense<double,3> gwrong(GuidePackDyn<3>{IndexGuide(n0+1),IndexGuide(n1),IndexGuide(n2)});
+    BOOST_CHECK_THROW(diagop.apply(gwrong),InputException);
+}
+
+///@brief apply a block diagonal operator to multiple columns and compare with an explicit matrix product
+BOOST_AUTO_TEST_CASE(BlockDiagonalGoperator,*boost::unit_test::tolerance(1e-12)){
+    const size_t nrow=40,ncol=7;
+    std::vector<size_t> blockends={5,6,20,33,40};
+    GOperatorBlockDiag<double> blkop(GuidePackDyn<1>{IndexGuide(nrow)},blockends);
+    blkop.setNThreads(3);
+    BOOST_TEST(blkop.nblocks() == blockends.size());
+
+    //construct the full matrix for reference
+    Eigen::MatrixXd full=Eigen::MatrixXd::Zero(nrow,nrow);
+    for(size_t iblk=0;iblk<blkop.nblocks();++iblk){
+        auto & blk=blkop.block(iblk);
+        for(int j=0;j<blk.cols();++j){
+            for(int i=0;i<blk.rows();++i){
+                blk(i,j)=std::sin(1.0+iblk+0.3*i-0.7*j);
+            }
+        }
+        size_t st=blkop.gblockdiag().blockStart(iblk);
+        full.block(st,st,blk.rows(),blk.cols())=blk;
+    }
+
+    GArrayDense<double,2> gin(GuidePackDyn<2>{IndexGuide(nrow),IndexGuide(ncol)});
+    for(size_t i=0;i<nrow;++i){
+        for(size_t j=0;j<ncol;++j){
+            gin.mat()[i][j]=std::cos(0.1*i*j+i);
+        }
+    }
+    Eigen::MatrixXd ref=full*gin.eig();
+
+    auto gout=blkop(gin);
+    auto goutptr=gout->template as<GArrayDense<double,2>*>();
+    for(size_t i=0;i<nrow;++i){
+        for(size_t j=0;j<ncol;++j){
+            BOOST_TEST(goutptr->mat()[i][j] == ref(i,j));
+        }
+    }
+
+    //chained with two diagonals (folded into one), evaluated again after releasing the scratch buffers
+    auto d1=std::make_shared<GOperatorDiag<double>>(GuidePackDyn<1>{IndexGuide(nrow)});
+    auto d2=std::make_shared<GOperatorDiag<double>>(GuidePackDyn<1>{IndexGuide(nrow)});
+    for(size_t i=0;i<nrow;++i){
+        d1->eig().diagonal()[i]=1.0+0.1*i;
+        d2->eig().diagonal()[i]=2.0-0.01*i;
+    }
+    GOperatorChain<double> chain;
+    chain.append(std::make_shared<GOperatorBlockDiag<double>>(blkop)).append(d1).append(d2);
+    BOOST_TEST(chain.nfused() == 2);
+    for(int ieval=0;ieval<2;++ieval){
+        auto gchain=chain(gin);
+        auto gchainptr=gchain->template as<GArrayDense<double,2>*>();
+        for(size_t i=0;i<nrow;++i){
+            for(size_t j=0;j<ncol;++j){
+                BOOST_TEST(gchainptr->mat()[i][j] == d2->eig().diagonal()[i]*d1->eig().diagonal()[i]*ref(i,j));
+            }
+        }
+        chain.clearScratch();
+    }
+
+    //modifications of a recorded diagonal are taken into account by the next evaluation
+    for(size_t i=0;i<nrow;++i){
+        d1->eig().diagonal()[i]=0.5+0.2*i;
+    }
+    auto gmod=chain(gin);
+    auto gmodptr=gmod->template as<GArrayDense<double,2>*>();
+    for(size_t i=0;i<nrow;++i){
+        for(size_t j=0;j<ncol;++j){
+            BOOST_TEST(gmodptr->mat()[i][j] == d2->eig().diagonal()[i]*d1->eig().diagonal()[i]*ref(i,j));
+        }
+    }
+
+    //in place
+    blkop.apply(gin,gin);
+    for(size_t i=0;i<nrow;++i){
+        for(size_t j=0;j<ncol;++j){
+            BOOST_TEST(gin.mat()[i][j] == ref(i,j));
+        }
+    }
+
+    BOOST_CHECK_THROW(GOperatorBlockDiag<double>(GuidePackDyn<1>{IndexGuide(nrow)},{5,30}),InputException);
+}
+
+BOOST_AUTO_TEST_CASE(SparseGoperator,*boost::unit_test::tolerance(1e-12)){
+    const size_t nrowin=50,nrowout=300,ncol=6;
+    //sparse linear interpolation operator (two non-zeros per row)
+    GArraySparse<double> gsp(GuidePackDyn<2>{IndexGuide(nrowout),IndexGuide(nrowin)});
+    std::vector<GArraySparse<double>::triplet> triplets;
+    Eigen::MatrixXd full=Eigen::MatrixXd::Zero(nrowout,nrowin);
+    for(size_t i=0;i<nrowout;++i){
+        double x=i*(nrowin-1.0)/nrowout;
+        size_t i0=static_cast<size_t>(x);
+        double w=x-i0;
+        triplets.emplace_back(i,i0,1-w);
+        triplets.emplace_back(i,i0+1,w);
+        full(i,i0)+=1-w;
+        full(i,i0+1)+=w;
+    }
+    gsp.setFromTriplets(triplets.begin(),triplets.end());
+    BOOST_TEST(gsp.nnz() <= 2*nrowout);
+
+    GOperatorSparse<double> spop(gsp);
+    spop.setNThreads(3);
+    BOOST_TEST(spop.gp()[0]->size() == nrowout);
+
+    GArrayDense<double,2> gin(GuidePackDyn<2>{IndexGuide(nrowin),IndexGuide(ncol)});
+    for(size_t i=0;i<nrowin;++i){
+        for(size_t j=0;j<ncol;++j){
+            gin.mat()[i][j]=std::cos(0.1*i*j+i);
+        }
+    }
+    Eigen::MatrixXd ref=full*gin.eig();
+
+    auto gout=spop(gin);
+    auto goutptr=gout->template as<GArrayDense<double,2>*>();
+    for(size_t i=0;i<nrowout;++i){
+        for(size_t j=0;j<ncol;++j){
+            BOOST_TEST(goutptr->mat()[i][j] == ref(i,j));
+        }
+    }
+
+    //size mismatch
+    GArrayDense<double,2> gwrong(GuidePackDyn<2>{IndexGuide(nrowin+1),IndexGuide(ncol)});
+    BOOST_CHECK_THROW(spop.apply(gwrong,*goutptr),InputException);
+
+    //non-zero values can not be assigned to a sparse array
+    BOOST_CHECK_THROW(gsp=2.0,InputException);
+    BOOST_TEST(gsp.nnz() > 0);
+
+    //zero clears the array
+    gsp=0.0;
+    BOOST_TEST(gsp.nnz() == 0);
+}
+
+///@brief allocator which refuses requests above a memory limit
+class LimitedAllocator:public DenseAllocator{
+public:
+    LimitedAllocator(const size_t limit):limit_(limit){}
+    void * allocate(const size_t nbytes)override{
+        if (nbytes > limit_){
+            throw std::bad_alloc();
+        }
+        return DenseAllocator::allocate(nbytes);
+    }
+private:
+    size_t limit_;
+};
+
+///@brief sets the default dense allocator and restores the standard one when going out of scope
+struct ScopedDenseAllocator{
+    ScopedDenseAllocator(DenseAllocPtr alloc){setDefaultDenseAllocator(std::move(alloc));}
+    ~ScopedDenseAllocator(){setDefaultDenseAllocator(nullptr);}
+    ScopedDenseAllocator(const ScopedDenseAllocator &)=delete;
+    ScopedDenseAllocator & operator=(const ScopedDenseAllocator &)=delete;
+};
+
+///@brief apply a diagonal operator to memory mapped arrays which exceed the configured memory limit
+BOOST_AUTO_TEST_CASE(MappedGoperator){
+    const size_t nrow=2000,ncol=1500;
+    const size_t limit=size_t(4)*1024*1024;
+    const std::string infile="GOpMappedIn.bin";
+    const std::string outfile="GOpMappedOut.bin";
+    GuidePackDyn<2> gp{IndexGuide(nrow),IndexGuide(ncol)};
+    BOOST_TEST(gp.num_elements()*sizeof(double) > limit);
+
+    ScopedDenseAllocator limited(std::make_shared<LimitedAllocator>(limit));
+    BOOST_CHECK_THROW((GArrayDense<double,2>{gp}),std::bad_alloc);
+
+    GuidePackDyn<1> gpo{IndexGuide(nrow)};
+    GOperatorDiag<double> diagop(gpo);
+    for(size_t i=0;i<nrow;++i){
+        diagop.eig().diagonal()[i]=1.0+0.5*i;
+    }
+
+    {
+        auto gin=createMappedDense<double,2>(infile,gp,"input");
+        for(size_t i=0;i<nrow;++i){
+            for(size_t j=0;j<ncol;++j){
+                gin.mat()[i][j]=std::cos(0.001*i*j);
+            }
+        }
+        //write the output to a second mapped file
+        auto gout=createMappedDense<double,2>(outfile,gp,"output");
+        diagop.apply(gin,gout);
+    }
+
+    //read only mappings are only handed out as const arrays
+    BOOST_CHECK_THROW((openMappedDense<double,2>(infile,gp,MapMode::ReadOnly)),InputException);
+    BOOST_CHECK_THROW(MappedFile(infile,MapMode::ReadOnly).data(),IOException);
+    auto ginptr=openMappedDenseConst<double,2>(infile,gp);
+    auto goutptr=openMappedDenseConst<double,2>(outfile,gp);
+    const auto & gin=*ginptr;
+    const auto & gout=*goutptr;
+    BOOST_TEST(gout.name() == "output");
+    bool match=true;
+    for(size_t i=0;i<nrow;++i){
+        for(size_t j=0;j<ncol;++j){
+            match = match and gout.mat()[i][j] == (1.0+0.5*i)*std::cos(0.001*i*j);
+        }
+    }
+    BOOST_TEST(match);
+    BOOST_TEST(gout.eig()(nrow-1,ncol-1) == (1.0+0.5*(nrow-1))*std::cos(0.001*(nrow-1)*(ncol-1)));
+
+    //copy on write: modifications are not visible in the file
+    {
+        auto gcow=openMappedDense<double,2>(infile,gp,MapMode::CopyOnWrite);
+        diagop.applyInPlace(gcow);
+        BOOST_TEST(gcow.mat()[nrow-1][1] == gout.mat()[nrow-1][1]);
+    }
+    BOOST_TEST(gin.mat()[nrow-1][1] == std::cos(0.001*(nrow-1)));
+
+    //read write: modifications end up in the file
+    {
+        auto grw=openMappedDense<double,2>(infile,gp,MapMode::ReadWrite);
+        diagop.applyInPlace(grw);
+    }
+    BOOST_TEST(gin.mat()[nrow-1][1] == gout.mat()[nrow-1][1]);
+
+    //copies of a const array share the read only mapping, writing to them must neither crash nor modify the file
+    {
+        GArrayDense<double,2> gcopy=*openMappedDenseConst<double,2>(outfile,gp);
+        gcopy.mat()[0][0]=-1.0;
+        BOOST_TEST(gcopy.mat()[0][0] == -1.0);
+    }
+    BOOST_TEST((openMappedDenseConst<double,2>(outfile,gp)->mat()[0][0] == 1.0));
+
+    BOOST_CHECK_THROW((openMappedDense<double,2>(infile,GuidePackDyn<2>{IndexGuide(nrow),IndexGuide(ncol+1)})),InputException);
+    BOOST_CHECK_THROW((openMappedDense<float,2>(infile,gp)),InputException);
+
+    for(const auto & file:{infile,outfile}){
+        std::remove(file.c_str());
+        std::remove(MappedHeader::sidecar(file).c_str());
+    }
+}
@@ -103,6 +103,50 @@ BOOST_AUTO_TEST_CASE(GeoPointsGuide){
     }
 }
 
+BOOST_AUTO_TEST_CASE(GeoPointsIndex){
+    using GeoPoints=OGRGuide<geopoint>;
+    GeoPoints geopnts=GeoPoints();
+    GeoPoints search=GeoPoints();
+    size_t nlon=36;
+    size_t nlat=18;
+    for(size_t ilat=0;ilat<nlat;++ilat){
+        for(size_t ilon=0;ilon<nlon;++ilon){
+            geopnts.push_back(geopoint(-175.0+10*ilon,-85.0+10*ilat));
+        }
+    }
+
+    //single lookups through the hash index
+    BOOST_TEST(geopnts.idx(geopoint(-175.0,-85.0)) == 0);
+    BOOST_TEST(geopnts.idx(geopoint(5.0,15.0)) == 10*nlon+18);
+    BOOST_CHECK_THROW(geopnts.idx(geopoint(5.0,15.5)),core::IndexingException);
+
+    //bulk lookup (in reversed order and with a missing point)
+    for(size_t i=geopnts.size();i-- > 0;){
+        search.push_back(*geopnts[i]);
+    }
+    search.push_back(geopoint(0.0,0.0));
+    auto indices=geopnts.idx(search);
+    BOOST_TEST(indices.size() == search.size());
+    for(size_t i=0;i<geopnts.size();++i){
+        BOOST_TEST(indices[i] == geopnts.size()-1-i);
+    }
+    BOOST_TEST(indices.back() == -1);
+
+    //the index is rebuilt after modifying the guide
+    geopnts.push_back(geopoint(0.0,0.0));
+    BOOST_TEST(geopnts.idx(search).back() == geopnts.size()-1);
+
+    //nearest neighbour matching within a tolerance
+    GeoPoints perturbed=GeoPoints();
+    perturbed.push_back(geopoint(5.1,14.95));
+    perturbed.push_back(geopoint(-174.8,-85.1));
+    perturbed.push_back(geopoint(10.0,10.0));
+    auto nearest=geopnts.idx(perturbed,0.5);
+    BOOST_TEST(nearest[0] == 10*nlon+18);
+    BOOST_TEST(nearest[1] == 0);
+    BOOST_TEST(nearest[2] == -1);
+}
+
 OGRLineString makeOGRLineStr(){
     OGRSpatialReference *SpatialRef_=OGRSpatialReference::GetWGS84SRS();
 
@@ -31,10 +31,17 @@
 #include "geometry/OGRGuide.hpp"
 #include <boost/filesystem.hpp>
 #include "io/LineBuffer.hpp"
+#include "io/BlockLineReader.hpp"
 #include "geometry/GuideMakerTools.hpp"
 #include "core/GArrayBase.hpp"
+#include "core/GArraySparse.hpp"
 #include "io/NetCDFIO.hpp"
 #include "core/IndexGuide.hpp"
+#include "io/SHtxtArchive.hpp"
+#include "io/BINVArchive.hpp"
+#include <fstream>
+#include <chrono>
+#include <numeric>
 
 using namespace frommle::io;
 
@@ -141,6 +148,85 @@ BOOST_AUTO_TEST_CASE(RWOGRArchive){
 
 }
 
+///@brief write a large number of points to a GeoPackage in batches (within transactions) and read them back in column batches
+BOOST_AUTO_TEST_CASE(OGRBatchRoundTrip){
+    using clock=std::chrono::steady_clock;
+    const size_t npoints=100000;
+    const size_t nbatch=8192;
+    std::string gpkgfile("OGRbatchtest.gpkg");
+
+    OGRBatch batch;
+    batch.columns.emplace_back("ipoint",OFTInteger64);
+    batch.columns.emplace_back("value",OFTReal);
+    batch.columns.emplace_back("label",OFTString);
+    auto t0=clock::now();
+    {
+        io::OGRArchive oAr(gpkgfile, {{"mode",   "w"},
+                                      {"Driver", "GPKG"}});
+        auto grp = std::dynamic_pointer_cast<OGRGroup>(oAr.createGroup("points"));
+        BOOST_REQUIRE(grp);
+        //note: writeBatch uses transactions by default
+        BOOST_TEST(grp->batchTransactionSize() > 0);
+        for(size_t st=0;st<npoints;st+=nbatch){
+            batch.clear();
+            for(size_t i=st;i<std::min(st+nbatch,npoints);++i){
+                OGRPoint pnt(-180.0+360.0*i/npoints,-90.0+180.0*((i*7919)%npoints)/npoints);
+                batch.pushGeometry(&pnt);
+                batch.columns[0].ivals.push_back(i);
+                batch.columns[1].dvals.push_back(0.5*i);
+                std::string label="p"+std::to_string(i%1000);
+                batch.columns[2].pushString(label.c_str(),label.size());
+            }
+            grp->writeBatch(batch);
+        }
+    }
+    double twrite=std::chrono::duration<double>(clock::now()-t0).count();
+
+    //read with the Arrow stream (when GDAL and the driver support it) and with the per-feature path
+    for(const bool useArrow:{true,false}){
+        t0=clock::now();
+        size_t nread=0;
+        bool match=true;
+        bool usedArrow=false;
+        {
+            io::OGRArchive iAr(gpkgfile, {{"mode",   "r"}});
+            auto grp = std::dynamic_pointer_cast<OGRGroup>(iAr.getGroup("points"));
+            BOOST_REQUIRE(grp);
+            grp->setArrowStream(useArrow);
+            OGRBatch rbatch;
+            size_t n;
+            size_t iread=0;
+            //alternate the batch size, a smaller request than the first one must still be honoured
+            while((n=grp->readBatch(rbatch,(iread++%2 == 0)?nbatch:1000)) > 0){
+                usedArrow = usedArrow or grp->arrowStream();
+                BOOST_REQUIRE(n <= ((iread%2 == 1)?nbatch:1000));
+                const int icol=rbatch.columnIndex("ipoint");
+                const int vcol=rbatch.columnIndex("value");
+                const int lcol=rbatch.columnIndex("label");
+                BOOST_REQUIRE(icol >= 0);
+                BOOST_REQUIRE(vcol >= 0);
+                BOOST_REQUIRE(lcol >= 0);
+                BOOST_REQUIRE(rbatch.size() == n);
+                for(size_t j=0;j<n;++j){
+                    const long long int i=rbatch.columns[icol].ivals[j];
+                    auto geom=rbatch.geometry(j);
+                    auto pnt=dynamic_cast<OGRPoint*>(geom.get());
+                    match = match and pnt and pnt->getX() == -180.0+360.0*i/npoints and pnt->getY() == -90.0+180.0*((i*7919)%npoints)/npoints
+                            and rbatch.columns[vcol].dvals[j] == 0.5*i and rbatch.columns[lcol].getString(j) == "p"+std::to_string(i%1000);
+                }
+                nread+=n;
+            }
+        }
+        double tread=std::chrono::duration<double>(clock::now()-t0).count();
+        BOOST_TEST(nread == npoints);
+        BOOST_TEST(match);
+        BOOST_TEST((useArrow or !usedArrow));
+        BOOST_TEST_MESSAGE("GeoPackage with "<<npoints<<" points: batched write "<<twrite<<" s, batched read "<<tread<<" s ("<<(usedArrow?"Arrow stream":"per feature")<<")");
+    }
+
+    boost::filesystem::remove_all(boost::filesystem::path(gpkgfile));
+}
+
 /////@brief create a test guided array
 //core::GArray<double,core::GuidePack<core::IndexGuide,core::IndexGuide>> createTestGarray(){
 //    auto garr=core::make_garray(core::IndexGuide("guide1",13),core::IndexGuide("guide2",97));
@@ -185,3 +271,399 @@ BOOST_AUTO_TEST_CASE(RWOGRArchive){
 //}
 
 
+
+///@brief reference reader which splits the lines with stringstreams (similar to the python implementation)
+std::vector<double> readSHreference(const std::string & filename, const std::string & key, int nmax){
+    std::vector<double> cnm(2*guides::SHnmtGuide(nmax).size());
+    LineBuffer lbuf(filename,true);
+    for(auto & ln:lbuf){
+        std::string tag;
+        ln >> tag;
+        if(tag != key){
+            continue;
+        }
+        int n,m;
+        std::string c,s,sigc,sigs;
+        ln >> n >> m >> c >> s >> sigc >> sigs;
+        size_t idx=guides::SHnmtGuide::i_from_nmt(n,m,guides::trigenum::C);
+        cnm[idx]=std::stod(c);
+        cnm[cnm.size()/2+idx]=std::stod(sigc);
+        if(m>0) {
+            cnm[idx+1] = std::stod(s);
+            cnm[cnm.size()/2+idx+1]=std::stod(sigs);
+        }
+    }
+    return cnm;
+}
+
+BOOST_AUTO_TEST_CASE(SHtxtArchives){
+    using clock=std::chrono::steady_clock;
+    int nmax=60;
+    std::vector<std::tuple<std::string,std::string,SHtxtFormat>> files={
+            std::make_tuple("data/ITSG-Grace2018_n60_2010-04.gfc.gz","gfc",SHtxtFormat::icgem),
+            std::make_tuple("data/GSM-2_2008001-2008031_GRAC_UTCSR_BA01_0600.gz","GRCOF2",SHtxtFormat::GSMv6)};
+
+    for(const auto & fle:files) {
+        std::string fname=std::get<0>(fle);
+        BOOST_TEST((SHtxtArchive::guessFormat(fname) == std::get<2>(fle)));
+        //read the files a couple of times to get more representative timings
+        int nrep=20;
+        auto t0=clock::now();
+        std::vector<double> ref;
+        for(int i=0;i<nrep;++i) {
+            ref = readSHreference(fname, std::get<1>(fle), nmax);
+        }
+        double tref=std::chrono::duration<double>(clock::now()-t0).count();
+        t0=clock::now();
+        std::shared_ptr<SHtxtArchive> shar;
+        for(int i=0;i<nrep;++i) {
+            shar = std::make_shared<SHtxtArchive>(fname, std::get<2>(fle));
+        }
+        double tnew=std::chrono::duration<double>(clock::now()-t0).count();
+        BOOST_TEST_MESSAGE("Reading "<<fname<<" stringstream: "<<tref/nrep<<" s, scanner: "<<tnew/nrep<<" s, speedup "<<tref/tnew);
+
+        BOOST_TEST(shar->nmax() == nmax);
+        BOOST_TEST(shar->attr().get<double>("gm") == 3.9860044150e+14);
+        size_t nsh=shar->cnm()->mat().num_elements();
+        BOOST_REQUIRE(2*nsh == ref.size());
+        bool cnmequal=std::equal(shar->cnm()->mat().data(),shar->cnm()->mat().data()+nsh,ref.begin());
+        BOOST_TEST(cnmequal);
+        bool sigequal=std::equal(shar->sigcnm()->mat().data(),shar->sigcnm()->mat().data()+nsh,ref.begin()+nsh);
+        BOOST_TEST(sigequal);
+    }
+
+    //spot check of a GSM coefficient
+    SHtxtArchive gsm("data/GSM-2_2008001-2008031_GRAC_UTCSR_BA01_0600.gz",20);
+    BOOST_TEST(gsm.cnm()->mat().size() == guides::SHnmtGuide(20).size());
+    BOOST_TEST(gsm.cnm()->mat()[guides::SHnmtGuide::i_from_nmt(3,2,guides::trigenum::S)] == -0.619015264803E-06);
+
+    //write and read back a file in the standard format (with standard deviations)
+    std::string stdfile("SHstandardtest.txt");
+    {
+        std::ofstream fout(stdfile);
+        fout << "META 2 2008.0 2008.5 2009.0 1\n";
+        fout << "0 0 1.0 0.0 0.1D-01 0.0\n";
+        fout << "1 0 2.0 0.0 0.2 0.0\n";
+        fout << "1 1 3.0 -4.0 0.3 0.4\n";
+        fout << "2 0 5.0 0.0 0.5 0.0\n";
+        fout << "2 1 6.0 -7.0 0.6 0.7\n";
+        fout << "2 2 8.0 -9.0 0.8 0.9\n";
+    }
+    SHtxtArchive stdar(stdfile);
+    BOOST_TEST(stdar.nmax() == 2);
+    BOOST_TEST(stdar.attr().get<double>("tcent") == 2008.5);
+    BOOST_TEST(stdar.cnm()->mat()[guides::SHnmtGuide::i_from_nmt(2,1,guides::trigenum::S)] == -7.0);
+    BOOST_TEST(stdar.sigcnm()->mat()[guides::SHnmtGuide::i_from_nmt(1,1,guides::trigenum::S)] == 0.4);
+    BOOST_TEST(stdar.sigcnm()->mat()[0] == 0.01);
+
+    //lines with an invalid degree or order are rejected instead of being written out of bounds
+    for(const std::string badline:{"2 3 1.0 1.0 0.0 0.0","-1 0 1.0 0.0 0.0 0.0","1 -1 1.0 1.0 0.0 0.0"}){
+        {
+            std::ofstream fout(stdfile);
+            fout << "META 2 2008.0 2008.5 2009.0 1\n";
+            fout << "0 0 1.0 0.0 0.1 0.0\n";
+            fout << badline << "\n";
+        }
+        BOOST_CHECK_THROW(SHtxtArchive(stdfile,SHtxtFormat::standard),core::InputException);
+    }
+    {
+        std::ofstream fout(stdfile);
+        fout << "max_degree 2\nend_of_head\n";
+        fout << "gfc 1 2 1.0 1.0 0.0 0.0\n";
+    }
+    BOOST_CHECK_THROW(SHtxtArchive(stdfile,SHtxtFormat::icgem),core::InputException);
+    boost::filesystem::remove(stdfile);
+}
+
+///@brief writes a small BINV file (version 2.4) in native or swapped byte order
+void writeBINV(const std::string & fname, const std::string & type, const bool swap, const std::vector<uint32_t> & blockind,
+        const size_t nval1, const size_t nvec, const std::vector<double> & vec, const std::vector<double> & pack){
+    std::ofstream fout(fname,std::ios::binary);
+    auto put=[&](auto val){
+        char * b=reinterpret_cast<char*>(&val);
+        if(swap){
+            std::reverse(b,b+sizeof(val));
+        }
+        fout.write(b,sizeof(val));
+    };
+    auto putstr=[&](std::string str, const size_t nchar){
+        str.resize(nchar,' ');
+        fout.write(str.data(),nchar);
+    };
+    const bool blockdiag=!blockind.empty();
+    const bool full=(type.compare(0,6,"BDFULL") == 0);
+    put(uint16_t(18754));
+    putstr("NV2.4",6);
+    putstr(type,8);
+    putstr("Test matrix",80);
+    //one integer and one double meta entry
+    put(uint32_t(1));
+    put(uint32_t(1));
+    put(uint32_t(nval1));
+    put(uint32_t(nval1));
+    put(uint64_t(pack.size()));
+    put(uint64_t(1));
+    put(uint32_t(nvec));
+    put(uint32_t(0));
+    if(blockdiag){
+        put(uint32_t(blockind.size()));
+    }
+    putstr("Lmax",24);
+    put(uint32_t(4));
+    putstr("scale",24);
+    put(1.5);
+    for(size_t i=0;i<nval1;++i){
+        putstr("side1_"+std::to_string(i),24);
+    }
+    for(auto bi:blockind){
+        put(bi);
+    }
+    if(full){
+        for(size_t i=0;i<nval1;++i){
+            putstr("side2_"+std::to_string(i),24);
+        }
+    }
+    for(auto val:vec){
+        put(val);
+    }
+    for(auto val:pack){
+        put(val);
+    }
+}
+
+///@brief compress data as a single gzip member
+std::string gzipMember(const std::string & data, const bool raw=false){
+    z_stream strm{};
+    deflateInit2(&strm,Z_DEFAULT_COMPRESSION,Z_DEFLATED,raw?-MAX_WBITS:16+MAX_WBITS,8,Z_DEFAULT_STRATEGY);
+    std::string out(deflateBound(&strm,data.size())+32,'\0');
+    strm.next_in=reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    strm.avail_in=data.size();
+    strm.next_out=reinterpret_cast<Bytef*>(&out[0]);
+    strm.avail_out=out.size();
+    deflate(&strm,Z_FINISH);
+    out.resize(strm.total_out);
+    deflateEnd(&strm);
+    return out;
+}
+
+///@brief compress data in BGZF (bgzip) format: independent gzip members which store their size in the extra field
+std::string bgzfCompress(const std::string & data, const size_t blocksize){
+    std::string out;
+    auto putle=[&out](uint32_t v,int nbytes){
+        for(int i=0;i<nbytes;++i){
+            out.push_back(static_cast<char>((v >> (8*i)) & 0xff));
+        }
+    };
+    //the last (empty) block serves as end of file marker
+    for(size_t st=0;st<data.size()+blocksize;st+=blocksize){
+        std::string blk=(st < data.size())?data.substr(st,blocksize):std::string();
+        std::string cmp=gzipMember(blk,true);
+        const char hdr[]={'\x1f','\x8b','\x08','\x04',0,0,0,0,0,'\xff',6,0,'B','C',2,0};
+        out.append(hdr,sizeof(hdr));
+        putle(cmp.size()+25,2);
+        out+=cmp;
+        putle(crc32(0,reinterpret_cast<const Bytef*>(blk.data()),blk.size()),4);
+        putle(blk.size(),4);
+    }
+    return out;
+}
+
+///@brief read plain, multi-member gzip and bgzip files with the block reader and check the lines (including a line exceeding the block size)
+BOOST_AUTO_TEST_CASE(BlockLineReading){
+    std::vector<std::string> lines;
+    for(int i=0;i<20000;++i){
+        lines.push_back("line "+std::to_string(i)+" "+std::string(i%37,'x'));
+    }
+    lines[777]=std::string(5000,'L');
+    lines.push_back("no trailing newline");
+    std::string content;
+    for(const auto & ln:lines){
+        content+=ln+"\n";
+    }
+    content.pop_back();
+
+    const std::string plainfile("BlockLineTest.txt");
+    const std::string gzfile("BlockLineTest.txt.gz");
+    const std::string bgzfile("BlockLineTest.txt.bgz");
+    std::ofstream(plainfile,std::ios::binary) << content;
+    //split in two gzip members
+    std::ofstream(gzfile,std::ios::binary) << gzipMember(content.substr(0,100001))+gzipMember(content.substr(100001));
+    std::ofstream(bgzfile,std::ios::binary) << bgzfCompress(content,65280);
+
+    for(const auto & fgz:{std::make_pair(plainfile,false),std::make_pair(gzfile,true),std::make_pair(bgzfile,true)}){
+        BlockLineReader reader(fgz.first,fgz.second,4096);
+        BOOST_TEST(reader.isBGZF() == (fgz.first == bgzfile));
+        BlockLineReader::string_view line;
+        bool match=true;
+        size_t nline=0;
+        while(reader.getline(line)){
+            match = match and nline < lines.size() and line == lines[nline] and line.data()[line.size()] == '\0';
+            ++nline;
+        }
+        BOOST_TEST(match);
+        BOOST_TEST(nline == lines.size());
+        BOOST_TEST(reader.lineNumber() == lines.size());
+    }
+
+    //the line based interface on top of the block reader
+    LineBuffer lbuf(bgzfile,true);
+    size_t nline=0;
+    for(auto it=lbuf.begin();it!=lbuf.end();++it,++nline){
+        if (nline == 1){
+            std::string word;
+            int num;
+            *it >> word >> num;
+            BOOST_TEST(word == "line");
+            BOOST_TEST(num == 1);
+        }
+    }
+    BOOST_TEST(nline == lines.size());
+
+    for(const auto & file:{plainfile,gzfile,bgzfile}){
+        std::remove(file.c_str());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(BINVArchives){
+    using namespace frommle::io;
+    std::string fname("BINVtest.bin");
+    for(bool swap:{false,true}){
+        //block diagonal with full blocks of size 2 and 3
+        std::vector<double> pack(13);
+        std::iota(pack.begin(),pack.end(),1.0);
+        writeBINV(fname,"BDFULLV0",swap,{2,5},5,0,{},pack);
+        {
+            BINVArchive binv(fname);
+            BOOST_TEST(binv.swapped() == swap);
+            BOOST_TEST(binv.type() == "BDFULLV0");
+            BOOST_TEST(binv.attr().get<size_t>("Lmax") == 4);
+            BOOST_TEST(binv.attr().get<double>("scale") == 1.5);
+            BOOST_TEST(binv.nblocks() == 2);
+            BOOST_TEST(binv.blockStart(1) == 2);
+            BOOST_TEST(binv.side1()[4] == "side1_4");
+            BOOST_TEST(binv.side2()[0] == "side2_0");
+            auto blk=binv.block(1);
+            BOOST_TEST(blk.rows() == 3);
+            //column major storage
+            BOOST_TEST(blk(1,0) == 6.0);
+            BOOST_TEST(blk(0,1) == 8.0);
+            if(!swap){
+                //zero-copy access to the memory map
+                BOOST_TEST(blk.data() == binv.pack().data()+4);
+            }
+            Eigen::MatrixXd mat=binv.unpack();
+            BOOST_TEST(mat(3,2) == 6.0);
+            BOOST_TEST(mat(0,3) == 0.0);
+        }
+
+        //symmetric matrix with a vector
+        writeBINV(fname,"SYMVN___",swap,{},3,1,{-1.0,-2.0,-3.0},{1,2,3,4,5,6});
+        {
+            BINVArchive binv(fname);
+            BOOST_TEST(binv.packedTriangular());
+            BOOST_TEST(binv.vec()(2,0) == -3.0);
+            BOOST_TEST(binv.packedBlock(0).size() == 6);
+            BOOST_CHECK_THROW(binv.block(0),frommle::core::MethodException);
+            Eigen::MatrixXd mat=binv.unpack();
+            BOOST_TEST(mat(0,2) == 4.0);
+            BOOST_TEST(mat(2,1) == 5.0);
+            BOOST_TEST(mat(1,1) == 3.0);
+        }
+
+        //diagonal matrix
+        writeBINV(fname,"DIAVN___",swap,{},3,1,{0.0,0.0,0.0},{7,8,9});
+        {
+            BINVArchive binv(fname);
+            BOOST_TEST(binv.nblocks() == 3);
+            BOOST_TEST(binv.block(2)(0,0) == 9.0);
+            Eigen::MatrixXd mat=binv.unpack();
+            BOOST_TEST(mat(1,1) == 8.0);
+            BOOST_TEST(mat(1,0) == 0.0);
+        }
+    }
+    boost::filesystem::remove(fname);
+}
+
+BOOST_AUTO_TEST_CASE(NetCDFPartialWrite){
+    using namespace frommle::io;
+    std::string fout("TestncSlices.nc");
+    boost::filesystem::remove(fout);
+    const size_t ntime=12,nlat=9,nlon=18;
+    auto value=[](size_t it,size_t ilat,size_t ilon){return it*1000.0+ilat*100.0+ilon;};
+
+    {
+        //write a compressed variable with an unlimited time dimension, one time slice at the time
+        NetCDFArchive oAr(fout,{{"mode","w"}});
+        auto & ncvar=dynamic_cast<NetCDFVariable<double>&>(oAr.createVariable<double>("tws"));
+        ncvar.setExtents({NC_UNLIMITED,nlat,nlon});
+        ncvar.setChunking({1,nlat,nlon});
+        ncvar.setDeflate(4);
+        std::vector<double> buf(nlat*nlon);
+        for(size_t it=0;it<ntime;++it){
+            for(size_t ilat=0;ilat<nlat;++ilat){
+                for(size_t ilon=0;ilon<nlon;++ilon){
+                    buf[ilat*nlon+ilon]=value(it,ilat,ilon);
+                }
+            }
+            core::HyperSlabConstRef<double> hslab({core::slice{ptrdiff_t(it),1,1},core::slice{0,ptrdiff_t(nlat),1},core::slice{0,ptrdiff_t(nlon),1}},buf.data());
+            ncvar.setValue(hslab);
+        }
+    }
+
+    //read back a strided subset
+    NetCDFArchive iAr(fout,{{"mode","r"}});
+    auto & ncvar=dynamic_cast<NetCDFVariable<double>&>(iAr.getVariable<double>("tws"));
+    BOOST_TEST(ncvar.ndim() == 3);
+    const size_t nt=ntime/3;
+    std::vector<double> buf(nt*nlat*nlon);
+    core::HyperSlabRef<double> hslab({core::slice{1,ptrdiff_t(nt),3},core::slice{0,ptrdiff_t(nlat),1},core::slice{0,ptrdiff_t(nlon),1}},buf.data());
+    ncvar.getValue(hslab);
+    bool equal=true;
+    for(size_t it=0;it<nt;++it){
+        for(size_t ilat=0;ilat<nlat;++ilat){
+            for(size_t ilon=0;ilon<nlon;++ilon){
+                equal=equal and buf[(it*nlat+ilat)*nlon+ilon] == value(1+3*it,ilat,ilon);
+            }
+        }
+    }
+    BOOST_TEST(equal);
+    boost::filesystem::remove(fout);
+}
+
+BOOST_AUTO_TEST_CASE(NetCDFSparseRoundTrip){
+    using namespace frommle::io;
+    using namespace frommle::guides;
+    std::string fout("TestncSparse.nc");
+    boost::filesystem::remove(fout);
+    const size_t nrow=30,ncol=20;
+    using gsparse=core::GArraySparse<double>;
+    gsparse gsp(GuidePackDyn<2>{IndexGuide(nrow),IndexGuide(ncol)},"spmat");
+    std::vector<gsparse::triplet> triplets;
+    for(size_t i=0;i<nrow;i+=3){
+        triplets.emplace_back(i,(7*i)%ncol,1.0+i);
+        triplets.emplace_back(i,ncol-1,-0.5*i-1.0);
+    }
+    gsp.setFromTriplets(triplets.cbegin(),triplets.cend());
+    gsparse gempty(GuidePackDyn<2>{IndexGuide(nrow),IndexGuide(ncol)},"spempty");
+
+    {
+        NetCDFArchive oAr(fout,{{"mode","w"}});
+        gsp.saveCOO(oAr);
+        gempty.saveCOO(oAr);
+    }
+
+    NetCDFArchive iAr(fout,{{"mode","r"}});
+    gsparse gspin(GuidePackDyn<2>{IndexGuide(nrow),IndexGuide(ncol)},"spmat");
+    gspin.loadCOO(iAr);
+    BOOST_TEST(gspin.nnz() == gsp.nnz());
+    BOOST_TEST((gspin.eig()-gsp.eig()).norm() == 0.0);
+
+    gsparse gemptyin(GuidePackDyn<2>{IndexGuide(nrow),IndexGuide(ncol)},"spempty");
+    gemptyin.loadCOO(iAr);
+    BOOST_TEST(gemptyin.nnz() == 0);
+
+    //entries which fall outside of the guides are rejected
+    gsparse gsmall(GuidePackDyn<2>{IndexGuide(nrow/2),IndexGuide(ncol)},"spmat");
+    BOOST_CHECK_THROW(gsmall.loadCOO(iAr),core::InputException);
+    boost::filesystem::remove(fout);
+}
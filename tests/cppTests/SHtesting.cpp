@@ -31,8 +31,16 @@
 #include <cmath>
 #include <iomanip>
 #include <algorithm>
+#include <chrono>
 #include "geometry/GuideMakerTools.hpp"
 #include "sh/SHisoOperator.hpp"
+#include "sh/SHGridOperators.hpp"
+#include "sh/xyz2SH.hpp"
+#include "sh/polygon2SH.hpp"
+#include "sh/DDKfilter.hpp"
+#include "core/GOperatorChain.hpp"
+#include <fstream>
+#include <random>
 using namespace frommle;
 using namespace frommle::guides;
 using namespace frommle::sh;
@@ -72,7 +80,7 @@ double P7(double x){
 BOOST_AUTO_TEST_CASE(SHguidetest){
     int nmax=5;
     int n,m;
-    SHGuideBase::trig t;
+    trigenum t;
     using tpl=SHGuide::Element;
     //construct using the defaulkt sorting scheme
     SHGuide shg(nmax);
@@ -112,6 +120,40 @@ BOOST_AUTO_TEST_CASE(SHguidetest){
 
 }
 
+BOOST_AUTO_TEST_CASE(maskedNonIndexedGuide){
+    int nmax=300;
+    SHnmtGuide shg(nmax);
+    size_t nfull=shg.size();
+    //mask the order 0 sine coefficients and odd degrees
+    shg.mask([](const nmtEl & el){return std::get<1>(el) == 0 and std::get<2>(el) == trigenum::S;});
+    shg.mask([](const nmtEl & el){return std::get<0>(el)%2 == 1;});
+
+    size_t nexpect=0;
+    for(int n=0;n<=nmax;n+=2){
+        nexpect+=2*n+1;
+    }
+    BOOST_TEST(shg.size() == nexpect);
+
+    //iteration, random access and index lookup must agree
+    size_t i=0;
+    bool consistent=true;
+    for(const auto & el:shg){
+        consistent=consistent and std::get<0>(el)%2 == 0 and shg[i] == el and shg.idx(el) == i;
+        ++i;
+    }
+    BOOST_TEST(consistent);
+    BOOST_TEST(i == nexpect);
+    BOOST_CHECK_THROW(shg.idx(nmtEl(3,1,trigenum::C)),core::IndexingException);
+
+    //copies share the mask
+    SHnmtGuide shgcopy(shg);
+    BOOST_TEST(shgcopy[nexpect-1] == nmtEl(nmax,nmax,trigenum::S));
+
+    shg.unmask();
+    BOOST_TEST(shg.size() == nfull);
+    BOOST_TEST(shg.idx(nmtEl(3,1,trigenum::C)) == SHnmtGuide::i_from_nmt(3,1,trigenum::C));
+}
+
 BOOST_AUTO_TEST_CASE(LegendrePoly,*boost::unit_test::tolerance(1e-11)){
     int nmax=50000;
     Legendre<double> Pn(nmax);
@@ -138,8 +180,8 @@ BOOST_AUTO_TEST_CASE(assocLegendre,*boost::unit_test::tolerance(1e-11))
     for(int i=0;i<=nsteps+1;i++){
         theta=dt*i*D2R;
         Pnm.set(cos(theta));
-        auto indx=SHnmHalfGuide::Element(5,2);
-        BOOST_TEST(Pnm[indx]==P52(theta));
+        auto indx=SHnmGuide::i_from_nm(5,2,500);
+        BOOST_TEST(Pnm.mat()[indx]==P52(theta));
     }
 
 }
@@ -180,7 +222,7 @@ BOOST_AUTO_TEST_CASE(stabilityAssocLegendre)
 
         for (int m = 0; m <= nmax; ++m) {
             for (int n = m; n <= nmax; ++n) {
-                auto idx = Pnm.shg().idx(n, m);
+                auto idx = SHnmGuide::i_from_nm(n, m, nmax);
                 val=Pnm.mat()[idx];
                 //convert to double to compare properly
                 valld=Pnmld.mat()[idx];
@@ -205,6 +247,203 @@ BOOST_AUTO_TEST_CASE(stabilityAssocLegendre)
 }
 
 
+///@brief check the batched (multi-latitude) Legendre functions against the scalar version and compare throughput
+BOOST_AUTO_TEST_CASE(batchAssocLegendre)
+{
+    using clock=std::chrono::steady_clock;
+    for(int nmax:{360,720,2160}) {
+        Legendre_nm_d Pnm(nmax);
+        //limit the amount of memory needed for the output block
+        int nlat=(nmax > 1000)?12:61;
+        std::vector<double> costheta(nlat);
+        for(int i=0;i<nlat;++i){
+            costheta[i]=cos((i+0.5)*180.0/nlat*D2R);
+        }
+
+        //note: allocate the output before timing
+        boost::multi_array<double,2> Pbatch(boost::extents[nlat][Pnm.shg().size()]);
+        auto t0=clock::now();
+        Pnm.setBatch(costheta.data(),nlat,Pbatch.data());
+        double tbatch=std::chrono::duration<double>(clock::now()-t0).count();
+
+        double tscalar=0;
+        size_t nmismatch=0;
+        for(int i=0;i<nlat;++i){
+            t0=clock::now();
+            Pnm.set(costheta[i]);
+            tscalar+=std::chrono::duration<double>(clock::now()-t0).count();
+            for(size_t j=0;j<Pnm.shg().size();++j){
+                if(Pnm.mat()[j] != Pbatch[i][j]){
+                    ++nmismatch;
+                }
+            }
+        }
+        //the batched version must yield exactly the same values
+        BOOST_TEST(nmismatch == 0);
+        BOOST_TEST_MESSAGE("nmax "<<nmax<<": scalar "<< tscalar << " s, batched "<<tbatch<<" s, speedup "<<tscalar/tbatch);
+    }
+
+}
+
+///@brief test the order-parallel evaluation of a single very high degree latitude
+BOOST_AUTO_TEST_CASE(parallelAssocLegendre)
+{
+    using clock=std::chrono::steady_clock;
+    int nmax=5400;
+    Legendre_nm_d Pnm(nmax);
+    Legendre_nm_d Pnmpar(nmax);
+    for(double costheta:{0.0,0.3,-0.7,0.9}) {
+        auto t0 = clock::now();
+        Pnm.set(costheta);
+        double tserial = std::chrono::duration<double>(clock::now() - t0).count();
+        t0 = clock::now();
+        Pnmpar.setParallel(costheta);
+        double tpar = std::chrono::duration<double>(clock::now() - t0).count();
+
+        size_t nmismatch=0;
+        for(size_t j=0;j<Pnm.shg().size();++j){
+            //note: towards the poles the rescaled sectorials underflow at these degrees, which yields NaN's in both versions
+            if(Pnm.mat()[j] != Pnmpar.mat()[j] and not (std::isnan(Pnm.mat()[j]) and std::isnan(Pnmpar.mat()[j]))){
+                ++nmismatch;
+            }
+        }
+        //the parallel version must yield exactly the same values
+        BOOST_TEST(nmismatch == 0);
+        BOOST_TEST_MESSAGE("nmax "<<nmax<<", costheta "<<costheta<<": serial "<< tserial << " s, parallel "<<tpar<<" s, speedup "<<tserial/tpar);
+    }
+
+}
+
+///@brief test the recurrence for cos(m lon) and sin(m lon) against a direct evaluation
+BOOST_AUTO_TEST_CASE(trigRecurrence){
+    int nmax=2700;
+    Ynm_cache_d ynmc(nmax);
+    double maxerr=0.0;
+    double maxerrdirect=0.0;
+    for(double lon:{-179.9,-123.456,-0.001,0.0,1.0,33.3333,89.99,179.75}){
+        ynmc.setlon(lon);
+        const auto & sc=ynmc.sincos();
+        //note: the reference is evaluated in extended precision
+        long double dlon=D2R*lon;
+        for(int m=0;m<=nmax;++m){
+            long double mlon=m*dlon;
+            maxerr=std::max(maxerr,static_cast<double>(std::abs(sc[m][0]-std::cos(mlon))));
+            maxerr=std::max(maxerr,static_cast<double>(std::abs(sc[m][1]-std::sin(mlon))));
+            //direct evaluation in double precision
+            double mlond=m*D2R*lon;
+            maxerrdirect=std::max(maxerrdirect,static_cast<double>(std::abs(cos(mlond)-std::cos(mlon))));
+            maxerrdirect=std::max(maxerrdirect,static_cast<double>(std::abs(sin(mlond)-std::sin(mlon))));
+        }
+    }
+    BOOST_TEST_MESSAGE("Maximum error of the trigonometric recurrence "<<maxerr<<", direct evaluation "<<maxerrdirect);
+    //the error is dominated by the rounding of the argument m*lon, which also affects the direct evaluation
+    BOOST_TEST(maxerr < 2e-12);
+    BOOST_TEST(maxerr < 2*maxerrdirect);
+}
+
+///@brief test the synthesis of spherical harmonic coefficients on scattered points (multiple columns)
+BOOST_AUTO_TEST_CASE(YNMsynthesis,*boost::unit_test::tolerance(1e-11)){
+    int nmax=100;
+    SHGuide shg(nmax);
+    //note: some points share latitudes
+    std::vector<double> lon={-179.3,61.0,156.0,12.0,-45.0,0.0};
+    std::vector<double> lat={-87.0,1.0,32.0,32.0,1.0,90.0};
+    auto geoguide=geometry::makePointGuide(lon,lat);
+    int naux=4;
+    IndexGuide iguide(naux);
+
+    auto coef=core::createDenseGAr<double>::zeros(shg,iguide);
+
+    //set the degree 5 order 2 coefficients (different per column)
+    int n=5;
+    int m=2;
+    size_t ish=0;
+    for(const auto & nmt:shg){
+        if(std::get<0>(nmt) == n and std::get<1>(nmt) == m){
+            for(int i=0;i<naux;++i){
+                coef.mat()[ish][i]=(std::get<2>(nmt) == trigenum::C)?(i+1):-0.5*(i+1);
+            }
+        }
+        ++ish;
+    }
+
+    Ynm<double> ynmop(geoguide,3);
+    auto outmulti=ynmop(coef);
+    auto outptr=outmulti->as<GArrayDense<double,2>*>();
+
+    size_t ip=0;
+    for(auto & pnt:geoguide) {
+        double p52val = P52(D2R * (90 - pnt->getY()));
+        double expect=p52val*(cos(m * D2R * pnt->getX())-0.5*sin(m * D2R * pnt->getX()));
+        for(int i=0;i<naux;++i){
+            BOOST_TEST(outptr->mat()[ip][i] == (i+1)*expect);
+        }
+        ++ip;
+    }
+
+    //the result should not depend on the amount of threads
+    ynmop.setNThreads(1);
+    auto outsingle=ynmop(coef);
+    auto outsptr=outsingle->as<GArrayDense<double,2>*>();
+    bool equalThreaded=std::equal(outsptr->mat().data(),outsptr->mat().data()+outsptr->mat().num_elements(),outptr->mat().data());
+    BOOST_TEST(equalThreaded);
+}
+
+///@brief synthesize random coefficients on global grids and analyze them again (should be exact for band limited fields)
+BOOST_AUTO_TEST_CASE(SHgridRoundtrip,*boost::unit_test::tolerance(1e-10)){
+    int nmax=60;
+    int ncol=5;
+    SHGuide shg(nmax);
+    IndexGuide iguide(ncol);
+    auto coef=core::createDenseGAr<double>::zeros(shg,iguide);
+    std::mt19937 gen(3);
+    std::uniform_real_distribution<double> unif(-1,1);
+    size_t ish=0;
+    for(const auto & nmt:shg){
+        for(int i=0;i<ncol;++i){
+            //note: the sine coefficients of order zero have no signal
+            coef.mat()[ish][i]=(std::get<1>(nmt) == 0 and std::get<2>(nmt) == trigenum::S)?0.0:unif(gen);
+        }
+        ++ish;
+    }
+
+    //note: the analysis operator is reused, so its cached engine has to follow the change of grid
+    Grid2SH<double> analysis(shg);
+    for(auto reg:{GeoGrid::pix,GeoGrid::grid}) {
+        GeoGrid grid(-180, 180, -90, 90, 1.0, 1.0, reg);
+        SH2Grid<double> synthesis(grid);
+        auto gridded=synthesis(coef);
+
+        auto coefback=analysis(*gridded);
+        auto cbptr=coefback->as<GArrayDense<double,2>*>();
+        for (size_t i = 0; i < shg.size(); ++i) {
+            for (int j = 0; j < ncol; ++j) {
+                BOOST_TEST(cbptr->mat()[i][j] == coef.mat()[i][j]);
+            }
+        }
+
+        //compare a few grid points with the point synthesis
+        auto grptr=gridded->as<GArrayDense<double,2>*>();
+        OGRPointGuide pntguide;
+        std::vector<size_t> gidx={0,123,4567,30000,grid.size()-1};
+        for(auto idx:gidx){
+            size_t ilon,ilat;
+            double lon,lat;
+            std::tie(ilon,ilat)=grid.ilonilat(idx);
+            std::tie(lon,lat)=grid.lonlat(ilon,ilat);
+            pntguide.push_back(OGRPoint(lon,lat));
+        }
+        Ynm<double> ynmop(pntguide);
+        auto pntsynth=ynmop(coef);
+        auto psptr=pntsynth->as<GArrayDense<double,2>*>();
+        for (size_t i = 0; i < gidx.size(); ++i) {
+            for (int j = 0; j < ncol; ++j) {
+                BOOST_TEST(psptr->mat()[i][j] == grptr->mat()[gidx[i]][j]);
+            }
+        }
+    }
+}
+
 //BOOST_AUTO_TEST_CASE(YNMtest,*boost::unit_test::tolerance(1e-11)){
     //int nmax=1000;
     //Ynm<double,SHnmtGuide,OGRPGuide> ynmop(nmax);
@@ -327,3 +566,374 @@ BOOST_AUTO_TEST_CASE(stabilityAssocLegendre)
 
 
 //}
+
+///@brief estimate spherical harmonic coefficients from synthesized values at random points
+BOOST_AUTO_TEST_CASE(xyz2shLSQ){
+    int nmax=12;
+    int ncol=3;
+    size_t npnt=1000;
+    SHGuide shg(nmax);
+    IndexGuide iguide(ncol);
+    std::mt19937 gen(5);
+    std::uniform_real_distribution<double> unif(-1,1);
+    auto coef=core::createDenseGAr<double>::zeros(shg,iguide);
+    size_t ish=0;
+    for(const auto & nmt:shg){
+        for(int i=0;i<ncol;++i){
+            //note: the sine coefficients of order zero are not observable
+            coef.mat()[ish][i]=(std::get<1>(nmt) == 0 and std::get<2>(nmt) == trigenum::S)?0.0:unif(gen);
+        }
+        ++ish;
+    }
+
+    //random points distributed uniformly over the sphere
+    std::vector<double> lon(npnt);
+    std::vector<double> lat(npnt);
+    for(size_t i=0;i<npnt;++i){
+        lon[i]=180*unif(gen);
+        lat[i]=asin(unif(gen))/D2R;
+    }
+    auto geoguide=geometry::makePointGuide(lon,lat);
+    Ynm<double> ynmop(geoguide);
+    auto obs=ynmop(coef);
+
+    //use a reduced SHGuide without the order zero sine coefficients
+    SHGuide shgest=SHGuide::create_nmt(nmax,0,true);
+    XYZ2SH<double> lsqop(shgest,3);
+    auto est=lsqop(*obs);
+    auto estptr=est->as<GArrayDense<double,2>*>();
+    BOOST_TEST(lsqop.nobs() == npnt);
+
+    ish=0;
+    size_t iest=0;
+    double maxdiff=0;
+    for(const auto & nmt:shg){
+        if(not (std::get<1>(nmt) == 0 and std::get<2>(nmt) == trigenum::S)) {
+            for (int i = 0; i < ncol; ++i) {
+                maxdiff = std::max(maxdiff, std::abs(estptr->mat()[iest][i] - coef.mat()[ish][i]));
+            }
+            ++iest;
+        }
+        ++ish;
+    }
+    BOOST_TEST_MESSAGE("Maximum difference of the least squares estimate "<<maxdiff);
+    BOOST_TEST(maxdiff < 1e-9);
+
+    //the result should not depend on the amount of threads
+    lsqop.setNThreads(1);
+    auto estsingle=lsqop(*obs);
+    auto estsptr=estsingle->as<GArrayDense<double,2>*>();
+    bool equalThreaded=std::equal(estsptr->mat().data(),estsptr->mat().data()+estsptr->mat().num_elements(),estptr->mat().data());
+    BOOST_TEST(equalThreaded);
+
+    //the full guide can be used as well, the order zero sine coefficients are returned as zero
+    XYZ2SH<double> lsqfull(shg,3);
+    auto estfull=lsqfull(*obs);
+    auto estfptr=estfull->as<GArrayDense<double,2>*>();
+    BOOST_TEST(lsqfull.estimated().size() == shgest.size());
+    maxdiff=0;
+    for(ish=0;ish<shg.size();++ish){
+        for (int i = 0; i < ncol; ++i) {
+            maxdiff = std::max(maxdiff, std::abs(estfptr->mat()[ish][i] - coef.mat()[ish][i]));
+        }
+    }
+    BOOST_TEST(maxdiff < 1e-9);
+
+    //guides which are constructed from a list of elements don't carry a maximum degree
+    std::vector<SHGuide::Element> elements;
+    for(const auto & nmt:shgest){
+        elements.push_back(nmt);
+    }
+    XYZ2SH<double> lsqvec(SHGuide(elements),3);
+    auto estvec=lsqvec(*obs);
+    auto estvptr=estvec->as<GArrayDense<double,2>*>();
+    maxdiff=0;
+    for(iest=0;iest<shgest.size();++iest){
+        for (int i = 0; i < ncol; ++i) {
+            maxdiff = std::max(maxdiff, std::abs(estvptr->mat()[iest][i] - estptr->mat()[iest][i]));
+        }
+    }
+    BOOST_TEST(maxdiff < 1e-12);
+}
+
+///@brief write a (native endian) block diagonal BINV file with one filter block per order and trigonometric type
+void writeDDKfilter(const std::string & fname, const int lmax, const int lmin, std::vector<double> & pack){
+    std::ofstream fout(fname,std::ios::binary);
+    auto put=[&](auto val){fout.write(reinterpret_cast<char*>(&val),sizeof(val));};
+    auto putstr=[&](std::string str, const size_t nchar){
+        str.resize(nchar,' ');
+        fout.write(str.data(),nchar);
+    };
+    std::vector<uint32_t> blockind;
+    uint32_t nval=0;
+    for(int iblk=0;iblk<2*lmax+1;++iblk){
+        int m=(iblk+1)/2;
+        nval+=lmax+1-std::max(lmin,m);
+        blockind.push_back(nval);
+    }
+    pack.clear();
+    for(size_t iblk=0;iblk<blockind.size();++iblk){
+        size_t sz=blockind[iblk]-((iblk == 0)?0:blockind[iblk-1]);
+        for(size_t i=0;i<sz*sz;++i){
+            pack.push_back(std::cos(0.5*iblk+0.37*i));
+        }
+    }
+    put(uint16_t(18754));
+    putstr("NV2.4",6);
+    putstr("BDFULLV0",8);
+    putstr("Test DDK filter",80);
+    put(uint32_t(2));
+    put(uint32_t(0));
+    put(uint32_t(nval));
+    put(uint32_t(nval));
+    put(uint64_t(pack.size()));
+    put(uint64_t(1));
+    put(uint32_t(0));
+    put(uint32_t(0));
+    put(uint32_t(blockind.size()));
+    putstr("Lmax",24);
+    putstr("Lmin",24);
+    put(uint32_t(lmax));
+    put(uint32_t(lmin));
+    for(size_t i=0;i<nval;++i){
+        putstr("side1_"+std::to_string(i),24);
+    }
+    for(auto bi:blockind){
+        put(bi);
+    }
+    for(size_t i=0;i<nval;++i){
+        putstr("side2_"+std::to_string(i),24);
+    }
+    for(auto val:pack){
+        put(val);
+    }
+}
+
+///@brief compare the block diagonal DDK filter with the block-wise filtering of the python implementation
+BOOST_AUTO_TEST_CASE(DDKfiltering,*boost::unit_test::tolerance(1e-13)){
+    const int lmax=6,lmin=2;
+    const std::string fname("DDKtest.bin");
+    std::vector<double> pack;
+    writeDDKfilter(fname,lmax,lmin,pack);
+
+    //the sine and cosine parts of the SHtmnGuide are consecutive
+    SHtmnGuide shgcheck(lmax);
+    BOOST_TEST(shgcheck.size() == 2*(SHnmGuide::i_from_nm(lmax,lmax,lmax)+1));
+    BOOST_TEST(SHtmnGuide::i_from_nmt(0,0,trigenum::S,lmax) == SHnmGuide::i_from_nm(lmax,lmax,lmax)+1);
+    BOOST_TEST(shgcheck.orderBlocks().back() == shgcheck.size());
+
+    const size_t ncol=3;
+    for(int nmax:{lmax,4}){
+        for(bool transpose:{false,true}){
+            DDKfilter ddk(fname,nmax,transpose);
+            ddk.setNThreads(2);
+            SHtmnGuide shg(nmax);
+            const size_t nsh=shg.size();
+            const size_t nhalf=nsh/2;
+            core::GArrayDense<double,2> gin(GuidePackDyn<2>{shg,IndexGuide(ncol)});
+            for(size_t i=0;i<nsh;++i){
+                for(size_t j=0;j<ncol;++j){
+                    gin.mat()[i][j]=std::sin(1.0+0.1*i+j);
+                }
+            }
+            auto gout=ddk.apply(gin);
+
+            //reference which mimics the python implementation (blocks embedded in an identity matrix)
+            std::vector<double> ref(nsh*ncol,0.0);
+            size_t lastindex=0;
+            for(size_t iblk=0;iblk<2*lmax+1;++iblk){
+                int m=(iblk+1)/2;
+                int trig=(iblk == 0)?0:(iblk-1)%2;
+                size_t sz=lmax+1-std::max(lmin,m);
+                size_t shft=std::max(lmin,m)-m;
+                if (m <= nmax){
+                    size_t st=SHtmnGuide::i_from_nmt(m,m,trigenum(trig),nmax);
+                    size_t ndblk=nmax-m+1;
+                    auto blockval=[&](size_t k, size_t l){
+                        if(k < shft or l < shft){
+                            return (k == l)?1.0:0.0;
+                        }
+                        k-=shft;
+                        l-=shft;
+                        return transpose?pack[lastindex+l*sz+k]:pack[lastindex+k*sz+l];
+                    };
+                    for(size_t j=0;j<ncol;++j){
+                        for(size_t l=0;l<ndblk;++l){
+                            double sum=0;
+                            for(size_t k=0;k<ndblk;++k){
+                                sum+=gin.mat()[st+k][j]*blockval(k,l);
+                            }
+                            ref[(st+l)*ncol+j]=sum;
+                        }
+                    }
+                }
+                lastindex+=sz*sz;
+            }
+
+            for(size_t i=0;i<nsh;++i){
+                for(size_t j=0;j<ncol;++j){
+                    BOOST_TEST(gout.mat()[i][j] == ref[i*ncol+j]);
+                }
+            }
+            //sine coefficients of order 0 are zeroed
+            BOOST_TEST(gout.mat()[nhalf][0] == 0.0);
+        }
+    }
+    BOOST_CHECK_THROW(DDKfilter(fname,lmax+1),core::InputException);
+    std::remove(fname.c_str());
+}
+
+///@brief compare a lazily evaluated chain (Stokes -> filter -> EWH -> grid) with the eager application of the operators
+BOOST_AUTO_TEST_CASE(SHoperatorChain,*boost::unit_test::tolerance(1e-10)){
+    using clock=std::chrono::steady_clock;
+    const int nmax=60;
+    const int ncol=20;
+    const int nrep=5;
+    SHGuide shg(nmax);
+    auto coef=core::createDenseGAr<double>::zeros(shg,IndexGuide(ncol));
+    std::mt19937 gen(5);
+    std::uniform_real_distribution<double> unif(-1,1);
+    for(size_t i=0;i<shg.size();++i){
+        for(int j=0;j<ncol;++j){
+            coef.mat()[i][j]=unif(gen);
+        }
+    }
+
+    //isotropic kernels: stokes to surface density, gaussian smoothing and a unit conversion to equivalent water height
+    std::vector<double> stokes2sd(nmax+1),gauss(nmax+1),sd2ewh(nmax+1,1e-3);
+    for(int n=0;n<=nmax;++n){
+        stokes2sd[n]=(2*n+1.0)/(1.0+0.3*n);
+        gauss[n]=std::exp(-n*(n+1)/400.0);
+    }
+    auto op1=std::make_shared<SHisoOperator<double>>(stokes2sd,shg);
+    auto op2=std::make_shared<SHisoOperator<double>>(gauss,shg);
+    auto op3=std::make_shared<SHisoOperator<double>>(sd2ewh,shg);
+    GeoGrid grid(-180, 180, -90, 90, 2.0, 2.0, GeoGrid::pix);
+    auto op4=std::make_shared<SH2Grid<double>>(grid);
+
+    core::GOperatorChain<double> chain;
+    chain.append(op1).append(op2).append(op3).append(op4);
+    BOOST_TEST(chain.nstages() == 4);
+    //the three diagonals are folded into one
+    BOOST_TEST(chain.nfused() == 2);
+
+    auto t0=clock::now();
+    std::shared_ptr<core::GArrayBase<double,2>> eager;
+    for(int i=0;i<nrep;++i){
+        auto sd=(*op1)(coef);
+        auto sdfilt=(*op2)(*sd);
+        auto ewh=(*op3)(*sdfilt);
+        eager=(*op4)(*ewh);
+    }
+    double dteager=std::chrono::duration<double>(clock::now()-t0).count()/nrep;
+
+    t0=clock::now();
+    std::shared_ptr<core::GArrayBase<double,2>> lazy;
+    for(int i=0;i<nrep;++i){
+        lazy=chain(coef);
+    }
+    double dtlazy=std::chrono::duration<double>(clock::now()-t0).count()/nrep;
+    BOOST_TEST_MESSAGE("Four stage operator chain: eager "<<dteager*1e3<<" ms, lazy "<<dtlazy*1e3<<" ms per evaluation");
+
+    auto eagerptr=eager->as<GArrayDense<double,2>*>();
+    auto lazyptr=lazy->as<GArrayDense<double,2>*>();
+    BOOST_TEST(lazyptr->mat().num_elements() == grid.size()*ncol);
+    for(size_t i=0;i<grid.size();i+=97){
+        for(int j=0;j<ncol;++j){
+            BOOST_TEST(lazyptr->mat()[i][j] == eagerptr->mat()[i][j]);
+        }
+    }
+
+    //a chain ending in two diagonals: they are folded and the final stage writes into the output array
+    core::GOperatorChain<double> chain2;
+    auto op5=std::make_shared<SHisoOperator<double>>(gauss,shg);
+    auto toSH=std::make_shared<Grid2SH<double>>(shg);
+    auto toGrid=std::make_shared<SH2Grid<double>>(GeoGrid(-180, 180, -90, 90, 1.0, 1.0, GeoGrid::pix));
+    chain2.append(toGrid).append(toSH).append(op5).append(op2);
+    BOOST_TEST(chain2.nfused() == 3);
+    auto gridded=(*toGrid)(coef);
+    auto shback=(*toSH)(*gridded);
+    auto eager2=(*op2)(*(*op5)(*shback));
+    auto lazy2=chain2(coef);
+    auto e2ptr=eager2->as<GArrayDense<double,2>*>();
+    auto l2ptr=lazy2->as<GArrayDense<double,2>*>();
+    for(size_t i=0;i<shg.size();++i){
+        BOOST_TEST(l2ptr->mat()[i][0] == e2ptr->mat()[i][0]);
+    }
+}
+
+///@brief polygon from a list of lon lat vertices (the ring is closed automatically)
+OGRPolygon makePolygon(const std::vector<std::vector<std::pair<double,double>>> & rings){
+    OGRPolygon poly;
+    for(const auto & vertices:rings){
+        OGRLinearRing ring;
+        for(const auto & v:vertices){
+            ring.addPoint(v.first,v.second);
+        }
+        ring.addPoint(vertices.front().first,vertices.front().second);
+        poly.addRing(&ring);
+    }
+    return poly;
+}
+
+BOOST_AUTO_TEST_CASE(polygon2sh){
+    //note: most coefficients are close to zero so absolute differences are checked
+    const double tol=1e-12;
+    const int nmax=30;
+    SHGuide shg(nmax);
+    OGRPolyGuide polys;
+    //global, northern and southern hemisphere
+    polys.push_back(makePolygon({{{-180,-90},{180,-90},{180,90},{-180,90}}}));
+    polys.push_back(makePolygon({{{-180,0},{180,0},{180,90},{-180,90}}}));
+    polys.push_back(makePolygon({{{-180,-90},{180,-90},{180,0},{-180,0}}}));
+    //box crossing the dateline expressed in two ways
+    polys.push_back(makePolygon({{{170.3,-20.7},{190.6,-20.7},{190.6,10.2},{170.3,10.2}}}));
+    polys.push_back(makePolygon({{{-189.7,-20.7},{-169.4,-20.7},{-169.4,10.2},{-189.7,10.2}}}));
+    //the usual representation of the same box with longitudes jumping at the dateline
+    polys.push_back(makePolygon({{{170.3,-20.7},{-169.4,-20.7},{-169.4,10.2},{170.3,10.2}}}));
+    //band with a hole straddling the dateline, both rings jumping
+    polys.push_back(makePolygon({{{160.2,-40.1},{-150.3,-40.1},{-150.3,-10.3},{160.2,-10.3}},{{175.2,-30.4},{-170.1,-30.4},{-170.1,-20.2},{175.2,-20.2}}}));
+    polys.push_back(makePolygon({{{160.2,-40.1},{209.7,-40.1},{209.7,-10.3},{160.2,-10.3}},{{-184.8,-30.4},{-170.1,-30.4},{-170.1,-20.2},{-184.8,-20.2}}}));
+    //triangle with a hole and the separate inner and outer ring
+    std::vector<std::pair<double,double>> outer={{10.1,30.3},{60.7,35.2},{30.4,70.9}};
+    std::vector<std::pair<double,double>> inner={{25.2,40.1},{40.3,40.6},{31.1,50.8}};
+    polys.push_back(makePolygon({outer,inner}));
+    polys.push_back(makePolygon({outer}));
+    polys.push_back(makePolygon({inner}));
+
+    Polygon2SH<double> polyop(shg,2,1);
+    auto coef=polyop(polys);
+    auto cptr=coef->as<GArrayDense<double,2>*>();
+    BOOST_TEST(cptr->mat().shape()[1] == polys.size());
+
+    size_t ish=0;
+    for(const auto & nmt:shg){
+        const double c00=(std::get<0>(nmt) == 0 and std::get<2>(nmt) == trigenum::C)?1.0:0.0;
+        BOOST_TEST(std::abs(cptr->mat()[ish][0]-c00) < tol);
+        BOOST_TEST(std::abs(cptr->mat()[ish][1]+cptr->mat()[ish][2]-cptr->mat()[ish][0]) < tol);
+        BOOST_TEST(std::abs(cptr->mat()[ish][3]-cptr->mat()[ish][4]) < tol);
+        BOOST_TEST(std::abs(cptr->mat()[ish][3]-cptr->mat()[ish][5]) < tol);
+        BOOST_TEST(std::abs(cptr->mat()[ish][6]-cptr->mat()[ish][7]) < tol);
+        BOOST_TEST(std::abs(cptr->mat()[ish][8]-(cptr->mat()[ish][9]-cptr->mat()[ish][10])) < tol);
+        ++ish;
+    }
+    //the hemispheres have opposite C10 and half the area
+    BOOST_TEST(std::abs(cptr->mat()[0][1]-0.5) < tol);
+    const size_t ic10=std::distance(shg.begin(),std::find(shg.begin(),shg.end(),SHGuide::Element(1,0,trigenum::C)));
+    BOOST_TEST(std::abs(cptr->mat()[ic10][1]+cptr->mat()[ic10][2]) < tol);
+    BOOST_TEST(cptr->mat()[ic10][1] > 0.0);
+
+    //weighted combinations of polygons and a multithreaded run yield the same result
+    auto weights=core::createDenseGAr<double>::zeros(polys,IndexGuide(2));
+    weights.mat()[1][0]=2.0;
+    weights.mat()[2][0]=2.0;
+    weights.mat()[9][1]=1.0;
+    weights.mat()[10][1]=-1.0;
+    polyop.setNThreads(3);
+    auto wcoef=polyop(weights);
+    auto wptr=wcoef->as<GArrayDense<double,2>*>();
+    for(size_t i=0;i<shg.size();++i){
+        BOOST_TEST(std::abs(wptr->mat()[i][0]-2*cptr->mat()[i][0]) < tol);
+        BOOST_TEST(std::abs(wptr->mat()[i][1]-cptr->mat()[i][8]) < tol);
+    }
+}
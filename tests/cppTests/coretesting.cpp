@@ -34,6 +34,8 @@
 #include "core/TreeNode.hpp"
 #include "core/Constants.hpp"
 #include "core/Logging.hpp"
+#include "core/FFT.hpp"
+#include <chrono>
 
 using namespace frommle::core;
 using namespace frommle::guides;
@@ -62,6 +64,176 @@ BOOST_AUTO_TEST_CASE(Garray1n2n3d){
 }
 
 
+///@brief compares mixed radix and Bluestein (large prime factor) transforms with a direct Fourier sum
+BOOST_AUTO_TEST_CASE(FFTlengths){
+    using cplx=std::complex<double>;
+    for(size_t n:{360,1009,2*1009}){
+        FFTplan<double> plan(n);
+        std::vector<cplx> x(n),y(n),z(n);
+        for(size_t j=0;j<n;++j){
+            x[j]=cplx(std::cos(0.3*j*j),std::sin(1.7*j));
+        }
+        plan.fwd(x.data(),y.data());
+        for(size_t k=0;k<n;k+=n/7){
+            cplx sum=0;
+            for(size_t j=0;j<n;++j){
+                sum+=x[j]*std::polar(1.0,-2*M_PI*static_cast<double>((j*k)%n)/n);
+            }
+            BOOST_TEST(std::abs(sum-y[k]) < 1e-9);
+        }
+        plan.bwd(y.data(),z.data());
+        for(size_t j=0;j<n;++j){
+            BOOST_TEST(std::abs(z[j]/static_cast<double>(n)-x[j]) < 1e-12);
+        }
+    }
+}
+
+///@brief checks that the cached layout of a 4D guidepack follows modifications of the pack and its guides, and compares it with visiting the guides on each call
+BOOST_AUTO_TEST_CASE(GuidePackExtents){
+    using clock=std::chrono::steady_clock;
+    GuidePackDyn<4> gp(IndexGuide(13),IndexGuide(7),IndexGuide(5),IndexGuide(11));
+    std::array<size_t,4> ref{{13,7,5,11}};
+    BOOST_TEST(gp.extent() == ref);
+    BOOST_TEST(gp.num_elements() == 13*7*5*11);
+    std::array<size_t,4> refstr{{7*5*11,5*11,11,1}};
+    BOOST_TEST(gp.strides() == refstr);
+
+    //the layout must follow modifications of the pack
+    gp.gv(2)=std::make_shared<IndexGuide>(3);
+    BOOST_TEST(gp.num_elements() == 13*7*3*11);
+    auto gp5=gp.append(GuideRegistry::Gvar(std::make_shared<IndexGuide>(2)));
+    BOOST_TEST(gp5->num_elements() == 13*7*3*11*2);
+    BOOST_TEST(gp5->strip()->num_elements() == 13*7*3*11);
+    gp.as<IndexGuide>(0)->append();
+    BOOST_TEST(gp.extent()[0] == 14);
+    GuidePackDyn<4> gpassign;
+    gpassign=gp;
+    BOOST_TEST(gpassign.num_elements() == 14*7*3*11);
+    *gp.as<IndexGuide>(0)=IndexGuide(13);
+    BOOST_TEST(gpassign.num_elements() == 13*7*3*11);
+
+    //and modifications of guides which are shared with another pack
+    const int nmax=10;
+    const GuidePackDyn<2> gpsh(SHnmGuide(nmax),IndexGuide(3));
+    GuidePackDyn<2> gpshared(gpsh);
+    const size_t nfull=gpsh.num_elements();
+    gpshared.as<SHnmGuide>(0)->mask([](const SHnmGuide::Element & el){return std::get<0>(el) > 5;});
+    BOOST_TEST(gpsh.extent()[0] == (5+1)*(5+2)/2);
+    BOOST_TEST(gpsh.num_elements() == 3*(5+1)*(5+2)/2);
+    gpshared.as<SHnmGuide>(0)->unmask();
+    BOOST_TEST(gpsh.num_elements() == nfull);
+
+    //offsets agree with the row-major layout of the dense arrays
+    GArrayDense<double,4> garr(gp);
+    std::array<size_t,4> idx{{12,2,1,9}};
+    BOOST_TEST(&garr.mat()[12][2][1][9]-garr.mat().data() == gp.offset(idx));
+
+    //benchmark: index->offset mapping with the cached layout versus recomputing the extents through the variants
+    const size_t nrep=200000;
+    size_t sumcached=0,sumvisit=0;
+    auto t0=clock::now();
+    for(size_t i=0;i<nrep;++i){
+        idx[3]=i%11;
+        sumcached+=gp.offset(idx);
+    }
+    double tcached=std::chrono::duration<double>(clock::now()-t0).count();
+    //a reference to the layout can be kept for the duration of the loop
+    size_t sumlayout=0;
+    t0=clock::now();
+    const auto & lay=gp.layout();
+    for(size_t i=0;i<nrep;++i){
+        idx[3]=i%11;
+        sumlayout+=lay.offset(idx);
+    }
+    double tlayout=std::chrono::duration<double>(clock::now()-t0).count();
+    const auto & gpc=gp;
+    t0=clock::now();
+    for(size_t i=0;i<nrep;++i){
+        idx[3]=i%11;
+        size_t off=0;
+        for(int d=0;d<4;++d){
+            off=off*boost::apply_visitor(gvar_size(),gpc.gv(d))+idx[d];
+        }
+        sumvisit+=off;
+    }
+    double tvisit=std::chrono::duration<double>(clock::now()-t0).count();
+    BOOST_TEST(sumcached == sumvisit);
+    BOOST_TEST(sumlayout == sumvisit);
+    BOOST_TEST_MESSAGE("4D offset mapping: cached layout "<<tcached/nrep*1e9<<" ns, layout reference "<<tlayout/nrep*1e9<<" ns, visiting guides "<<tvisit/nrep*1e9<<" ns per index");
+}
+
+///@brief compares element-wise indexing through a statically typed guidepack with the dynamic (variant based) guidepack
+BOOST_AUTO_TEST_CASE(GuidePackStatic){
+    using clock=std::chrono::steady_clock;
+    using gregdate=boost::gregorian::date;
+    const int nmax=60;
+    const size_t ntime=50;
+    DateGuide dates;
+    for(size_t t=0;t<ntime;++t){
+        dates.push_back(gregdate(2002,4,15)+boost::gregorian::months(t));
+    }
+    //element lookup skips masked entries
+    DateGuide dmasked(dates);
+    dmasked.mask([&dates](const gregdate & d){return d < dates[3];});
+    BOOST_TEST(dmasked.idx(dates[5]) == 2);
+    BOOST_CHECK_THROW(dmasked.idx(dates[1]),IndexingException);
+
+    GuidePack<SHnmGuide,DateGuide> gps{SHnmGuide(nmax),dates};
+    const GuidePackDyn<2> & gpd=gps.dyn();
+    BOOST_TEST(gps.g<0>()->size() == gpd[0]->size());
+    BOOST_TEST(gps.g<1>()->size() == ntime);
+
+    //round trip through a dynamic pack
+    GuidePack<SHnmGuide,DateGuide> gpback(*gps.dynptr());
+    BOOST_TEST(gpback.num_elements() == gps.num_elements());
+    BOOST_CHECK_THROW((GuidePack<IndexGuide,IndexGuide>(gpd)),InputException);
+
+    //typed element access of a dense array
+    GArrayDense_spec<double,GuidePack<SHnmGuide,DateGuide>> garr(gps);
+    garr=0.0;
+    garr(nmEl(3,2),dates[7])=1.5;
+    BOOST_TEST(garr.mat()[gps.idx<0>(nmEl(3,2))][7] == 1.5);
+
+    //const access follows guides which are replaced through the variants
+    GuidePack<SHnmGuide,DateGuide> gpswap(gps);
+    gpswap.gv(0)=std::make_shared<SHnmGuide>(nmax/2);
+    const auto & gpswapc=gpswap;
+    BOOST_TEST(gpswapc.g<0>()->nmax() == nmax/2);
+    BOOST_TEST(gpswapc.num_elements() == (nmax/2+1)*(nmax/2+2)/2*ntime);
+    BOOST_TEST(gpswapc.offset(nmEl(nmax/2,nmax/2),dates[1]) == gpswapc.idx<0>(nmEl(nmax/2,nmax/2))*ntime+1);
+    BOOST_TEST(gpswap.g<0>()->nmax() == nmax/2);
+    BOOST_TEST(gps.g<0>()->nmax() == nmax);
+
+    const size_t nrep=20;
+    size_t sumstatic=0,sumdyn=0;
+    auto t0=clock::now();
+    for(size_t irep=0;irep<nrep;++irep){
+        for(int n=0;n<=nmax;++n){
+            for(int m=0;m<=n;++m){
+                for(const auto & t:dates){
+                    sumstatic+=gps.offset(nmEl(n,m),t);
+                }
+            }
+        }
+    }
+    double tstatic=std::chrono::duration<double>(clock::now()-t0).count();
+    //both dimensions are resolved through the variants of the dynamic pack
+    t0=clock::now();
+    for(size_t irep=0;irep<nrep;++irep){
+        for(int n=0;n<=nmax;++n){
+            for(int m=0;m<=n;++m){
+                for(const auto & t:dates){
+                    sumdyn+=gpd.offset({{gpd.idx(0,nmEl(n,m)),gpd.idx(1,t)}});
+                }
+            }
+        }
+    }
+    double tdyn=std::chrono::duration<double>(clock::now()-t0).count();
+    BOOST_TEST(sumstatic == sumdyn);
+    const double nidx=nrep*gps.num_elements();
+    BOOST_TEST_MESSAGE("SHnm x Date indexing: static pack "<<tstatic/nidx*1e9<<" ns, dynamic pack "<<tdyn/nidx*1e9<<" ns per element");
+}
+
 BOOST_AUTO_TEST_CASE(Settings) {
 
     //first create the default template